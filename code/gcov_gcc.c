@@ -40,6 +40,22 @@
 #include "defs.h"
 #endif // GCOV_OPT_RESET_WATCHDOG
 
+#ifdef GCOV_OPT_USE_VECTOR_KERNELS
+/* Select the widest vector instructions the compiler target allows */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GCOV_KERNEL_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GCOV_KERNEL_SSE2
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define GCOV_KERNEL_NEON
+#endif
+#endif // GCOV_OPT_USE_VECTOR_KERNELS
 
 /**
  * struct gcov_ctr_info - information about counters for a single function
@@ -209,16 +225,329 @@ static size_t store_gcov_counter(gcov_unsigned_t *buffer, size_t off, gcov_type
 	return sizeof(*data)/sizeof(*buffer) * 2;
 }
 
+/*
+ * Counter array kernels.
+ *
+ * Clearing, zero testing, and the other scans of the counter data
+ * all come down to a few operations over one gcov_ctr_info values array.
+ * Each has a portable scalar version, and vector versions selected at
+ * compile time if GCOV_OPT_USE_VECTOR_KERNELS (see gcov_public.h).
+ * The vector versions use unaligned loads and stores, so nothing is
+ * assumed about the alignment of the gcc-generated values arrays.
+ */
+
 /**
- * gcov_convert_to_gcda - convert profiling data set to gcda file format
+ * gcov_kernel_clear - set an array of counter values to zero
+ * @values: array of counter values
+ * @num: number of counter values
+ */
+/* Our own creation */
+void gcov_kernel_clear(gcov_type *values, gcov_unsigned_t num)
+{
+	gcov_unsigned_t i = 0;
+
+#if defined(GCOV_KERNEL_AVX2)
+	const __m256i zero = _mm256_setzero_si256();
+
+	for (; num - i >= 4; i += 4) {
+		_mm256_storeu_si256((__m256i *)(values + i), zero);
+	}
+#elif defined(GCOV_KERNEL_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; num - i >= 2; i += 2) {
+		_mm_storeu_si128((__m128i *)(values + i), zero);
+	}
+#elif defined(GCOV_KERNEL_NEON)
+	const int64x2_t zero = vdupq_n_s64(0);
+
+	for (; num - i >= 2; i += 2) {
+		vst1q_s64((int64_t *)(values + i), zero);
+	}
+#else
+	for (; num - i >= 4; i += 4) {
+		values[i] = 0;
+		values[i + 1] = 0;
+		values[i + 2] = 0;
+		values[i + 3] = 0;
+	}
+#endif
+
+	for (; i < num; i++) {
+		values[i] = 0;
+	}
+}
+
+/**
+ * gcov_kernel_all_zero - test if an array of counter values is all zero
+ * @values: array of counter values
+ * @num: number of counter values
+ *
+ * Returns nonzero if all values are zero (or @num is zero).
+ * Stops at the first block containing a nonzero value.
+ */
+/* Our own creation */
+int gcov_kernel_all_zero(const gcov_type *values, gcov_unsigned_t num)
+{
+	gcov_unsigned_t i = 0;
+
+#if defined(GCOV_KERNEL_AVX2)
+	for (; num - i >= 4; i += 4) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+
+		if (!_mm256_testz_si256(v, v)) {
+			return 0;
+		}
+	}
+#elif defined(GCOV_KERNEL_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; num - i >= 2; i += 2) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xffff) {
+			return 0;
+		}
+	}
+#elif defined(GCOV_KERNEL_NEON)
+	for (; num - i >= 2; i += 2) {
+		int64x2_t v = vld1q_s64((const int64_t *)(values + i));
+
+		if (vgetq_lane_s64(v, 0) | vgetq_lane_s64(v, 1)) {
+			return 0;
+		}
+	}
+#else
+	for (; num - i >= 4; i += 4) {
+		if (values[i] | values[i + 1] | values[i + 2] | values[i + 3]) {
+			return 0;
+		}
+	}
+#endif
+
+	for (; i < num; i++) {
+		if (values[i]) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * gcov_kernel_or_reduce - bitwise OR of an array of counter values
+ * @values: array of counter values
+ * @num: number of counter values
+ *
+ * The highest set bit of the result gives the width needed
+ * to hold any of the values.
+ */
+/* Our own creation */
+gcov_type gcov_kernel_or_reduce(const gcov_type *values, gcov_unsigned_t num)
+{
+	gcov_unsigned_t i = 0;
+	gcov_type result = 0;
+
+#if defined(GCOV_KERNEL_AVX2)
+	__m256i acc = _mm256_setzero_si256();
+	gcov_type lanes[4];
+
+	for (; num - i >= 4; i += 4) {
+		acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i *)(values + i)));
+	}
+	_mm256_storeu_si256((__m256i *)lanes, acc);
+	result = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+#elif defined(GCOV_KERNEL_SSE2)
+	__m128i acc = _mm_setzero_si128();
+	gcov_type lanes[2];
+
+	for (; num - i >= 2; i += 2) {
+		acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i *)(values + i)));
+	}
+	_mm_storeu_si128((__m128i *)lanes, acc);
+	result = lanes[0] | lanes[1];
+#elif defined(GCOV_KERNEL_NEON)
+	int64x2_t acc = vdupq_n_s64(0);
+
+	for (; num - i >= 2; i += 2) {
+		acc = vorrq_s64(acc, vld1q_s64((const int64_t *)(values + i)));
+	}
+	result = vgetq_lane_s64(acc, 0) | vgetq_lane_s64(acc, 1);
+#endif
+
+	for (; i < num; i++) {
+		result |= values[i];
+	}
+
+	return result;
+}
+
+/**
+ * gcov_kernel_max_reduce - largest of an array of counter values
+ * @values: array of counter values
+ * @num: number of counter values
+ *
+ * Arc counters are never negative, so the result is never less than zero
+ * (including for an empty array).
+ * The SSE2 version needs SSE4.2 for the 64-bit compare,
+ * otherwise the scalar version is used.
+ */
+/* Our own creation */
+gcov_type gcov_kernel_max_reduce(const gcov_type *values, gcov_unsigned_t num)
+{
+	gcov_unsigned_t i = 0;
+	gcov_type result = 0;
+
+#if defined(GCOV_KERNEL_AVX2)
+	__m256i acc = _mm256_setzero_si256();
+	gcov_type lanes[4];
+
+	for (; num - i >= 4; i += 4) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+
+		acc = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(v, acc));
+	}
+	_mm256_storeu_si256((__m256i *)lanes, acc);
+	for (int l = 0; l < 4; l++) {
+		if (lanes[l] > result) result = lanes[l];
+	}
+#elif defined(GCOV_KERNEL_SSE2) && defined(__SSE4_2__)
+	__m128i acc = _mm_setzero_si128();
+	gcov_type lanes[2];
+
+	for (; num - i >= 2; i += 2) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+
+		acc = _mm_blendv_epi8(acc, v, _mm_cmpgt_epi64(v, acc));
+	}
+	_mm_storeu_si128((__m128i *)lanes, acc);
+	result = (lanes[0] > lanes[1]) ? lanes[0] : lanes[1];
+#elif defined(GCOV_KERNEL_NEON)
+	int64x2_t acc = vdupq_n_s64(0);
+
+	for (; num - i >= 2; i += 2) {
+		int64x2_t v = vld1q_s64((const int64_t *)(values + i));
+
+		acc = vbslq_s64(vcgtq_s64(v, acc), v, acc);
+	}
+	result = (vgetq_lane_s64(acc, 0) > vgetq_lane_s64(acc, 1)) ?
+			vgetq_lane_s64(acc, 0) : vgetq_lane_s64(acc, 1);
+#endif
+
+	for (; i < num; i++) {
+		if (values[i] > result) result = values[i];
+	}
+
+	return result;
+}
+
+/**
+ * gcov_kernel_equal - compare an array of counter values with a shadow copy
+ * @values: array of counter values
+ * @shadow: array of previously saved counter values
+ * @num: number of counter values in each array
+ *
+ * Returns nonzero if all values are unchanged from the shadow copy.
+ */
+/* Our own creation */
+int gcov_kernel_equal(const gcov_type *values, const gcov_type *shadow, gcov_unsigned_t num)
+{
+	gcov_unsigned_t i = 0;
+
+#if defined(GCOV_KERNEL_AVX2)
+	for (; num - i >= 4; i += 4) {
+		__m256i d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(values + i)),
+					     _mm256_loadu_si256((const __m256i *)(shadow + i)));
+
+		if (!_mm256_testz_si256(d, d)) {
+			return 0;
+		}
+	}
+#elif defined(GCOV_KERNEL_SSE2)
+	for (; num - i >= 2; i += 2) {
+		__m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(values + i)),
+					    _mm_loadu_si128((const __m128i *)(shadow + i)));
+
+		if (_mm_movemask_epi8(eq) != 0xffff) {
+			return 0;
+		}
+	}
+#elif defined(GCOV_KERNEL_NEON)
+	for (; num - i >= 2; i += 2) {
+		int64x2_t d = veorq_s64(vld1q_s64((const int64_t *)(values + i)),
+					vld1q_s64((const int64_t *)(shadow + i)));
+
+		if (vgetq_lane_s64(d, 0) | vgetq_lane_s64(d, 1)) {
+			return 0;
+		}
+	}
+#else
+	for (; num - i >= 4; i += 4) {
+		if ((values[i] ^ shadow[i]) | (values[i + 1] ^ shadow[i + 1]) |
+		    (values[i + 2] ^ shadow[i + 2]) | (values[i + 3] ^ shadow[i + 3])) {
+			return 0;
+		}
+	}
+#endif
+
+	for (; i < num; i++) {
+		if (values[i] != shadow[i]) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+/**
+ * store_gcov_counters_reset - store and zero an array of counter values
+ * @buffer: target buffer
+ * @off: offset into the buffer
+ * @ci_ptr: counters to be stored and zeroed
+ *
+ * Each value is read and zeroed in one step, so that no increment
+ * made while the data is being output is lost: by atomic exchange
+ * if GCOV_OPT_RESET_ATOMIC, otherwise by storing and clearing the whole
+ * array inside GCOV_CRITICAL_ENTER and GCOV_CRITICAL_EXIT.
+ * Returns the count of buffer data type units stored.
+ */
+/* Our own creation */
+/* Need buffer to be 32-bit-aligned for type-safe internal usage */
+static size_t store_gcov_counters_reset(gcov_unsigned_t *buffer, size_t off, const struct gcov_ctr_info *ci_ptr)
+{
+	size_t pos = off;
+	unsigned int cv_idx;
+
+#ifdef GCOV_OPT_RESET_ATOMIC
+	for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
+		pos += store_gcov_counter(buffer, pos,
+				__atomic_exchange_n(&ci_ptr->values[cv_idx], 0, __ATOMIC_RELAXED));
+	}
+#else
+	GCOV_CRITICAL_ENTER();
+	for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
+		pos += store_gcov_counter(buffer, pos, ci_ptr->values[cv_idx]);
+	}
+	gcov_kernel_clear(ci_ptr->values, ci_ptr->num);
+	GCOV_CRITICAL_EXIT();
+#endif // GCOV_OPT_RESET_ATOMIC
+
+	return pos - off;
+}
+#endif // GCOV_OPT_PROVIDE_DUMP_AND_RESET
+
+/**
+ * convert_to_gcda - convert profiling data set to gcda file format
  * @buffer: the buffer to store file data or %NULL if no data should be stored
  * @info: profiling data set to be converted
+ * @reset: nonzero to zero each counter array as it is stored
  *
  * Returns the number of bytes that were/would have been stored into the buffer.
  */
 /* Our own creation, but compare to libgcc/libgcov-driver.c function write_one_data() */
 /* Need buffer to be 32-bit-aligned for type-safe internal usage */
-size_t gcov_convert_to_gcda(gcov_unsigned_t *buffer, struct gcov_info *gi_ptr)
+static size_t convert_to_gcda(gcov_unsigned_t *buffer, struct gcov_info *gi_ptr, int reset)
 {
 	const struct gcov_fn_info *fi_ptr;
 	const struct gcov_ctr_info *ci_ptr;
@@ -262,14 +591,227 @@ size_t gcov_convert_to_gcda(gcov_unsigned_t *buffer, struct gcov_info *gi_ptr)
 					      GCOV_TAG_FOR_COUNTER(ct_idx),
 					      GCOV_TAG_COUNTER_LENGTH(ci_ptr->num));
 
-			for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
-				pos += store_gcov_counter(buffer, pos,
-						      ci_ptr->values[cv_idx]);
+			if (!buffer) {
+				/* Only counting the size */
+				pos += 2 * ci_ptr->num;
+			} else if (gcov_kernel_all_zero(ci_ptr->values, ci_ptr->num)) {
+				/* Common case of code never reached, no need to split values */
+				for (cv_idx = 0; cv_idx < 2 * ci_ptr->num; cv_idx++) {
+					buffer[pos + cv_idx] = 0;
+				}
+				pos += 2 * ci_ptr->num;
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+			} else if (reset) {
+				pos += store_gcov_counters_reset(buffer, pos, ci_ptr);
+#endif // GCOV_OPT_PROVIDE_DUMP_AND_RESET
+			} else {
+				for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
+					pos += store_gcov_counter(buffer, pos,
+							      ci_ptr->values[cv_idx]);
+				}
 			}
 			ci_ptr++;
 		}
 	}
 
+	(void)reset; // ignore unused param if no GCOV_OPT_PROVIDE_DUMP_AND_RESET
+
+	/* return count of bytes (convert from count of buffer data type units) */
+	return pos * sizeof(*buffer);
+}
+
+/**
+ * gcov_convert_to_gcda - convert profiling data set to gcda file format
+ * @buffer: the buffer to store file data or %NULL if no data should be stored
+ * @info: profiling data set to be converted
+ *
+ * Returns the number of bytes that were/would have been stored into the buffer.
+ */
+/* Our own creation, but compare to libgcc/libgcov-driver.c function write_one_data() */
+/* Need buffer to be 32-bit-aligned for type-safe internal usage */
+size_t gcov_convert_to_gcda(gcov_unsigned_t *buffer, struct gcov_info *gi_ptr)
+{
+	return convert_to_gcda(buffer, gi_ptr, 0);
+}
+
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+/**
+ * gcov_convert_to_gcda_and_reset - convert profiling data set and zero counters
+ * @buffer: the buffer to store file data or %NULL if no data should be stored
+ * @info: profiling data set to be converted
+ *
+ * Same as gcov_convert_to_gcda, but each counter array is zeroed
+ * as it is stored (not if @buffer is %NULL).
+ * Returns the number of bytes that were/would have been stored into the buffer.
+ */
+/* Our own creation */
+/* Need buffer to be 32-bit-aligned for type-safe internal usage */
+size_t gcov_convert_to_gcda_and_reset(gcov_unsigned_t *buffer, struct gcov_info *gi_ptr)
+{
+	return convert_to_gcda(buffer, gi_ptr, 1);
+}
+#endif // GCOV_OPT_PROVIDE_DUMP_AND_RESET
+
+/* Records of gcov_convert_state */
+#define GCOV_REC_FILE		0
+#define GCOV_REC_FUNCTION	1
+#define GCOV_REC_COUNTERS	2
+#define GCOV_REC_DONE		3
+
+/**
+ * gcov_convert_start - start a conversion in pieces
+ * @state: conversion position to be initialized
+ * @reset: nonzero to zero each counter value as it is converted
+ *	(only if GCOV_OPT_PROVIDE_DUMP_AND_RESET)
+ */
+/* Our own creation */
+void gcov_convert_start(struct gcov_convert_state *state, int reset)
+{
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+	state->reset = reset;
+#else
+	(void)reset; // ignore unused param
+	state->reset = 0;
+#endif // GCOV_OPT_PROVIDE_DUMP_AND_RESET
+	state->high = 0;
+	state->rec = GCOV_REC_FILE;
+	state->fi_idx = 0;
+	state->ct_idx = 0;
+	state->ci_idx = 0;
+	state->word = 0;
+}
+
+/**
+ * gcov_convert_to_gcda_part - convert the next piece of a profiling data set
+ * @buffer: the buffer to store file data
+ * @max_bytes: size of the buffer, at least one 32-bit word
+ * @info: profiling data set to be converted
+ * @state: conversion position, from gcov_convert_start or the previous call
+ *
+ * Stores the same data as gcov_convert_to_gcda (or gcov_convert_to_gcda_and_reset),
+ * but only up to @max_bytes at a time, so that output of one piece
+ * can overlap conversion of the next, and no buffer for the whole file is needed.
+ * Returns the number of bytes stored, zero when the conversion is done.
+ */
+/* Our own creation, but compare to gcov_convert_to_gcda */
+/* Need buffer to be 32-bit-aligned for type-safe internal usage */
+size_t gcov_convert_to_gcda_part(gcov_unsigned_t *buffer, size_t max_bytes,
+				 struct gcov_info *gi_ptr, struct gcov_convert_state *state)
+{
+	const struct gcov_fn_info *fi_ptr;
+	const struct gcov_ctr_info *ci_ptr;
+	size_t max = max_bytes / sizeof(*buffer);
+	size_t pos = 0; /* offset in buffer, in buffer data type units */
+	gcov_unsigned_t w;
+
+	while (pos < max) {
+		switch (state->rec) {
+		case GCOV_REC_FILE:
+			/* File header: magic, version, stamp, checksum */
+			w = state->word;
+			buffer[pos++] = (w == 0) ? GCOV_DATA_MAGIC :
+					(w == 1) ? gi_ptr->version :
+					(w == 2) ? gi_ptr->stamp : gi_ptr->checksum;
+			if (++state->word == 4) {
+				state->rec = GCOV_REC_FUNCTION;
+				state->word = 0;
+			}
+			break;
+
+		case GCOV_REC_FUNCTION:
+			if (state->fi_idx >= gi_ptr->n_functions) {
+				state->rec = GCOV_REC_DONE;
+				break;
+			}
+			fi_ptr = gi_ptr->functions[state->fi_idx];
+
+#ifdef GCOV_OPT_RESET_WATCHDOG
+			/* In an embedded system, you might want to reset any watchdog timer here, */
+			/* depending on your timeout versus gcov tree size */
+			SP_WDG = WATCHDOG_RESET;
+#endif // GCOV_OPT_RESET_WATCHDOG
+
+			/* Function record: tag, length, ident, checksums */
+			w = state->word;
+			buffer[pos++] = (w == 0) ? GCOV_TAG_FUNCTION :
+					(w == 1) ? GCOV_TAG_FUNCTION_LENGTH :
+					(w == 2) ? fi_ptr->ident :
+					(w == 3) ? fi_ptr->lineno_checksum : fi_ptr->cfg_checksum;
+			if (++state->word == 5) {
+				state->rec = GCOV_REC_COUNTERS;
+				state->ct_idx = 0;
+				state->ci_idx = 0;
+				state->word = 0;
+			}
+			break;
+
+		case GCOV_REC_COUNTERS:
+			if (state->ct_idx < GCOV_COUNTERS && !gi_ptr->merge[state->ct_idx]) {
+				/* Unused counter */
+				state->ct_idx++;
+				break;
+			}
+			if (state->ct_idx >= GCOV_COUNTERS) {
+				state->fi_idx++;
+				state->rec = GCOV_REC_FUNCTION;
+				state->word = 0;
+				break;
+			}
+			fi_ptr = gi_ptr->functions[state->fi_idx];
+			ci_ptr = fi_ptr->ctrs + state->ci_idx;
+
+			/* Counter record: tag, length, values (low word first) */
+			if (state->word == 0) {
+				buffer[pos++] = GCOV_TAG_FOR_COUNTER(state->ct_idx);
+				state->word++;
+			} else if (state->word == 1) {
+				buffer[pos++] = GCOV_TAG_COUNTER_LENGTH(ci_ptr->num);
+				state->word++;
+			} else {
+				/* As many values as fit, each value read once */
+				/* (the high word is kept in case the buffer ends between words) */
+				while ((pos < max) && (state->word < 2 + 2 * ci_ptr->num)) {
+					if (state->word & 1) {
+						buffer[pos++] = state->high;
+					} else {
+						gcov_type *vp = &ci_ptr->values[(state->word - 2) / 2];
+						gcov_type v;
+
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+						if (state->reset) {
+#ifdef GCOV_OPT_RESET_ATOMIC
+							v = __atomic_exchange_n(vp, 0, __ATOMIC_RELAXED);
+#else
+							GCOV_CRITICAL_ENTER();
+							v = *vp;
+							*vp = 0;
+							GCOV_CRITICAL_EXIT();
+#endif // GCOV_OPT_RESET_ATOMIC
+						} else {
+							v = *vp;
+						}
+#else
+						v = *vp;
+#endif // GCOV_OPT_PROVIDE_DUMP_AND_RESET
+						buffer[pos++] = (v & 0xffffffffUL);
+						state->high = (v >> 32);
+					}
+					state->word++;
+				}
+			}
+			if (state->word >= 2 && state->word == 2 + 2 * ci_ptr->num) {
+				state->ct_idx++;
+				state->ci_idx++;
+				state->word = 0;
+			}
+			break;
+
+		default:
+			/* return count of bytes (convert from count of buffer data type units) */
+			return pos * sizeof(*buffer);
+		}
+	}
+
 	/* return count of bytes (convert from count of buffer data type units) */
 	return pos * sizeof(*buffer);
 }
@@ -286,7 +828,6 @@ void gcov_clear_counters(struct gcov_info *gi_ptr)
 	const struct gcov_ctr_info *ci_ptr;
 	unsigned int fi_idx;
 	unsigned int ct_idx;
-	unsigned int cv_idx;
 
 	/* Clear execution counts for each function.  */
 	for (fi_idx = 0; fi_idx < gi_ptr->n_functions; fi_idx++) {
@@ -301,9 +842,7 @@ void gcov_clear_counters(struct gcov_info *gi_ptr)
 			}
 
 			/* Counter record. */
-			for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
-			      ci_ptr->values[cv_idx] = 0;
-			}
+			gcov_kernel_clear(ci_ptr->values, ci_ptr->num);
 			ci_ptr++;
 		}
 	}
@@ -311,6 +850,242 @@ void gcov_clear_counters(struct gcov_info *gi_ptr)
 	return;
 }
 
+/**
+ * hash_mix - mix one 64-bit value into a running hash
+ * @h: running hash
+ * @v: value to be mixed in
+ *
+ * Fast non-cryptographic multiply and xor-shift mixing
+ * (like the 64-bit finalizers of MurmurHash and splitmix64),
+ * only meant to tell whether counters changed.
+ */
+/* Our own creation */
+static gcov_hash_t hash_mix(gcov_hash_t h, gcov_hash_t v)
+{
+	h ^= v;
+	h *= 0x9e3779b97f4a7c15ULL;
+	h ^= h >> 29;
+
+	return h;
+}
+
+/**
+ * gcov_hash_counters - hash the counter contents of a profiling data set
+ * @info: profiling data set to be hashed
+ *
+ * The stamp and checksum are included, so that identical counters
+ * from a different build give a different hash.
+ * All-zero counter arrays are hashed by their length only.
+ */
+/* Our own creation */
+gcov_hash_t gcov_hash_counters(struct gcov_info *gi_ptr)
+{
+	const struct gcov_fn_info *fi_ptr;
+	const struct gcov_ctr_info *ci_ptr;
+	unsigned int fi_idx;
+	unsigned int ct_idx;
+	unsigned int cv_idx;
+	gcov_hash_t h = 0xcbf29ce484222325ULL;
+
+	h = hash_mix(h, ((gcov_hash_t)gi_ptr->stamp << 32) | gi_ptr->checksum);
+
+	for (fi_idx = 0; fi_idx < gi_ptr->n_functions; fi_idx++) {
+		fi_ptr = gi_ptr->functions[fi_idx];
+
+		ci_ptr = fi_ptr->ctrs;
+
+		for (ct_idx = 0; ct_idx < GCOV_COUNTERS; ct_idx++) {
+			if (!gi_ptr->merge[ct_idx]) {
+				/* Unused counter */
+				continue;
+			}
+
+			if (gcov_kernel_all_zero(ci_ptr->values, ci_ptr->num)) {
+				h = hash_mix(h, ~(gcov_hash_t)ci_ptr->num);
+			} else {
+				for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
+					h = hash_mix(h, (gcov_hash_t)ci_ptr->values[cv_idx]);
+				}
+			}
+			ci_ptr++;
+		}
+	}
+
+	return h;
+}
+
+/**
+ * gcov_count_nonzero - count the nonzero counter values of a profiling data set
+ * @info: profiling data set to be scanned
+ *
+ * A measure of how much of the file was exercised.
+ */
+/* Our own creation */
+gcov_unsigned_t gcov_count_nonzero(struct gcov_info *gi_ptr)
+{
+	const struct gcov_fn_info *fi_ptr;
+	const struct gcov_ctr_info *ci_ptr;
+	unsigned int fi_idx;
+	unsigned int ct_idx;
+	unsigned int cv_idx;
+	gcov_unsigned_t count = 0;
+
+	for (fi_idx = 0; fi_idx < gi_ptr->n_functions; fi_idx++) {
+		fi_ptr = gi_ptr->functions[fi_idx];
+
+		ci_ptr = fi_ptr->ctrs;
+
+		for (ct_idx = 0; ct_idx < GCOV_COUNTERS; ct_idx++) {
+			if (!gi_ptr->merge[ct_idx]) {
+				/* Unused counter */
+				continue;
+			}
+
+			if (!gcov_kernel_all_zero(ci_ptr->values, ci_ptr->num)) {
+				for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
+					count += (ci_ptr->values[cv_idx] != 0);
+				}
+			}
+			ci_ptr++;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * gcov_foreach - visit the functions and counter arrays of a profiling data set
+ * @info: profiling data set to be visited
+ * @fn_cb: called for each function, or %NULL
+ * @ctr_cb: called for each used counter array of each function, or %NULL
+ * @ctx: passed through to the callbacks
+ *
+ * The views point at the live data, nothing is copied.
+ * Returns the first nonzero callback return (which stops the walk), or 0.
+ */
+/* Our own creation */
+int gcov_foreach(struct gcov_info *gi_ptr, gcov_fn_cb_t fn_cb, gcov_ctr_cb_t ctr_cb, void *ctx)
+{
+	const struct gcov_fn_info *fi_ptr;
+	const struct gcov_ctr_info *ci_ptr;
+	unsigned int fi_idx;
+	unsigned int ct_idx;
+	gcov_fn_view_t fn;
+	gcov_ctr_view_t ctr;
+	int stop;
+
+	fn.filename = gi_ptr->filename;
+
+	for (fi_idx = 0; fi_idx < gi_ptr->n_functions; fi_idx++) {
+		fi_ptr = gi_ptr->functions[fi_idx];
+
+		fn.ident = fi_ptr->ident;
+		fn.lineno_checksum = fi_ptr->lineno_checksum;
+		fn.cfg_checksum = fi_ptr->cfg_checksum;
+		if (fn_cb && (stop = fn_cb(&fn, ctx)) != 0) {
+			return stop;
+		}
+		if (!ctr_cb) {
+			continue;
+		}
+
+		ci_ptr = fi_ptr->ctrs;
+
+		for (ct_idx = 0; ct_idx < GCOV_COUNTERS; ct_idx++) {
+			if (!gi_ptr->merge[ct_idx]) {
+				/* Unused counter */
+				continue;
+			}
+
+			ctr.kind = ct_idx;
+			ctr.num = ci_ptr->num;
+			ctr.values = ci_ptr->values;
+			if ((stop = ctr_cb(&fn, &ctr, ctx)) != 0) {
+				return stop;
+			}
+			ci_ptr++;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * gcov_edge_bucket - AFL hit count bucket of an arc counter value
+ * @count: nonzero counter value
+ *
+ * One bit per bucket: 1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128 and over.
+ */
+/* Our own creation */
+static unsigned char gcov_edge_bucket(gcov_type count)
+{
+	if (count <= 3) {
+		return (count == 3) ? 4 : (unsigned char)count;
+	}
+	if (count <= 31) {
+		return (count <= 7) ? 8 : (count <= 15) ? 16 : 32;
+	}
+	return (count <= 127) ? 64 : 128;
+}
+
+/**
+ * gcov_edge_map - fold the arc counters of a profiling data set into an edge map
+ * @info: profiling data set to be folded
+ * @file_index: position of @info in the list of files, part of each hash
+ * @map: edge map, ORed into
+ * @map_mask: map size less one (the size a power of two)
+ * @reset: nonzero to zero the counters that were nonzero
+ *
+ * The arcs of a function take consecutive bytes from a hash of
+ * @file_index and the function ident. Counter arrays that are all zero
+ * are skipped by the zero-test kernel, and cleared by the clear kernel.
+ * Returns the count of nonzero arc counters.
+ */
+/* Our own creation */
+gcov_unsigned_t gcov_edge_map(struct gcov_info *gi_ptr, gcov_unsigned_t file_index,
+			      unsigned char *map, gcov_unsigned_t map_mask, int reset)
+{
+	const struct gcov_fn_info *fi_ptr;
+	const struct gcov_ctr_info *ci_ptr;
+	unsigned int fi_idx;
+	unsigned int cv_idx;
+	gcov_unsigned_t base;
+	gcov_unsigned_t hits = 0;
+
+	if (!gi_ptr->merge[GCOV_COUNTER_ARCS]) {
+		return 0;
+	}
+
+	for (fi_idx = 0; fi_idx < gi_ptr->n_functions; fi_idx++) {
+		fi_ptr = gi_ptr->functions[fi_idx];
+
+		/* arc counters are the first used counter array */
+		ci_ptr = fi_ptr->ctrs;
+
+		if (gcov_kernel_all_zero(ci_ptr->values, ci_ptr->num)) {
+			continue;
+		}
+
+		base = (file_index * 0x9e3779b1U) ^ fi_ptr->ident;
+		base ^= base >> 16;
+		base *= 0x85ebca6bU;
+		base ^= base >> 13;
+
+		for (cv_idx = 0; cv_idx < ci_ptr->num; cv_idx++) {
+			if (ci_ptr->values[cv_idx]) {
+				map[(base + cv_idx) & map_mask] |= gcov_edge_bucket(ci_ptr->values[cv_idx]);
+				hits++;
+			}
+		}
+
+		if (reset) {
+			gcov_kernel_clear(ci_ptr->values, ci_ptr->num);
+		}
+	}
+
+	return hits;
+}
+
 /** @}
  */
 /*
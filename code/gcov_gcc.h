@@ -99,10 +99,64 @@ const char *gcov_info_filename(struct gcov_info *info);
 /* Need buffer to be 32-bit-aligned for type-safe internal usage */
 size_t gcov_convert_to_gcda(gcov_unsigned_t *buffer, struct gcov_info *info);
 
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+/* Convert internal gcov data tree into .gcds output format, zeroing counters */
+/* Our own creation */
+/* Need buffer to be 32-bit-aligned for type-safe internal usage */
+size_t gcov_convert_to_gcda_and_reset(gcov_unsigned_t *buffer, struct gcov_info *info);
+#endif
+
+/* Position within a conversion done in pieces by gcov_convert_to_gcda_part */
+/* Our own creation */
+struct gcov_convert_state {
+	gcov_unsigned_t rec;    /* record being output (file header, function, counters, done) */
+	gcov_unsigned_t fi_idx; /* function index */
+	gcov_unsigned_t ct_idx; /* counter type index */
+	gcov_unsigned_t ci_idx; /* index of used counter type within function */
+	gcov_unsigned_t word;   /* word index within record */
+	gcov_unsigned_t high;   /* high word of the counter value being output */
+	int reset;              /* nonzero to zero each counter value as it is output */
+};
+
+/* Convert internal gcov data tree into .gcds output format, in pieces */
+/* Our own creation (though based on gcc internals, see source code) */
+/* Need buffer to be 32-bit-aligned for type-safe internal usage */
+void gcov_convert_start(struct gcov_convert_state *state, int reset);
+size_t gcov_convert_to_gcda_part(gcov_unsigned_t *buffer, size_t max_bytes,
+				 struct gcov_info *info, struct gcov_convert_state *state);
+
 /* Convert internal gcov data tree into .gcds output format */
 /* Our own creation (though based on gcc internals, see source code) */
 void gcov_clear_counters(struct gcov_info *gi_ptr);
 
+/* 64-bit hash of the counter contents of a gcov_info (and its stamp) */
+/* Our own creation */
+gcov_hash_t gcov_hash_counters(struct gcov_info *gi_ptr);
+
+/* Count of nonzero counter values of a gcov_info */
+/* Our own creation */
+gcov_unsigned_t gcov_count_nonzero(struct gcov_info *gi_ptr);
+
+/* Visit the functions and counter arrays of a gcov_info in place */
+/* Our own creation */
+/* Either callback may be NULL */
+int gcov_foreach(struct gcov_info *gi_ptr, gcov_fn_cb_t fn_cb, gcov_ctr_cb_t ctr_cb, void *ctx);
+
+/* Fold the arc counters of a gcov_info into a fuzzing edge map, optionally zeroing them */
+/* Our own creation */
+/* map_mask is the map size less one, a power of two less one */
+gcov_unsigned_t gcov_edge_map(struct gcov_info *gi_ptr, gcov_unsigned_t file_index,
+			      unsigned char *map, gcov_unsigned_t map_mask, int reset);
+
+/* Kernels over one array of counter values */
+/* Our own creation */
+/* Scalar, or vector if GCOV_OPT_USE_VECTOR_KERNELS (see gcov_public.h) */
+void gcov_kernel_clear(gcov_type *values, gcov_unsigned_t num);
+int gcov_kernel_all_zero(const gcov_type *values, gcov_unsigned_t num);
+gcov_type gcov_kernel_or_reduce(const gcov_type *values, gcov_unsigned_t num);
+gcov_type gcov_kernel_max_reduce(const gcov_type *values, gcov_unsigned_t num);
+int gcov_kernel_equal(const gcov_type *values, const gcov_type *shadow, gcov_unsigned_t num);
+
 #endif /* GCOV_GCC_H */
 
 /** @}
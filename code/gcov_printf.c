@@ -256,6 +256,82 @@ void gcov_printf(const char *fmt, ...)
 	va_end(va);
 }
 
+
+
+
+/***********************************************************************
+ * Print primitives, for the GCOV_PRINT_* defs in gcov_public.h.
+ * Each prints one kind of value with no format string to parse
+ * and no variable argument list, for the dump loop.
+ **********************************************************************/
+static const char gcov_hex_digits[] = "0123456789abcdef";
+
+/**********************************************************************/
+/** @brief Print a string, as gcov_printf("%s", str)
+ *
+ * @param [in]     *str
+ *
+ **********************************************************************/
+void gcov_put_str(const char *str)
+{
+	while (*str) {
+		write_bytes(1,str,1);
+		str++;
+	}
+}
+
+/**********************************************************************/
+/** @brief Print a signed decimal number, as gcov_printf("%d", num)
+ *
+ * @param [in]     num
+ *
+ **********************************************************************/
+void gcov_put_dec(int num)
+{
+	char bf[12];
+	int n = sizeof(bf);
+	unsigned int u = (num < 0) ? 0u - (unsigned int)num : (unsigned int)num;
+
+	do {
+		bf[--n] = (char)('0' + u % 10);
+		u /= 10;
+	} while (u);
+	if (num < 0) {
+		bf[--n] = '-';
+	}
+	while (n < (int)sizeof(bf)) {
+		write_bytes(1,&bf[n],1);
+		n++;
+	}
+}
+
+/**********************************************************************/
+/** @brief Print 8 hex digits, as gcov_printf("%08x", num)
+ *
+ * @param [in]     num
+ *
+ **********************************************************************/
+void gcov_put_u32_hex8(gcov_unsigned_t num)
+{
+	int shift;
+
+	for (shift = 28; shift >= 0; shift -= 4) {
+		write_bytes(1,&gcov_hex_digits[(num >> shift) & 0xf],1);
+	}
+}
+
+/**********************************************************************/
+/** @brief Print 2 hex digits, as gcov_printf("%02x", num)
+ *
+ * @param [in]     num
+ *
+ **********************************************************************/
+void gcov_put_u8_hex2(unsigned char num)
+{
+	write_bytes(1,&gcov_hex_digits[num >> 4],1);
+	write_bytes(1,&gcov_hex_digits[num & 0xf],1);
+}
+
 #endif // GCOV_OPT_PROVIDE_PRINTF_IMITATION
 
 
@@ -76,26 +76,77 @@ typedef unsigned int u32;
  * that you have compiled for coverage. */
 static unsigned char *gcov_output_buffer = (unsigned char *)(0x42000000);
 static gcov_unsigned_t gcov_output_index;
+/* You need to set the size of your memory block.
+ * Output beyond it is dropped (the end marker will be missing). */
+#define GCOV_OUTPUT_BINARY_MEMORY_BYTES 0x100000
+#define GCOV_OUTPUT_MEMORY_PUT(c) do { \
+    if (gcov_output_index < GCOV_OUTPUT_BINARY_MEMORY_BYTES) { \
+        gcov_output_buffer[gcov_output_index++] = (c); \
+    } } while (0)
 #endif // GCOV_OPT_OUTPUT_BINARY_MEMORY
 
+#if defined(GCOV_OPT_OUTPUT_BINARY_FILE) || defined(GCOV_OPT_OUTPUT_BINARY_MEMORY) \
+    || defined(GCOV_OPT_OUTPUT_SERIAL_HEXDUMP) || defined(GCOV_OPT_OUTPUT_SERIAL_CHUNKED) \
+    || defined(GCOV_OPT_OUTPUT_GCDA_FILES)
+/* These outputs need each file converted whole into one buffer */
+/* (the outputs of GCOV_OUTPUT_STREAM below alone convert in pieces) */
+#define GCOV_OUTPUT_WHOLE_FILE
+#endif
+
+#if defined(GCOV_OPT_OUTPUT_DMA) || defined(GCOV_OPT_OUTPUT_FLASH) || defined(GCOV_OPT_OUTPUT_MEMORY_RING) \
+    || defined(GCOV_OPT_OUTPUT_BINARY_MMAP)
+/* These outputs take the binary format through gcov_stream_put */
+#define GCOV_OUTPUT_STREAM
+#endif
+
 typedef struct tagGcovInfo {
     struct gcov_info *info;
     struct tagGcovInfo *next;
+#ifdef GCOV_OPT_BUDGET_DUMP
+    gcov_hash_t hash;           // counter hash when ranked
+    gcov_hash_t sentHash;       // counter hash when last output
+    gcov_unsigned_t sent;       // nonzero once output
+    gcov_unsigned_t priority;   // set by __gcov_set_priority
+    gcov_unsigned_t score;      // nonzero counters per KB of data
+    gcov_unsigned_t selected;   // to be output within the budget
+#endif // GCOV_OPT_BUDGET_DUMP
 } GcovInfo;
 static GcovInfo *gcov_headGcov = NULL;
 
 #ifndef GCOV_OPT_USE_MALLOC
 /* Declare space. Need one entry per file compiled for coverage. */
+/* tools/gcov_budget reports the count, and the gcov_buf size below. */
 static GcovInfo gcov_GcovInfo[100];
 static gcov_unsigned_t gcov_GcovIndex = 0;
 
+#ifdef GCOV_OUTPUT_WHOLE_FILE
 /* Declare space. Needs to be enough for the largest single file coverage data. */
 /* Size used will depend on size and complexity of source code
  * that you have compiled for coverage. */
 /* Need buffer to be 32-bit-aligned for type-safe internal usage */
 gcov_unsigned_t gcov_buf[8192];
+#endif // GCOV_OUTPUT_WHOLE_FILE
 #endif // not GCOV_OPT_USE_MALLOC
 
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+/* Position up to which the host has acknowledged receiving the output,
+ * found (and set) by a debugger by symbol, or at GCOV_ACK_ADDRESS.
+ * To resume across a processor reset, this and the counters
+ * need to be in memory not initialized at startup. */
+#ifdef GCOV_ACK_ADDRESS
+#define gcov_ack (*(volatile gcov_ack_t *)(GCOV_ACK_ADDRESS))
+#else
+volatile gcov_ack_t gcov_ack;
+#endif // GCOV_ACK_ADDRESS
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+#ifdef GCOV_OPT_HASH_DEDUP
+/* Hashes of file counter contents that the host already has.
+ * Not static, so that a debugger can fill them in directly by symbol. */
+gcov_hash_t gcov_known_hashes[GCOV_KNOWN_HASHES_MAX];
+gcov_unsigned_t gcov_known_hash_count = 0;
+#endif // GCOV_OPT_HASH_DEDUP
+
 /* ----------------------------------------------------------- */
 /*
  * __gcov_init is called by gcc-generated constructor code for each
@@ -143,6 +194,14 @@ void __gcov_init(struct gcov_info *info)
 
     newHead->info = info;
     newHead->next = gcov_headGcov;
+#ifdef GCOV_OPT_BUDGET_DUMP
+    newHead->hash = 0;
+    newHead->sentHash = 0;
+    newHead->sent = 0;
+    newHead->priority = 0;
+    newHead->score = 0;
+    newHead->selected = 0;
+#endif // GCOV_OPT_BUDGET_DUMP
     gcov_headGcov = newHead;
 
 #ifndef GCOV_OPT_USE_MALLOC
@@ -213,14 +272,1281 @@ void __gcov_call_constructors(void) {
 
 
 /* ----------------------------------------------------------- */
+#ifdef GCOV_OPT_HASH_DEDUP
 /*
- * __gcov_exit needs to be called in your code at the point
- * where you want to generate coverage data for extraction.
+ * gcov_hash_known checks the table of hashes known to the host.
  */
-void __gcov_exit(void)
+static int gcov_hash_known(gcov_hash_t hash)
+{
+    gcov_unsigned_t count = gcov_known_hash_count;
+
+    if (count > GCOV_KNOWN_HASHES_MAX) {
+        count = GCOV_KNOWN_HASHES_MAX;
+    }
+
+    for (gcov_unsigned_t i=0; i<count; i++) {
+        if (gcov_known_hashes[i] == hash) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * gcov_print_hash prints one line of the hash handshake:
+ * label, file index, 16 hex digit hash, and filename.
+ */
+static void gcov_print_hash(const char *label, u32 index, gcov_hash_t hash, struct gcov_info *info)
+{
+    GCOV_PRINT_STR(label);
+    GCOV_PRINT_NUM(index);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_HEX32((gcov_unsigned_t)(hash >> 32));
+    GCOV_PRINT_HEX32((gcov_unsigned_t)(hash));
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_STR(gcov_info_filename(info));
+    GCOV_PRINT_STR("\n");
+}
+#endif // GCOV_OPT_HASH_DEDUP
+
+/* ----------------------------------------------------------- */
+#if defined(GCOV_OPT_OUTPUT_SERIAL_CHUNKED) || defined(GCOV_OPT_OUTPUT_FLASH)
+/*
+ * gcov_crc16 updates a CRC-16/CCITT with one byte.
+ * Bitwise, to avoid a table in small systems.
+ */
+static gcov_unsigned_t gcov_crc16(gcov_unsigned_t crc, unsigned char byte)
+{
+    crc ^= (gcov_unsigned_t)byte << 8;
+    for (int bit=0; bit<8; bit++) {
+        crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+
+    return crc & 0xffff;
+}
+#endif
+
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+/*
+ * gcov_ack_setup starts the cursor from the beginning,
+ * if it was never set up (or is in memory not yet initialized).
+ */
+static void gcov_ack_setup(void)
+{
+    if (gcov_ack.magic != GCOV_ACK_MAGIC) {
+        gcov_ack.entry = 0;
+        gcov_ack.offset = 0;
+        gcov_ack.sent = 0;
+        gcov_ack.check = 0;
+        gcov_ack.magic = GCOV_ACK_MAGIC;
+    }
+}
+
+/*
+ * gcov_data_check returns a 32-bit check (FNV-1a) of the data
+ * of a file entry, to tell whether it is the data sent before.
+ */
+static u32 gcov_data_check(const unsigned char *data, u32 bytes)
+{
+    u32 check = 0x811c9dc5;
+
+    for (u32 i=0; i<bytes; i++) {
+        check = (check ^ data[i]) * 0x01000193;
+    }
+
+    return check;
+}
+
+/*
+ * gcov_acked returns how many bytes of this file entry
+ * the host has acknowledged.
+ */
+static u32 gcov_acked(u32 entry, u32 bytes)
+{
+    u32 ack_entry = gcov_ack.entry;
+    u32 ack_offset = gcov_ack.offset;
+
+    if (ack_entry > entry) {
+        return bytes;
+    }
+    if (ack_entry < entry) {
+        return 0;
+    }
+
+    return (ack_offset > bytes) ? bytes : ack_offset;
+}
+
+/*
+ * gcov_send_chunk prints one chunk line:
+ * "Gcov Chunk <entry> <offset> <length> <crc>: <hex bytes>"
+ * with the CRC over entry and offset (4 bytes each, MSB first) and data.
+ */
+static void gcov_send_chunk(u32 entry, u32 offset, const unsigned char *data, u32 len)
+{
+    gcov_unsigned_t crc = 0xffff;
+
+    for (int shift=24; shift>=0; shift-=8) {
+        crc = gcov_crc16(crc, (unsigned char)(entry >> shift));
+    }
+    for (int shift=24; shift>=0; shift-=8) {
+        crc = gcov_crc16(crc, (unsigned char)(offset >> shift));
+    }
+    for (u32 i=0; i<len; i++) {
+        crc = gcov_crc16(crc, data[i]);
+    }
+
+    GCOV_PRINT_STR("Gcov Chunk ");
+    GCOV_PRINT_NUM(entry);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(offset);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(len);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_HEX32(crc);
+    GCOV_PRINT_STR(": ");
+    for (u32 i=0; i<len; i++) {
+        GCOV_PRINT_HEXDUMP_DATA(data[i]);
+    }
+    GCOV_PRINT_STR("\n");
+}
+
+/*
+ * gcov_send_entry prints the line that starts a file entry:
+ * "Gcov Entry <entry> <bytes> <check> <filename>"
+ * with the check of its data, so that the host can tell
+ * new data from the data of an earlier transfer.
+ */
+static void gcov_send_entry(u32 entry, u32 bytes, u32 check, const char *filename)
+{
+    GCOV_PRINT_STR("Gcov Entry ");
+    GCOV_PRINT_NUM(entry);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(bytes);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_HEX32(check);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_STR(filename);
+    GCOV_PRINT_STR("\n");
+}
+
+/*
+ * gcov_send_chunks sends one file entry as chunks,
+ * starting from the last acknowledged position, keeping up to
+ * GCOV_CHUNK_WINDOW chunks in flight and going back to the last
+ * acknowledged position on timeout, with only that chunk in flight
+ * until it is acknowledged (the host has likely kept the ones after it,
+ * and then acknowledges past them).
+ * Returns zero if the host stopped acknowledging.
+ */
+static int gcov_send_chunks(u32 entry, const unsigned char *data, u32 bytes, const char *filename)
+{
+    u32 check = gcov_data_check(data, bytes);
+    u32 offset;
+    u32 acked;
+    u32 retries = 0;
+    u32 window = GCOV_CHUNK_WINDOW;
+
+    /* The acknowledged part of other data for this entry is no use,
+     * so start it over. (If the host is still behind on an earlier
+     * entry, the check of that one is kept, for resuming it.) */
+    if (gcov_ack.entry == entry) {
+        if (gcov_ack.sent != entry || gcov_ack.check != check) {
+            gcov_ack.offset = 0;
+        }
+        gcov_ack.sent = entry;
+        gcov_ack.check = check;
+    }
+
+    offset = gcov_acked(entry, bytes);
+    acked = offset;
+    if (offset >= bytes) {
+        /* already have it all */
+        return 1;
+    }
+
+    gcov_send_entry(entry, bytes, check, filename);
+
+    for (;;) {
+        while ((offset < bytes) &&
+               ((GCOV_CHUNK_WINDOW == 0) || (offset < acked + window * GCOV_CHUNK_BYTES))) {
+            u32 len = bytes - offset;
+
+            if (len > GCOV_CHUNK_BYTES) {
+                len = GCOV_CHUNK_BYTES;
+            }
+            gcov_send_chunk(entry, offset, data + offset, len);
+            offset += len;
+        }
+
+        if (GCOV_CHUNK_WINDOW == 0) {
+            /* not waiting, any loss is resumed by the next __gcov_exit */
+            return 1;
+        }
+
+        /* wait for the acknowledgment to move */
+        for (u32 polls=0; polls<GCOV_CHUNK_TIMEOUT; polls++) {
+            GCOV_CHUNK_POLL();
+            if (gcov_acked(entry, bytes) != acked) {
+                break;
+            }
+        }
+
+        if (gcov_acked(entry, bytes) != acked) {
+            u32 now = gcov_acked(entry, bytes);
+
+            if ((now < acked) || (offset < now)) {
+                /* host asked for data again, or is ahead of us */
+                offset = now;
+            }
+            acked = now;
+            retries = 0;
+            window = GCOV_CHUNK_WINDOW;
+            if (acked >= bytes) {
+                return 1;
+            }
+        } else {
+            /* lost chunk or acknowledgment, go back */
+            if (++retries > GCOV_CHUNK_RETRIES) {
+                return 0;
+            }
+            offset = acked;
+            window = 1;
+
+            /* repeat the entry line, in case the host missed it */
+            gcov_send_entry(entry, bytes, check, filename);
+        }
+    }
+}
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+#ifdef GCOV_OPT_OUTPUT_GCDA_FILES
+/* ----------------------------------------------------------- */
+static char gcov_gcda_path[GCOV_GCDA_PATH_MAX];
+
+/*
+ * Make the .gcda path for a filename into gcov_gcda_path,
+ * with prefix and strip as libgcov does.
+ * Returns 0 if the path fits.
+ */
+static int gcov_gcda_make_path(const char *filename)
+{
+    const char *prefix = GCOV_GCDA_PREFIX;
+    long strip = GCOV_GCDA_PREFIX_STRIP;
+    const char *rest = filename;
+    u32 len = 0;
+
+#ifdef GCOV_OPT_USE_STDLIB
+    if (getenv("GCOV_PREFIX")) {
+        prefix = getenv("GCOV_PREFIX");
+    }
+    if (getenv("GCOV_PREFIX_STRIP")) {
+        strip = strtol(getenv("GCOV_PREFIX_STRIP"), NULL, 10);
+    }
+#endif // GCOV_OPT_USE_STDLIB
+
+    if (prefix[0]) {
+        /* drop leading directories, keeping the slash before the rest */
+        for (const char *p = filename + 1; *p && strip > 0; p++) {
+            if (*p == '/') {
+                rest = p;
+                strip--;
+            }
+        }
+        while (*prefix && len < sizeof(gcov_gcda_path) - 1) {
+            gcov_gcda_path[len++] = *prefix++;
+        }
+        if (rest[0] != '/' && len < sizeof(gcov_gcda_path) - 1) {
+            gcov_gcda_path[len++] = '/';
+        }
+    }
+    while (*rest && len < sizeof(gcov_gcda_path) - 1) {
+        gcov_gcda_path[len++] = *rest++;
+    }
+    gcov_gcda_path[len] = '\0';
+
+    return (*prefix || *rest) ? -1 : 0;
+}
+
+/* Create the directories of gcov_gcda_path, as mkdir -p */
+static void gcov_gcda_make_dirs(void)
+{
+    for (char *p = gcov_gcda_path + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            (void)mkdir(gcov_gcda_path, 0755); // may already exist
+            *p = '/';
+        }
+    }
+}
+
+/* Write one .gcda file */
+static void gcov_gcda_write(const char *filename, const unsigned char *data, u32 bytes)
+{
+    int fd;
+    int ok;
+
+    if (gcov_gcda_make_path(filename) != 0) {
+#ifdef GCOV_OPT_PRINT_STATUS
+        GCOV_PRINT_STR("Path too long for "); GCOV_PRINT_STR(filename); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+        return;
+    }
+
+    fd = open(gcov_gcda_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 && errno == ENOENT) {
+        /* only when needed, as most files go to existing directories */
+        gcov_gcda_make_dirs();
+        fd = open(gcov_gcda_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    ok = (fd >= 0);
+    if (ok) {
+        while (bytes > 0) {
+            ssize_t got = write(fd, data, bytes);
+
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                ok = 0;
+                break;
+            }
+            data += got;
+            bytes -= (u32)got;
+        }
+        if (close(fd) != 0) {
+            ok = 0;
+        }
+    }
+    if (!ok) {
+#ifdef GCOV_OPT_PRINT_STATUS
+        GCOV_PRINT_STR("Unable to write "); GCOV_PRINT_STR(gcov_gcda_path); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+    }
+}
+#endif // GCOV_OPT_OUTPUT_GCDA_FILES
+
+#ifdef GCOV_OPT_OUTPUT_DMA
+/* ----------------------------------------------------------- */
+/* DMA buffers, filled in turn, and the queue of those
+ * waiting for or in transmission (from gcov_dma_head on).
+ * The buffer being filled is always the one after the queue.
+ */
+/* Need buffers to be 32-bit-aligned for type-safe internal usage */
+static gcov_unsigned_t gcov_dma_buf[GCOV_DMA_BUFFERS][GCOV_DMA_CHUNK_BYTES / 4];
+static u32 gcov_dma_len[GCOV_DMA_BUFFERS];
+static u32 gcov_dma_fill = 0;               // buffer being filled
+static u32 gcov_dma_used = 0;               // bytes in buffer being filled
+static volatile u32 gcov_dma_head = 0;      // buffer being transmitted
+static volatile u32 gcov_dma_queued = 0;    // count of buffers in the queue
+
+/*
+ * __gcov_dma_complete is called by your DMA completion interrupt
+ * (or from GCOV_DMA_POLL) when the transmission started by
+ * GCOV_DMA_START is done. Starts the next buffer, if one is waiting.
+ */
+void __gcov_dma_complete(void)
+{
+    u32 head;
+
+    if (gcov_dma_queued == 0) {
+        return; // nothing was in transmission
+    }
+    head = (gcov_dma_head + 1) % GCOV_DMA_BUFFERS;
+    gcov_dma_head = head;
+    if (--gcov_dma_queued > 0) {
+        GCOV_DMA_START((unsigned char *)gcov_dma_buf[head], gcov_dma_len[head]);
+    }
+}
+
+/*
+ * Queue the buffer being filled for transmission,
+ * then wait until the next buffer is free to fill.
+ */
+static void gcov_dma_submit(void)
+{
+    u32 fill = gcov_dma_fill;
+    int start;
+
+    gcov_dma_len[fill] = gcov_dma_used;
+    GCOV_CRITICAL_ENTER();
+    start = (gcov_dma_queued++ == 0);
+    GCOV_CRITICAL_EXIT();
+    gcov_dma_fill = (fill + 1) % GCOV_DMA_BUFFERS;
+    gcov_dma_used = 0;
+
+    /* If nothing was in transmission, the completion won't start this one */
+    if (start) {
+        GCOV_DMA_START((unsigned char *)gcov_dma_buf[fill], gcov_dma_len[fill]);
+    }
+
+    while (gcov_dma_queued == GCOV_DMA_BUFFERS) {
+        GCOV_DMA_POLL();
+    }
+}
+
+/* Copy bytes into the DMA buffers */
+static void gcov_dma_put(const unsigned char *data, u32 len)
+{
+    while (len--) {
+        ((unsigned char *)gcov_dma_buf[gcov_dma_fill])[gcov_dma_used++] = (*data++);
+        if (gcov_dma_used == GCOV_DMA_CHUNK_BYTES) {
+            gcov_dma_submit();
+        }
+    }
+}
+
+/* Queue the last buffer, then wait for the transmission of all */
+static void gcov_dma_finish(void)
+{
+    if (gcov_dma_used) {
+        gcov_dma_submit();
+    }
+    while (gcov_dma_queued) {
+        GCOV_DMA_POLL();
+    }
+}
+#endif // GCOV_OPT_OUTPUT_DMA
+
+#if defined(GCOV_OPT_OUTPUT_FLASH) && defined(GCOV_OPT_FLASH_SIMULATOR)
+/* ----------------------------------------------------------- */
+/* RAM standing in for flash, to try GCOV_OPT_OUTPUT_FLASH on a host.
+ * Not static, so that it can be saved to (or loaded from) a file
+ * as a flash image. Programming can only clear bits, as in NOR flash.
+ */
+unsigned char gcov_flash_sim[GCOV_FLASH_SLOTS * GCOV_FLASH_SLOT_BYTES];
+
+int gcov_flash_sim_erase(gcov_unsigned_t addr, gcov_unsigned_t len)
+{
+    u32 off = addr - GCOV_FLASH_ADDRESS;
+
+    if (off > sizeof(gcov_flash_sim) || len > sizeof(gcov_flash_sim) - off) {
+        return -1;
+    }
+    while (len--) {
+        gcov_flash_sim[off++] = 0xff;
+    }
+    return 0;
+}
+
+int gcov_flash_sim_program(gcov_unsigned_t addr, const unsigned char *data)
+{
+    u32 off = addr - GCOV_FLASH_ADDRESS;
+    int status = 0;
+
+    if ((off % GCOV_FLASH_PAGE_BYTES) || off >= sizeof(gcov_flash_sim)) {
+        return -1;
+    }
+    for (u32 i = 0; i < GCOV_FLASH_PAGE_BYTES; i++) {
+        if ((gcov_flash_sim[off] & data[i]) != data[i]) {
+            status = -1; // not erased
+        }
+        gcov_flash_sim[off++] &= data[i];
+    }
+    return status;
+}
+
+int gcov_flash_sim_read(gcov_unsigned_t addr, unsigned char *data, gcov_unsigned_t len)
+{
+    u32 off = addr - GCOV_FLASH_ADDRESS;
+
+    if (off > sizeof(gcov_flash_sim) || len > sizeof(gcov_flash_sim) - off) {
+        return -1;
+    }
+    while (len--) {
+        (*data++) = gcov_flash_sim[off++];
+    }
+    return 0;
+}
+#endif // GCOV_OPT_OUTPUT_FLASH && GCOV_OPT_FLASH_SIMULATOR
+
+#ifdef GCOV_OPT_OUTPUT_FLASH
+/* ----------------------------------------------------------- */
+/* Flash dump slots.
+ * Page 0 of each slot is the slot header (see gcov_flash_finish),
+ * programmed last; the binary format data follows from page 1 on.
+ */
+#define GCOV_FLASH_SLOT_ADDRESS(slot) (GCOV_FLASH_ADDRESS + (slot) * GCOV_FLASH_SLOT_BYTES)
+#define GCOV_FLASH_HEADER_BYTES 28
+
+/* Need page to be 32-bit-aligned for flash drivers */
+static gcov_unsigned_t gcov_flash_page[GCOV_FLASH_PAGE_BYTES / 4];
+static u32 gcov_flash_used = 0;             // bytes in page buffer
+static u32 gcov_flash_offset = 0;           // slot offset of page buffer
+static u32 gcov_flash_bytes = 0;            // data bytes output to slot
+static u32 gcov_flash_crc = 0;              // CRC of data bytes
+static u32 gcov_flash_slot = 0;             // slot being (or last) written
+static u32 gcov_flash_seq = 0;              // sequence number of that slot
+static int gcov_flash_scanned = 0;          // newest slot has been found
+static int gcov_flash_erased = -1;          // slot erased ahead, or -1
+static int gcov_flash_error = 0;            // dump can't be completed
+
+/* Big-endian field of the slot header */
+static u32 gcov_flash_field(const unsigned char *p)
+{
+    return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | p[3];
+}
+
+static void gcov_flash_set_field(unsigned char *p, u32 value)
+{
+    /* we don't know endianness, so use division for consistent MSB first */
+    p[0] = (unsigned char)(value / 16777216);
+    p[1] = (unsigned char)(value / 65536);
+    p[2] = (unsigned char)(value / 256);
+    p[3] = (unsigned char)(value);
+}
+
+/* CRC of the slot header fields before the CRC itself */
+static u32 gcov_flash_header_crc(const unsigned char *header)
+{
+    u32 crc = 0xffff;
+
+    for (u32 i = 0; i < GCOV_FLASH_HEADER_BYTES - 4; i++) {
+        crc = gcov_crc16(crc, header[i]);
+    }
+    return crc;
+}
+
+/* Pick the slot after the newest, and erase it unless already erased */
+static void gcov_flash_begin(void)
+{
+    unsigned char header[GCOV_FLASH_HEADER_BYTES];
+
+    if (!gcov_flash_scanned) {
+        /* if no slot is valid, start with slot 0 */
+        gcov_flash_slot = GCOV_FLASH_SLOTS - 1;
+        gcov_flash_seq = 0;
+        for (u32 slot = 0; slot < GCOV_FLASH_SLOTS; slot++) {
+            if (GCOV_FLASH_READ(GCOV_FLASH_SLOT_ADDRESS(slot), header, sizeof(header)) == 0
+                && header[0] == 'G' && header[1] == 'c' && header[2] == 'v' && header[3] == 'F'
+                && gcov_flash_field(&header[24]) == gcov_flash_header_crc(header)
+                && gcov_flash_field(&header[4]) > gcov_flash_seq) {
+                gcov_flash_slot = slot;
+                gcov_flash_seq = gcov_flash_field(&header[4]);
+            }
+        }
+        gcov_flash_scanned = 1;
+    }
+
+    gcov_flash_slot = (gcov_flash_slot + 1) % GCOV_FLASH_SLOTS;
+    gcov_flash_seq++;
+    gcov_flash_error = 0;
+    if (gcov_flash_erased != (int)gcov_flash_slot) {
+        if (GCOV_FLASH_ERASE(GCOV_FLASH_SLOT_ADDRESS(gcov_flash_slot), GCOV_FLASH_SLOT_BYTES) != 0) {
+            gcov_flash_error = 1;
+        }
+    }
+    gcov_flash_erased = -1;
+
+    gcov_flash_used = 0;
+    gcov_flash_offset = GCOV_FLASH_PAGE_BYTES;
+    gcov_flash_bytes = 0;
+    gcov_flash_crc = 0xffff;
+}
+
+/* Program the page buffer, padded with erased bytes */
+static void gcov_flash_program(u32 offset)
+{
+    while (gcov_flash_used < GCOV_FLASH_PAGE_BYTES) {
+        ((unsigned char *)gcov_flash_page)[gcov_flash_used++] = 0xff;
+    }
+    if (GCOV_FLASH_PROGRAM(GCOV_FLASH_SLOT_ADDRESS(gcov_flash_slot) + offset,
+                           (unsigned char *)gcov_flash_page) != 0) {
+        gcov_flash_error = 1;
+    }
+    gcov_flash_used = 0;
+}
+
+/* Copy bytes into the page buffer, programming each page when full */
+static void gcov_flash_put(const unsigned char *data, u32 len)
+{
+    while (len-- && !gcov_flash_error) {
+        if (gcov_flash_offset >= GCOV_FLASH_SLOT_BYTES) {
+            gcov_flash_error = 1; // slot full
+            break;
+        }
+        gcov_flash_crc = gcov_crc16(gcov_flash_crc, *data);
+        ((unsigned char *)gcov_flash_page)[gcov_flash_used++] = (*data++);
+        gcov_flash_bytes++;
+        if (gcov_flash_used == GCOV_FLASH_PAGE_BYTES) {
+            gcov_flash_program(gcov_flash_offset);
+            gcov_flash_offset += GCOV_FLASH_PAGE_BYTES;
+        }
+    }
+}
+
+/*
+ * Program the last page, then the slot header page, which makes the dump valid:
+ * "GcvF", sequence number, data byte count, data CRC-16,
+ * page size, slot size, and CRC-16 of the header so far,
+ * each 4 bytes MSB first.
+ * Then erase the next slot ahead of the next dump.
+ */
+static void gcov_flash_finish(void)
+{
+    unsigned char *header = (unsigned char *)gcov_flash_page;
+    u32 next;
+
+    if (gcov_flash_used && !gcov_flash_error) {
+        gcov_flash_program(gcov_flash_offset);
+    }
+    if (!gcov_flash_error) {
+        header[0] = 'G';
+        header[1] = 'c';
+        header[2] = 'v';
+        header[3] = 'F';
+        gcov_flash_set_field(&header[4], gcov_flash_seq);
+        gcov_flash_set_field(&header[8], gcov_flash_bytes);
+        gcov_flash_set_field(&header[12], gcov_flash_crc);
+        gcov_flash_set_field(&header[16], GCOV_FLASH_PAGE_BYTES);
+        gcov_flash_set_field(&header[20], GCOV_FLASH_SLOT_BYTES);
+        gcov_flash_set_field(&header[24], gcov_flash_header_crc(header));
+        gcov_flash_used = GCOV_FLASH_HEADER_BYTES;
+        gcov_flash_program(0);
+    }
+    if (gcov_flash_error) {
+#ifdef GCOV_OPT_PRINT_STATUS
+        GCOV_PRINT_STR("Gcov flash dump failed"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+        /* keep the newest valid dump (if any) as the newest */
+        gcov_flash_seq--;
+        return;
+    }
+
+    /* With only one slot, this would erase the dump just made */
+    next = (gcov_flash_slot + 1) % GCOV_FLASH_SLOTS;
+    if (next != gcov_flash_slot
+        && GCOV_FLASH_ERASE(GCOV_FLASH_SLOT_ADDRESS(next), GCOV_FLASH_SLOT_BYTES) == 0) {
+        gcov_flash_erased = (int)next;
+    }
+}
+#endif // GCOV_OPT_OUTPUT_FLASH
+
+#ifdef GCOV_OPT_OUTPUT_MEMORY_RING
+/* ----------------------------------------------------------- */
+/* Memory ring, found by a debugger by symbol, or at GCOV_RING_ADDRESS */
+#ifdef GCOV_RING_ADDRESS
+#define gcov_ring (*(gcov_ring_t *)(GCOV_RING_ADDRESS))
+#else
+gcov_ring_t gcov_ring;
+#endif // GCOV_RING_ADDRESS
+
+static u32 gcov_ring_pos = 0;               // data offset of next byte
+static u32 gcov_ring_dump_bytes = 0;        // bytes stored for this dump
+#if GCOV_RING_POLICY == GCOV_RING_COMPRESS
+static u32 gcov_ring_zeros = 0;             // zero bytes not yet stored
+#endif
+
+/* Start a dump: after the previous one if wrapping, else from the beginning */
+static void gcov_ring_begin(void)
+{
+    if (GCOV_RING_POLICY != GCOV_RING_WRAP
+        || gcov_ring.magic != GCOV_RING_MAGIC
+        || gcov_ring.capacity != GCOV_RING_BYTES
+        || gcov_ring.start >= GCOV_RING_BYTES
+        || gcov_ring.length > GCOV_RING_BYTES) {
+        gcov_ring.magic = GCOV_RING_MAGIC;
+        gcov_ring.policy = GCOV_RING_POLICY;
+        gcov_ring.capacity = GCOV_RING_BYTES;
+        gcov_ring.generation = 0;
+        gcov_ring.start = 0;
+        gcov_ring.length = 0;
+    }
+    gcov_ring_pos = (gcov_ring.start + gcov_ring.length) % GCOV_RING_BYTES;
+    gcov_ring.dump = gcov_ring_pos;
+    gcov_ring.status = GCOV_RING_IN_PROGRESS;
+    gcov_ring_dump_bytes = 0;
+#if GCOV_RING_POLICY == GCOV_RING_COMPRESS
+    gcov_ring_zeros = 0;
+#endif
+}
+
+/* Store one byte as the policy says */
+static void gcov_ring_store(unsigned char c)
+{
+    if (gcov_ring.status == GCOV_RING_TRUNCATED) {
+        return;
+    }
+    if (GCOV_RING_POLICY != GCOV_RING_WRAP && gcov_ring.length == GCOV_RING_BYTES) {
+        gcov_ring.status = GCOV_RING_TRUNCATED; // full, so stop
+        return;
+    }
+
+    gcov_ring.data[gcov_ring_pos++] = c;
+    if (gcov_ring_pos == GCOV_RING_BYTES) {
+        /* (only GCOV_RING_WRAP gets here with more to store) */
+        gcov_ring_pos = 0;
+        if (GCOV_RING_POLICY == GCOV_RING_WRAP) {
+            gcov_ring.generation++;
+        }
+    }
+    if (gcov_ring.length < GCOV_RING_BYTES) {
+        gcov_ring.length++;
+    } else {
+        /* overwrote the oldest byte */
+        gcov_ring.start = gcov_ring_pos;
+    }
+    if (++gcov_ring_dump_bytes > GCOV_RING_BYTES) {
+        /* this dump overwrote its own beginning */
+        gcov_ring.status = GCOV_RING_TRUNCATED;
+    }
+}
+
+#if GCOV_RING_POLICY == GCOV_RING_COMPRESS
+/* Store any run of zero bytes as a zero byte and a count */
+static void gcov_ring_flush_zeros(void)
+{
+    if (gcov_ring_zeros) {
+        gcov_ring_store(0);
+        gcov_ring_store((unsigned char)gcov_ring_zeros);
+        gcov_ring_zeros = 0;
+    }
+}
+#endif
+
+/* Store bytes, compressing runs of zero bytes if GCOV_RING_COMPRESS */
+static void gcov_ring_put(const unsigned char *data, u32 len)
+{
+    while (len--) {
+#if GCOV_RING_POLICY == GCOV_RING_COMPRESS
+        if (*data == 0) {
+            if (++gcov_ring_zeros == 255) {
+                gcov_ring_flush_zeros();
+            }
+            data++;
+            continue;
+        }
+        gcov_ring_flush_zeros();
+#endif
+        gcov_ring_store(*data++);
+    }
+}
+
+/* Mark the dump complete, unless truncated */
+static void gcov_ring_finish(void)
+{
+#if GCOV_RING_POLICY == GCOV_RING_COMPRESS
+    gcov_ring_flush_zeros();
+#endif
+    if (gcov_ring.status == GCOV_RING_IN_PROGRESS) {
+        gcov_ring.status = GCOV_RING_COMPLETE;
+    }
+#ifdef GCOV_OPT_PRINT_STATUS
+    else {
+        GCOV_PRINT_STR("Gcov memory ring full"); GCOV_PRINT_STR("\n");
+    }
+#endif // GCOV_OPT_PRINT_STATUS
+}
+#endif // GCOV_OPT_OUTPUT_MEMORY_RING
+
+#ifdef GCOV_OPT_OUTPUT_BINARY_MMAP
+/* ----------------------------------------------------------- */
+static unsigned char *gcov_mmap_base = NULL;    // mapping, or NULL if none
+static size_t gcov_mmap_size = 0;               // bytes mapped
+static size_t gcov_mmap_used = 0;               // bytes output
+static int gcov_mmap_full = 0;                  // data did not fit, output nothing more
+static int gcov_mmap_fd = -1;
+
+/* Size the output file for all files, and map it */
+static void gcov_mmap_begin(void)
+{
+    size_t size = sizeof("Gcov End"); // end marker with trailing null char
+
+    /* Upper bound, as some files may be skipped */
+    for (GcovInfo *listptr = gcov_headGcov; listptr; listptr = listptr->next) {
+        size_t bytes = gcov_convert_to_gcda(NULL, listptr->info);
+
+#ifdef GCOV_OPT_PACK_CONDITIONS
+        /* a packed counter of 8 bytes takes up to 10 (LEB128 of 64 bits),
+         * so allow for that as if all the data were condition counters */
+        bytes += bytes / 4;
+#endif // GCOV_OPT_PACK_CONDITIONS
+        size += strlen(gcov_info_filename(listptr->info)) + 1 + 4 + bytes;
+    }
+#ifdef GCOV_OPT_COMPRESS_LZ
+    /* at worst a flag byte for each 8 bytes, and the header */
+    size += size / 8 + 1 + 5;
+#endif // GCOV_OPT_COMPRESS_LZ
+
+    gcov_mmap_base = NULL;
+    gcov_mmap_size = size;
+    gcov_mmap_used = 0;
+    gcov_mmap_full = 0;
+    gcov_mmap_fd = open(GCOV_OUTPUT_BINARY_FILENAME, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (gcov_mmap_fd >= 0 && ftruncate(gcov_mmap_fd, (off_t)size) == 0) {
+        void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, gcov_mmap_fd, 0);
+
+        if (base != MAP_FAILED) {
+            gcov_mmap_base = (unsigned char *)base;
+        }
+    }
+    if (!gcov_mmap_base) {
+#ifdef GCOV_OPT_PRINT_STATUS
+        GCOV_PRINT_STR("Unable to map gcov output file!"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+        if (gcov_mmap_fd >= 0) {
+            close(gcov_mmap_fd);
+            gcov_mmap_fd = -1;
+        }
+    }
+}
+
+/* Copy bytes into the mapping, or stop at the first that do not fit,
+ * as a file with a hole in it would not unpack */
+static void gcov_mmap_put(const unsigned char *data, u32 len)
+{
+    if (!gcov_mmap_base || gcov_mmap_full) {
+        return;
+    }
+    if (len > gcov_mmap_size - gcov_mmap_used) {
+        gcov_mmap_full = 1;
+        return;
+    }
+    memcpy(gcov_mmap_base + gcov_mmap_used, data, len);
+    gcov_mmap_used += len;
+}
+
+/* Sync and unmap, and cut the file to the size used
+ * (to nothing if the data did not fit, so the host cannot take it) */
+static void gcov_mmap_finish(void)
+{
+    if (!gcov_mmap_base) {
+        return;
+    }
+    if (gcov_mmap_full) {
+#ifdef GCOV_OPT_PRINT_STATUS
+        GCOV_PRINT_STR("Unable to write gcov output file!"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+        gcov_mmap_used = 0;
+    }
+    (void)msync(gcov_mmap_base, gcov_mmap_size, MS_SYNC);
+    (void)munmap(gcov_mmap_base, gcov_mmap_size);
+    gcov_mmap_base = NULL;
+    if (ftruncate(gcov_mmap_fd, (off_t)gcov_mmap_used) != 0) {
+#ifdef GCOV_OPT_PRINT_STATUS
+        GCOV_PRINT_STR("Unable to size gcov output file!"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+    }
+    close(gcov_mmap_fd);
+    gcov_mmap_fd = -1;
+}
+#endif // GCOV_OPT_OUTPUT_BINARY_MMAP
+
+#ifdef GCOV_OUTPUT_STREAM
+/* ----------------------------------------------------------- */
+#if defined(GCOV_OPT_OUTPUT_DMA) && !defined(GCOV_OPT_COMPRESS_LZ) && !defined(GCOV_OPT_PACK_CONDITIONS)
+/* The DMA buffers take the data of each file unchanged,
+ * so gcov_stream_convert converts it straight into them */
+#define GCOV_DMA_DIRECT
+#endif
+
+/* Pass bytes of binary format (or compressed) to each output that takes them,
+ * other than GCOV_OPT_OUTPUT_DMA, which copy them into buffers of their own */
+static void gcov_stream_copy(const unsigned char *data, u32 len)
+{
+    (void)data; // ignore unused params if only GCOV_OPT_OUTPUT_DMA
+    (void)len;
+#ifdef GCOV_OPT_OUTPUT_FLASH
+    gcov_flash_put(data, len);
+#endif // GCOV_OPT_OUTPUT_FLASH
+#ifdef GCOV_OPT_OUTPUT_MEMORY_RING
+    gcov_ring_put(data, len);
+#endif // GCOV_OPT_OUTPUT_MEMORY_RING
+#ifdef GCOV_OPT_OUTPUT_BINARY_MMAP
+    gcov_mmap_put(data, len);
+#endif // GCOV_OPT_OUTPUT_BINARY_MMAP
+}
+
+/* Pass bytes of binary format (or compressed) to each output that takes them */
+static void gcov_stream_out(const unsigned char *data, u32 len)
+{
+#ifdef GCOV_OPT_OUTPUT_DMA
+    gcov_dma_put(data, len);
+#endif // GCOV_OPT_OUTPUT_DMA
+    gcov_stream_copy(data, len);
+}
+
+#ifdef GCOV_OPT_COMPRESS_LZ
+#if GCOV_LZ_WINDOW_BITS > 12
+#error "GCOV_LZ_WINDOW_BITS can be at most 12"
+#endif
+
+#define GCOV_LZ_WINDOW (1u << GCOV_LZ_WINDOW_BITS)
+#define GCOV_LZ_MIN_COPY 3
+#define GCOV_LZ_MAX_COPY 18
+/* Farthest copy, so the lookahead has not yet overwritten any of it */
+#define GCOV_LZ_MAX_OFFSET (GCOV_LZ_WINDOW - GCOV_LZ_MAX_COPY)
+#define GCOV_LZ_AT(pos) gcov_lz_window[(pos) & (GCOV_LZ_WINDOW - 1)]
+
+static unsigned char gcov_lz_window[GCOV_LZ_WINDOW];  // history, then lookahead
+static u32 gcov_lz_head[1u << GCOV_LZ_HASH_BITS];    // newest position + 1 by hash, 0 if none
+static u32 gcov_lz_pos = 0;                 // position of next byte to compress
+static u32 gcov_lz_end = 0;                 // position after last byte received
+static unsigned char gcov_lz_group[1 + 8 * 2]; // flag byte, then up to 8 items
+static u32 gcov_lz_group_len = 1;
+static u32 gcov_lz_items = 0;
+static u32 gcov_lz_out = 0;                 // compressed bytes output
+
+/* Hash of the 3 bytes at pos */
+static u32 gcov_lz_hash(u32 pos)
+{
+    u32 key = ((u32)GCOV_LZ_AT(pos) << 16) | ((u32)GCOV_LZ_AT(pos + 1) << 8) | GCOV_LZ_AT(pos + 2);
+
+    return (key * 2654435761u) >> (32 - GCOV_LZ_HASH_BITS);
+}
+
+/* Output the flag byte and items gathered so far */
+static void gcov_lz_flush(void)
+{
+    if (gcov_lz_items) {
+        gcov_stream_out(gcov_lz_group, gcov_lz_group_len);
+        gcov_lz_out += gcov_lz_group_len;
+    }
+    gcov_lz_group[0] = 0;
+    gcov_lz_group_len = 1;
+    gcov_lz_items = 0;
+}
+
+/* Compress one item at gcov_lz_pos: a byte as itself, or a copy from back in the window */
+static void gcov_lz_item(void)
+{
+    u32 avail = gcov_lz_end - gcov_lz_pos;
+    u32 offset = 0;
+    u32 len = 0;
+
+    if (avail >= GCOV_LZ_MIN_COPY) {
+        u32 hash = gcov_lz_hash(gcov_lz_pos);
+        u32 cand = gcov_lz_head[hash];
+
+        gcov_lz_head[hash] = gcov_lz_pos + 1;
+        if (cand && gcov_lz_pos - (cand - 1) <= GCOV_LZ_MAX_OFFSET) {
+            u32 max = (avail < GCOV_LZ_MAX_COPY) ? avail : GCOV_LZ_MAX_COPY;
+
+            offset = gcov_lz_pos - (cand - 1);
+            while (len < max && GCOV_LZ_AT(gcov_lz_pos - offset + len) == GCOV_LZ_AT(gcov_lz_pos + len)) {
+                len++;
+            }
+        }
+    }
+
+    if (len >= GCOV_LZ_MIN_COPY) {
+        /* 12 bits of offset, 4 bits of length */
+        gcov_lz_group[0] |= (unsigned char)(1u << gcov_lz_items);
+        gcov_lz_group[gcov_lz_group_len++] = (unsigned char)(offset >> 4);
+        gcov_lz_group[gcov_lz_group_len++] = (unsigned char)(((offset & 15) << 4) | (len - GCOV_LZ_MIN_COPY));
+        /* remember the positions copied over too */
+        for (u32 i = 1; i < len; i++) {
+            if (gcov_lz_pos + i + GCOV_LZ_MIN_COPY <= gcov_lz_end) {
+                gcov_lz_head[gcov_lz_hash(gcov_lz_pos + i)] = gcov_lz_pos + i + 1;
+            }
+        }
+        gcov_lz_pos += len;
+    } else {
+        gcov_lz_group[gcov_lz_group_len++] = GCOV_LZ_AT(gcov_lz_pos);
+        gcov_lz_pos++;
+    }
+
+    if (++gcov_lz_items == 8) {
+        gcov_lz_flush();
+    }
+}
+
+/* Start a compressed dump with its header */
+static void gcov_lz_begin(void)
+{
+    static const unsigned char header[] = { 'G', 'c', 'v', 'Z', GCOV_LZ_WINDOW_BITS };
+
+    for (u32 i = 0; i < (1u << GCOV_LZ_HASH_BITS); i++) {
+        gcov_lz_head[i] = 0;
+    }
+    gcov_lz_pos = 0;
+    gcov_lz_end = 0;
+    gcov_lz_group[0] = 0;
+    gcov_lz_group_len = 1;
+    gcov_lz_items = 0;
+    gcov_stream_out(header, sizeof(header));
+    gcov_lz_out = sizeof(header);
+}
+
+/* Take bytes into the lookahead, compressing whenever it is full */
+static void gcov_lz_put(const unsigned char *data, u32 len)
+{
+    while (len--) {
+        GCOV_LZ_AT(gcov_lz_end) = *data++;
+        gcov_lz_end++;
+        if (gcov_lz_end - gcov_lz_pos >= GCOV_LZ_MAX_COPY) {
+            gcov_lz_item();
+        }
+    }
+}
+
+/* Compress the rest of the lookahead, and output it */
+static void gcov_lz_finish(void)
+{
+    while (gcov_lz_pos < gcov_lz_end) {
+        gcov_lz_item();
+    }
+    gcov_lz_flush();
+#ifdef GCOV_OPT_PRINT_STATUS
+    GCOV_PRINT_STR("Gcov compressed ");
+    GCOV_PRINT_NUM(gcov_lz_end);
+    GCOV_PRINT_STR(" to ");
+    GCOV_PRINT_NUM(gcov_lz_out);
+    GCOV_PRINT_STR(" bytes"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+}
+#endif // GCOV_OPT_COMPRESS_LZ
+
+/* Pass bytes of binary format on, through the compression if selected */
+static void gcov_stream_put(const unsigned char *data, u32 len)
+{
+#ifdef GCOV_OPT_COMPRESS_LZ
+    gcov_lz_put(data, len);
+#else
+    gcov_stream_out(data, len);
+#endif // GCOV_OPT_COMPRESS_LZ
+}
+
+#ifdef GCOV_OPT_PACK_CONDITIONS
+/* Tag of a packed condition counter record, not a tag gcc uses */
+#define GCOV_TAG_PACKED_CONDITIONS (GCOV_TAG_FOR_COUNTER(GCOV_COUNTER_CONDITIONS) + 1)
+/* Marks the byte count of a packed file */
+#define GCOV_PACKED_FILE 0x80000000u
+
+static u32 gcov_pack_header = 0;            // header words still to come
+static u32 gcov_pack_words = 0;             // record payload words still to come
+static int gcov_pack_conditions = 0;        // payload is condition counters
+static int gcov_pack_have_tag = 0;          // record tag taken, length next
+static gcov_unsigned_t gcov_pack_tag;
+static gcov_unsigned_t gcov_pack_low;       // low word of a condition counter
+static union {
+    gcov_unsigned_t word;
+    unsigned char bytes[4];
+} gcov_pack_in;                             // word being gathered
+static u32 gcov_pack_fill = 0;              // bytes in gcov_pack_in
+
+/* Start packing the data of a file */
+static void gcov_pack_begin(void)
+{
+    gcov_pack_header = 4;
+    gcov_pack_words = 0;
+    gcov_pack_have_tag = 0;
+    gcov_pack_fill = 0;
+}
+
+/* Output a word of the data, in target byte order as it came */
+static void gcov_pack_put_word(gcov_unsigned_t word)
+{
+    union {
+        gcov_unsigned_t word;
+        unsigned char bytes[4];
+    } out;
+
+    out.word = word;
+    gcov_stream_put(out.bytes, 4);
+}
+
+/* Take one whole word of the data */
+static void gcov_pack_word(gcov_unsigned_t word)
+{
+    unsigned char leb[10];
+    unsigned long long value;
+    u32 n = 0;
+
+    if (gcov_pack_header) {
+        gcov_pack_header--;
+        gcov_pack_put_word(word);
+    } else if (gcov_pack_words && !gcov_pack_conditions) {
+        gcov_pack_words--;
+        gcov_pack_put_word(word);
+    } else if (gcov_pack_words) {
+        /* low word first, then the counter as LEB128 */
+        if (gcov_pack_words-- % 2 == 0) {
+            gcov_pack_low = word;
+            return;
+        }
+        value = ((unsigned long long)word << 32) | gcov_pack_low;
+        do {
+            leb[n++] = (unsigned char)((value & 0x7f) | ((value > 0x7f) ? 0x80 : 0));
+            value >>= 7;
+        } while (value);
+        gcov_stream_put(leb, n);
+    } else if (!gcov_pack_have_tag) {
+        gcov_pack_tag = word;
+        gcov_pack_have_tag = 1;
+    } else {
+        gcov_pack_have_tag = 0;
+        gcov_pack_conditions = (gcov_pack_tag == GCOV_TAG_FOR_COUNTER(GCOV_COUNTER_CONDITIONS));
+        gcov_pack_words = word / 4;
+        gcov_pack_put_word(gcov_pack_conditions ? GCOV_TAG_PACKED_CONDITIONS : gcov_pack_tag);
+        gcov_pack_put_word(word);
+    }
+}
+
+/* Take bytes of the data, packing the condition counter records */
+static void gcov_pack_put(const unsigned char *data, u32 len)
+{
+    while (len) {
+        if (!gcov_pack_fill && !gcov_pack_header && gcov_pack_words && !gcov_pack_conditions) {
+            /* the bulk of the data, such as arc counters, passes as it is */
+            u32 run = (len / 4 < gcov_pack_words) ? len / 4 : gcov_pack_words;
+
+            if (run) {
+                gcov_stream_put(data, run * 4);
+                gcov_pack_words -= run;
+                data += run * 4;
+                len -= run * 4;
+                continue;
+            }
+        }
+        gcov_pack_in.bytes[gcov_pack_fill++] = *data++;
+        len--;
+        if (gcov_pack_fill == 4) {
+            gcov_pack_fill = 0;
+            gcov_pack_word(gcov_pack_in.word);
+        }
+    }
+}
+#endif // GCOV_OPT_PACK_CONDITIONS
+
+/* Pass bytes of the data of a file on, through the packing if selected */
+static void gcov_stream_data(const unsigned char *data, u32 len)
+{
+#ifdef GCOV_OPT_PACK_CONDITIONS
+    gcov_pack_put(data, len);
+#else
+    gcov_stream_put(data, len);
+#endif // GCOV_OPT_PACK_CONDITIONS
+}
+
+/* Output filename and data byte count, as for GCOV_OPT_OUTPUT_BINARY_FILE */
+static void gcov_stream_header(const char *filename, u32 bytes)
+{
+    unsigned char count[4];
+    u32 len = 0;
+
+    /* the filename with trailing null char */
+    while (filename && filename[len]) {
+        len++;
+    }
+    if (len) {
+        gcov_stream_put((const unsigned char *)filename, len);
+    }
+    count[0] = '\0';
+    gcov_stream_put(count, 1);
+
+#ifdef GCOV_OPT_PACK_CONDITIONS
+    /* the unpacked byte count, marked as packed */
+    gcov_pack_begin();
+    bytes |= GCOV_PACKED_FILE;
+#endif // GCOV_OPT_PACK_CONDITIONS
+
+    /* we don't know endianness, so use division for consistent MSB first */
+    count[0] = (unsigned char)(bytes / 16777216);
+    count[1] = (unsigned char)(bytes / 65536);
+    count[2] = (unsigned char)(bytes / 256);
+    count[3] = (unsigned char)(bytes);
+    gcov_stream_put(count, 4);
+}
+
+#ifndef GCOV_OUTPUT_WHOLE_FILE
+/* Convert the data of one file in pieces, instead of into a whole-file buffer
+ * (with GCOV_OPT_OUTPUT_DMA, straight into its buffers) */
+static void gcov_stream_convert(struct gcov_info *info, int reset)
+{
+    struct gcov_convert_state state;
+    gcov_unsigned_t stage[16];
+    u32 got;
+
+    gcov_convert_start(&state, reset);
+#ifdef GCOV_DMA_DIRECT
+    do {
+        if (gcov_dma_used % 4 == 0) {
+            unsigned char *at = (unsigned char *)gcov_dma_buf[gcov_dma_fill] + gcov_dma_used;
+
+            got = gcov_convert_to_gcda_part((gcov_unsigned_t *)at,
+                                            GCOV_DMA_CHUNK_BYTES - gcov_dma_used, info, &state);
+            /* the other outputs copy from the DMA buffer, before it is queued */
+            gcov_stream_copy(at, got);
+            gcov_dma_used += got;
+            if (gcov_dma_used == GCOV_DMA_CHUNK_BYTES) {
+                gcov_dma_submit();
+            }
+        } else {
+            /* the filename left the buffer unaligned, so convert then copy */
+            got = gcov_convert_to_gcda_part(stage, sizeof(stage), info, &state);
+            gcov_stream_data((unsigned char *)stage, got);
+        }
+    } while (got);
+#else
+    while ((got = gcov_convert_to_gcda_part(stage, sizeof(stage), info, &state)) > 0) {
+        gcov_stream_data((unsigned char *)stage, got);
+    }
+#endif // GCOV_DMA_DIRECT
+}
+#endif // not GCOV_OUTPUT_WHOLE_FILE
+
+/* Output the end marker, as for GCOV_OPT_OUTPUT_BINARY_FILE */
+static void gcov_stream_end(void)
+{
+    static const unsigned char end[] = "Gcov End"; // with trailing null char
+
+    gcov_stream_put(end, sizeof(end));
+#ifdef GCOV_OPT_COMPRESS_LZ
+    gcov_lz_finish();
+#endif // GCOV_OPT_COMPRESS_LZ
+}
+#endif // GCOV_OUTPUT_STREAM
+
+/* ----------------------------------------------------------- */
+/*
+ * gcov_dump walks the gcov data tree and outputs each file
+ * by all the selected GCOV_OPT_OUTPUT_* methods.
+ * If reset is nonzero, each counter array is zeroed as it is converted
+ * (see __gcov_dump_and_reset below).
+ * If budgeted is nonzero, only the files selected by
+ * gcov_budget_select are output (see __gcov_exit_budget below).
+ */
+static void gcov_dump(int reset, int budgeted)
 {
     GcovInfo *listptr = gcov_headGcov;
 
+#ifndef GCOV_OPT_BUDGET_DUMP
+    (void)budgeted; // ignore unused param
+#endif
+
+#if defined(GCOV_OPT_HASH_DEDUP) || defined(GCOV_OPT_OUTPUT_SERIAL_CHUNKED)
+    u32 index = 0;
+#endif
+
+#ifdef GCOV_OPT_HASH_DEDUP
+    gcov_hash_t hash;
+#endif // GCOV_OPT_HASH_DEDUP
+
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+    u32 entries = 0;
+    int stalled = 0;
+
+    /* Start over if the last transfer was completely acknowledged */
+    for (listptr = gcov_headGcov; listptr; listptr = listptr->next) {
+        entries++;
+    }
+    listptr = gcov_headGcov;
+    gcov_ack_setup();
+    if (gcov_ack.entry >= entries) {
+        gcov_ack.entry = 0;
+        gcov_ack.offset = 0;
+    }
+    GCOV_PRINT_STR("Gcov Begin ");
+    GCOV_PRINT_NUM(entries);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(gcov_ack.entry);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(gcov_ack.offset);
+    GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
 #if defined(GCOV_OPT_OUTPUT_BINARY_FILE) || defined(GCOV_OPT_OUTPUT_BINARY_MEMORY)
     char const *p;
 #endif
@@ -234,9 +1560,25 @@ void __gcov_exit(void)
     gcov_output_index = 0;
 #endif // GCOV_OPT_OUTPUT_BINARY_MEMORY
 
-#ifdef GCOV_OPT_PRINT_STATUS
-    GCOV_PRINT_STR("gcov_exit"); GCOV_PRINT_STR("\n");
-#endif // GCOV_OPT_PRINT_STATUS
+#ifdef GCOV_OPT_OUTPUT_DMA
+    gcov_dma_used = 0;
+#endif // GCOV_OPT_OUTPUT_DMA
+
+#ifdef GCOV_OPT_OUTPUT_FLASH
+    gcov_flash_begin();
+#endif // GCOV_OPT_OUTPUT_FLASH
+
+#ifdef GCOV_OPT_OUTPUT_MEMORY_RING
+    gcov_ring_begin();
+#endif // GCOV_OPT_OUTPUT_MEMORY_RING
+
+#ifdef GCOV_OPT_OUTPUT_BINARY_MMAP
+    gcov_mmap_begin();
+#endif // GCOV_OPT_OUTPUT_BINARY_MMAP
+
+#if defined(GCOV_OPT_COMPRESS_LZ) && defined(GCOV_OUTPUT_STREAM)
+    gcov_lz_begin();
+#endif // GCOV_OPT_COMPRESS_LZ and GCOV_OUTPUT_STREAM
 
 #ifdef GCOV_OPT_OUTPUT_BINARY_FILE
     file = GCOV_OPEN_FILE(GCOV_OUTPUT_BINARY_FILENAME);
@@ -253,12 +1595,51 @@ void __gcov_exit(void)
 #endif // GCOV_OPT_OUTPUT_BINARY_FILE
 
     while (listptr) {
+#ifdef GCOV_OUTPUT_WHOLE_FILE
         gcov_unsigned_t *buffer = NULL; // Need buffer to be 32-bit-aligned for type-safe internal usage
+#endif // GCOV_OUTPUT_WHOLE_FILE
         u32 bytesNeeded;
 
+#ifdef GCOV_OPT_BUDGET_DUMP
+        if (budgeted && !listptr->selected) {
+            listptr = listptr->next;
+#if defined(GCOV_OPT_HASH_DEDUP) || defined(GCOV_OPT_OUTPUT_SERIAL_CHUNKED)
+            index++;
+#endif
+            continue;
+        }
+#endif // GCOV_OPT_BUDGET_DUMP
+
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+        /* Skip files the host has already acknowledged */
+        if (index < gcov_ack.entry) {
+            listptr = listptr->next;
+            index++;
+            continue;
+        }
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+#ifdef GCOV_OPT_HASH_DEDUP
+        /* Skip this file if the host already has these counters.
+         * Not when resetting, as counts made between the hash and
+         * the clearing would be lost; the file is then read and
+         * zeroed as one by the conversion below instead. */
+        if (!reset) {
+            hash = gcov_hash_counters(listptr->info);
+            if (gcov_hash_known(hash)) {
+                gcov_print_hash("Gcov Unchanged ", index, hash, listptr->info);
+                listptr = listptr->next;
+                index++;
+                continue;
+            }
+            gcov_print_hash("Gcov Hash ", index, hash, listptr->info);
+        }
+#endif // GCOV_OPT_HASH_DEDUP
+
         /* Do pretend conversion to see how many bytes are needed */
         bytesNeeded = gcov_convert_to_gcda(NULL, listptr->info);
 
+#ifdef GCOV_OUTPUT_WHOLE_FILE
 #ifdef GCOV_OPT_USE_MALLOC
         buffer = malloc(bytesNeeded);
 #else
@@ -281,7 +1662,17 @@ void __gcov_exit(void)
         }
 
         /* Do the real conversion into buffer */
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+        if (reset) {
+            gcov_convert_to_gcda_and_reset(buffer, listptr->info);
+        } else {
+            gcov_convert_to_gcda(buffer, listptr->info);
+        }
+#else
+        (void)reset; // ignore unused param
         gcov_convert_to_gcda(buffer, listptr->info);
+#endif // GCOV_OPT_PROVIDE_DUMP_AND_RESET
+#endif // GCOV_OUTPUT_WHOLE_FILE
 
 #if defined(GCOV_OPT_PRINT_STATUS) || defined(GCOV_OPT_OUTPUT_SERIAL_HEXDUMP)
         GCOV_PRINT_STR("Emitting ");
@@ -308,7 +1699,7 @@ void __gcov_exit(void)
         (void)GCOV_WRITE_BYTE(file, bf);
         bf = (unsigned char)(bytesNeeded / 65536);
         (void)GCOV_WRITE_BYTE(file, bf);
-        bf = (unsigned char)(bytesNeeded / 255);
+        bf = (unsigned char)(bytesNeeded / 256);
         (void)GCOV_WRITE_BYTE(file, bf);
         bf = (unsigned char)(bytesNeeded);
         (void)GCOV_WRITE_BYTE(file, bf);
@@ -324,21 +1715,21 @@ void __gcov_exit(void)
         /* copy the filename */
         p = gcov_info_filename(listptr->info);
         while (p && (*p)) {
-            gcov_output_buffer[gcov_output_index++] = (*p++);
+            GCOV_OUTPUT_MEMORY_PUT(*p++);
         }
         /* add trailing null char */
-        gcov_output_buffer[gcov_output_index++] = '\0';
+        GCOV_OUTPUT_MEMORY_PUT('\0');
 
         /* store the data byte count */
         /* we don't know endianness, so use division for consistent MSB first */
-        gcov_output_buffer[gcov_output_index++] = (unsigned char)(bytesNeeded / 16777216);
-        gcov_output_buffer[gcov_output_index++] = (unsigned char)(bytesNeeded / 65536);
-        gcov_output_buffer[gcov_output_index++] = (unsigned char)(bytesNeeded / 255);
-        gcov_output_buffer[gcov_output_index++] = (unsigned char)(bytesNeeded);
+        GCOV_OUTPUT_MEMORY_PUT((unsigned char)(bytesNeeded / 16777216));
+        GCOV_OUTPUT_MEMORY_PUT((unsigned char)(bytesNeeded / 65536));
+        GCOV_OUTPUT_MEMORY_PUT((unsigned char)(bytesNeeded / 256));
+        GCOV_OUTPUT_MEMORY_PUT((unsigned char)(bytesNeeded));
 
         /* copy the data */
         for (u32 i=0; i<bytesNeeded; i++) {
-            gcov_output_buffer[gcov_output_index++] = (unsigned char)(((unsigned char *)buffer)[i]);
+            GCOV_OUTPUT_MEMORY_PUT((unsigned char)(((unsigned char *)buffer)[i]));
         }
 #endif // GCOV_OPT_OUTPUT_BINARY_MEMORY
 
@@ -356,16 +1747,58 @@ void __gcov_exit(void)
         GCOV_PRINT_STR("\n");
 #endif // GCOV_OPT_OUTPUT_SERIAL_HEXDUMP
 
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+        if (!gcov_send_chunks(index, (unsigned char *)buffer, bytesNeeded,
+                              gcov_info_filename(listptr->info))) {
+            stalled = 1;
+        }
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+#ifdef GCOV_OPT_OUTPUT_GCDA_FILES
+        gcov_gcda_write(gcov_info_filename(listptr->info), (unsigned char *)buffer, bytesNeeded);
+#endif // GCOV_OPT_OUTPUT_GCDA_FILES
+
+#ifdef GCOV_OUTPUT_STREAM
+        gcov_stream_header(gcov_info_filename(listptr->info), bytesNeeded);
+#ifdef GCOV_OUTPUT_WHOLE_FILE
+        gcov_stream_data((unsigned char *)buffer, bytesNeeded);
+#else
+        gcov_stream_convert(listptr->info, reset);
+#endif // GCOV_OUTPUT_WHOLE_FILE
+#endif // GCOV_OUTPUT_STREAM
+
 /* Other output methods might be imagined,
  * if you have flash that can be written directly,
  * or the luxury of a filesystem, etc.
  */
 
-#ifdef GCOV_OPT_USE_MALLOC
+#if defined(GCOV_OPT_USE_MALLOC) && defined(GCOV_OUTPUT_WHOLE_FILE)
         free(buffer);
-#endif // GCOV_OPT_USE_MALLOC
+#endif
+
+#ifdef GCOV_OPT_BUDGET_DUMP
+        /* A stalled transfer is not delivered, so leave it to be sent again */
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+        if (budgeted && !stalled) {
+#else
+        if (budgeted) {
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+            listptr->sentHash = listptr->hash;
+            listptr->sent = 1;
+        }
+#endif // GCOV_OPT_BUDGET_DUMP
+
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+        if (stalled) {
+            /* leave the rest for the next __gcov_exit */
+            break;
+        }
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
 
         listptr = listptr->next;
+#if defined(GCOV_OPT_HASH_DEDUP) || defined(GCOV_OPT_OUTPUT_SERIAL_CHUNKED)
+        index++;
+#endif
     } /* end while listptr */
 
     /* Add end marker to output */
@@ -393,22 +1826,268 @@ void __gcov_exit(void)
 #endif // GCOV_OPT_OUTPUT_BINARY_FILE
 
 #ifdef GCOV_OPT_OUTPUT_BINARY_MEMORY
-    gcov_output_buffer[gcov_output_index++] = 'G';
-    gcov_output_buffer[gcov_output_index++] = 'c';
-    gcov_output_buffer[gcov_output_index++] = 'o';
-    gcov_output_buffer[gcov_output_index++] = 'v';
-    gcov_output_buffer[gcov_output_index++] = ' ';
-    gcov_output_buffer[gcov_output_index++] = 'E';
-    gcov_output_buffer[gcov_output_index++] = 'n';
-    gcov_output_buffer[gcov_output_index++] = 'd';
-    gcov_output_buffer[gcov_output_index++] = '\0';
+    GCOV_OUTPUT_MEMORY_PUT('G');
+    GCOV_OUTPUT_MEMORY_PUT('c');
+    GCOV_OUTPUT_MEMORY_PUT('o');
+    GCOV_OUTPUT_MEMORY_PUT('v');
+    GCOV_OUTPUT_MEMORY_PUT(' ');
+    GCOV_OUTPUT_MEMORY_PUT('E');
+    GCOV_OUTPUT_MEMORY_PUT('n');
+    GCOV_OUTPUT_MEMORY_PUT('d');
+    GCOV_OUTPUT_MEMORY_PUT('\0');
 #endif // GCOV_OPT_OUTPUT_BINARY_MEMORY
 
-#if defined(GCOV_OPT_PRINT_STATUS) || defined(GCOV_OPT_OUTPUT_SERIAL_HEXDUMP)
+#ifdef GCOV_OUTPUT_STREAM
+    gcov_stream_end();
+#endif // GCOV_OUTPUT_STREAM
+
+#ifdef GCOV_OPT_OUTPUT_DMA
+    gcov_dma_finish();
+#endif // GCOV_OPT_OUTPUT_DMA
+
+#ifdef GCOV_OPT_OUTPUT_FLASH
+    gcov_flash_finish();
+#endif // GCOV_OPT_OUTPUT_FLASH
+
+#ifdef GCOV_OPT_OUTPUT_MEMORY_RING
+    gcov_ring_finish();
+#endif // GCOV_OPT_OUTPUT_MEMORY_RING
+
+#ifdef GCOV_OPT_OUTPUT_BINARY_MMAP
+    gcov_mmap_finish();
+#endif // GCOV_OPT_OUTPUT_BINARY_MMAP
+
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+    if (stalled) {
+        GCOV_PRINT_STR("Gcov Stalled");
+        GCOV_PRINT_STR("\n");
+        return;
+    }
     GCOV_PRINT_STR("Gcov End");
     GCOV_PRINT_STR("\n");
+#elif defined(GCOV_OPT_PRINT_STATUS) || defined(GCOV_OPT_OUTPUT_SERIAL_HEXDUMP)
+    GCOV_PRINT_STR("Gcov End");
+    GCOV_PRINT_STR("\n");
+#endif
+}
+
+/* ----------------------------------------------------------- */
+/*
+ * __gcov_exit needs to be called in your code at the point
+ * where you want to generate coverage data for extraction.
+ */
+void __gcov_exit(void)
+{
+#ifdef GCOV_OPT_PRINT_STATUS
+    GCOV_PRINT_STR("gcov_exit"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+
+    gcov_dump(0, 0);
+}
+
+/* ----------------------------------------------------------- */
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+/*
+ * __gcov_dump_and_reset is optional to call instead of
+ * __gcov_exit followed by __gcov_clear, such as for
+ * coverage of each of a series of time intervals.
+ * Each counter array is read and zeroed in one step as it is output,
+ * so increments made while the dump is in progress are kept
+ * for the next interval instead of being lost,
+ * and the gcov data tree is walked only once.
+ */
+void __gcov_dump_and_reset(void)
+{
+#ifdef GCOV_OPT_PRINT_STATUS
+    GCOV_PRINT_STR("gcov_dump_and_reset"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+
+    gcov_dump(1, 0);
+}
+#endif // GCOV_OPT_PROVIDE_DUMP_AND_RESET
+
+/* ----------------------------------------------------------- */
+#ifdef GCOV_OPT_BUDGET_DUMP
+/*
+ * gcov_budget_better compares the value of the data of two files,
+ * by priority first, then by density of nonzero counters.
+ */
+static int gcov_budget_better(GcovInfo *a, GcovInfo *b)
+{
+    if (a->priority != b->priority) {
+        return (a->priority > b->priority);
+    }
+
+    return (a->score > b->score);
+}
+
+/*
+ * gcov_budget_select ranks the changed files and marks the
+ * best ones that fit in the budget.
+ * Returns the count of changed files left out.
+ */
+static u32 gcov_budget_select(u32 budget_bytes)
+{
+    GcovInfo *listptr;
+    u32 remaining = budget_bytes;
+    u32 deferred = 0;
+
+    /* Score each file, only changed files are candidates */
+    for (listptr = gcov_headGcov; listptr; listptr = listptr->next) {
+        u32 bytes = gcov_convert_to_gcda(NULL, listptr->info);
+
+        listptr->hash = gcov_hash_counters(listptr->info);
+        listptr->selected = 0;
+        if (listptr->sent && (listptr->hash == listptr->sentHash)) {
+            listptr->score = 0;
+            continue;
+        }
+        listptr->score = (u32)(((unsigned long long)gcov_count_nonzero(listptr->info) * 1024) / bytes) + 1;
+    }
+
+    /* Take the best remaining candidate until none are left,
+     * skipping any that no longer fit (a smaller one still might) */
+    for (;;) {
+        GcovInfo *best = NULL;
+        u32 cost;
+
+        for (listptr = gcov_headGcov; listptr; listptr = listptr->next) {
+            if (listptr->score && (!best || gcov_budget_better(listptr, best))) {
+                best = listptr;
+            }
+        }
+        if (!best) {
+            break;
+        }
+
+        cost = GCOV_BUDGET_WIRE_BYTES(gcov_convert_to_gcda(NULL, best->info));
+        if (cost <= remaining) {
+            best->selected = 1;
+            remaining -= cost;
+        } else {
+            deferred++;
+        }
+        best->score = 0;
+    }
+
+    return deferred;
+}
+
+/*
+ * __gcov_exit_budget can be called instead of __gcov_exit
+ * when only budget_bytes can be sent (see GCOV_BUDGET_WIRE_BYTES),
+ * to output the most valuable changed files first.
+ * Call again in the next window to continue with the rest.
+ */
+void __gcov_exit_budget(gcov_unsigned_t budget_bytes)
+{
+    u32 deferred;
+
+#ifdef GCOV_OPT_PRINT_STATUS
+    GCOV_PRINT_STR("gcov_exit_budget"); GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+
+    deferred = gcov_budget_select(budget_bytes);
+
+#if defined(GCOV_OPT_PRINT_STATUS) || defined(GCOV_OPT_OUTPUT_SERIAL_HEXDUMP)
+    GCOV_PRINT_STR("Gcov Deferred ");
+    GCOV_PRINT_NUM(deferred);
+    GCOV_PRINT_STR("\n");
+#else
+    (void)deferred; // ignore unused value
 #endif
+
+    gcov_dump(0, 1);
+}
+
+/*
+ * __gcov_set_priority sets the priority of the files whose names
+ * end with the given string (such as "/attitude_control.gcda"),
+ * higher priority files are output first by __gcov_exit_budget.
+ * Call after the constructors have run (after __gcov_init).
+ */
+void __gcov_set_priority(const char *filename, gcov_unsigned_t priority)
+{
+    GcovInfo *listptr;
+    u32 len = 0;
+
+    while (filename[len]) {
+        len++;
+    }
+
+    for (listptr = gcov_headGcov; listptr; listptr = listptr->next) {
+        const char *name = gcov_info_filename(listptr->info);
+        u32 name_len = 0;
+
+        while (name[name_len]) {
+            name_len++;
+        }
+        if (name_len < len) {
+            continue;
+        }
+        for (u32 i=0; ; i++) {
+            if (i == len) {
+                listptr->priority = priority;
+                break;
+            }
+            if (name[name_len - len + i] != filename[i]) {
+                break;
+            }
+        }
+    }
+}
+#endif // GCOV_OPT_BUDGET_DUMP
+
+/* ----------------------------------------------------------- */
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+/*
+ * __gcov_transfer_ack is called by your command code
+ * when the host acknowledges receiving everything before
+ * the given file entry and byte offset.
+ * The host may also move the position back, to have data resent.
+ */
+void __gcov_transfer_ack(gcov_unsigned_t entry, gcov_unsigned_t offset)
+{
+    gcov_ack_setup();
+    gcov_ack.entry = entry;
+    gcov_ack.offset = offset;
+}
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+/* ----------------------------------------------------------- */
+#ifdef GCOV_OPT_HASH_DEDUP
+/*
+ * __gcov_emit_hashes lists the counter hash of every file,
+ * without any data, so that the host can reply with the hashes
+ * it already has (see __gcov_add_known_hash) before __gcov_exit.
+ */
+void __gcov_emit_hashes(void)
+{
+    GcovInfo *listptr = gcov_headGcov;
+    u32 index = 0;
+
+    while (listptr) {
+        gcov_print_hash("Gcov Hash ", index, gcov_hash_counters(listptr->info), listptr->info);
+        index++;
+        listptr = listptr->next;
+    }
+
+    GCOV_PRINT_STR("Gcov Hash End");
+    GCOV_PRINT_STR("\n");
+}
+
+/*
+ * __gcov_add_known_hash can be called by your command code,
+ * once per hash that the host reports it already has.
+ * Set gcov_known_hash_count to zero to forget them all.
+ */
+void __gcov_add_known_hash(gcov_hash_t hash)
+{
+    if (gcov_known_hash_count < GCOV_KNOWN_HASHES_MAX) {
+        gcov_known_hashes[gcov_known_hash_count++] = hash;
+    }
 }
+#endif // GCOV_OPT_HASH_DEDUP
 
 /* ----------------------------------------------------------- */
 #ifdef GCOV_OPT_PROVIDE_CLEAR_COUNTERS
@@ -435,6 +2114,290 @@ void __gcov_clear(void)
 }
 #endif // GCOV_OPT_PROVIDE_CLEAR_COUNTERS
 
+#ifdef GCOV_OPT_PROVIDE_INFO_LIST
+/*
+ * __gcov_info_next is optional to call if your own code converts
+ * the gcov_info itself (such as with gcov_serializer.hpp).
+ * Returns the first registered gcov_info if info is NULL,
+ * else the one after info, or NULL after the last.
+ */
+struct gcov_info *__gcov_info_next(const struct gcov_info *info)
+{
+    GcovInfo *listptr = gcov_headGcov;
+
+    if (info) {
+        while (listptr && listptr->info != info) {
+            listptr = listptr->next;
+        }
+        if (listptr) {
+            listptr = listptr->next;
+        }
+    }
+    return listptr ? listptr->info : NULL;
+}
+#endif // GCOV_OPT_PROVIDE_INFO_LIST
+
+#ifdef GCOV_OPT_PROVIDE_FOREACH
+/*
+ * __gcov_foreach is optional to call if your own code wants to
+ * look at the counters in place, such as for a coverage summary.
+ * fn_cb is called for each function of each file, and ctr_cb for each
+ * counter array of each function (either may be NULL), with ctx.
+ * Returns the first nonzero callback return (which stops the walk), or 0.
+ */
+int __gcov_foreach(gcov_fn_cb_t fn_cb, gcov_ctr_cb_t ctr_cb, void *ctx)
+{
+    GcovInfo *listptr = gcov_headGcov;
+    int stop;
+
+    while (listptr) {
+
+        stop = gcov_foreach(listptr->info, fn_cb, ctr_cb, ctx);
+        if (stop) {
+            return stop;
+        }
+
+        listptr = listptr->next;
+    }
+    return 0;
+}
+#endif // GCOV_OPT_PROVIDE_FOREACH
+
+#ifdef GCOV_OPT_PROVIDE_EDGE_MAP
+/*
+ * __gcov_edge_map is optional to call from a fuzzing harness after
+ * each iteration, to fold the arc counters into the fuzzer's edge map
+ * (map_bytes a power of two, such as 65536), and with reset nonzero,
+ * zero them for the next iteration (instead of __gcov_clear).
+ * Bytes of the map are only ORed into, clear it before each iteration.
+ * Returns the count of nonzero arc counters, 0 if map_bytes
+ * is not a power of two.
+ */
+gcov_unsigned_t __gcov_edge_map(unsigned char *map, gcov_unsigned_t map_bytes, int reset)
+{
+    GcovInfo *listptr = gcov_headGcov;
+    u32 file_index = 0;
+    u32 hits = 0;
+
+    if (!map_bytes || (map_bytes & (map_bytes - 1))) {
+        return 0;
+    }
+
+    while (listptr) {
+
+        hits += gcov_edge_map(listptr->info, file_index++, map, map_bytes - 1, reset);
+
+        listptr = listptr->next;
+    }
+    return hits;
+}
+#endif // GCOV_OPT_PROVIDE_EDGE_MAP
+
+#ifdef GCOV_OPT_PROVIDE_FUNCTION_SUMMARY
+/* ----------------------------------------------------------- */
+/* Room for the packet header: flag byte and two numbers */
+#define GCOV_SUMMARY_HEADER_BYTES 11
+/* Room for the file header of the never-entered list: two numbers */
+#define GCOV_SUMMARY_FILE_BYTES 10
+
+/* State of a function summary walk */
+typedef struct {
+    gcov_fn_summary_t *summary;
+    u32 functions;                  // of the current file
+    u32 entered;                    // of the current file
+    u32 missed;                     // of the current file, listed
+    u32 overflow;                   // nonzero if the current file's list did not fit
+    unsigned char *packet;          // or NULL
+    u32 packet_bytes;
+    u32 pos;                        // packet bytes used
+} GcovSummary;
+
+/* Store an unsigned LEB128 number, returning its byte count, or 0 if no room */
+static u32 gcov_put_leb128(unsigned char *p, u32 room, u32 value)
+{
+    u32 n = 0;
+
+    do {
+        if (n == room) {
+            return 0;
+        }
+        p[n++] = (unsigned char)((value & 0x7f) | ((value > 0x7f) ? 0x80 : 0));
+        value >>= 7;
+    } while (value);
+    return n;
+}
+
+/* Move len bytes at from down to to (to < from) */
+static void gcov_move_down(unsigned char *to, const unsigned char *from, u32 len)
+{
+    for (u32 i = 0; i < len; i++) {
+        to[i] = from[i];
+    }
+}
+
+/* Whether str contains match (NULL or empty matches all) */
+static int gcov_contains(const char *str, const char *match)
+{
+    if (!match || !*match) {
+        return 1;
+    }
+    for (; str && *str; str++) {
+        u32 i = 0;
+
+        while (match[i] && str[i] == match[i]) {
+            i++;
+        }
+        if (!match[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Count a function */
+static int gcov_summary_fn(const gcov_fn_view_t *fn, void *ctx)
+{
+    (void)fn; // ignore unused param
+    ((GcovSummary *)ctx)->functions++;
+    return 0;
+}
+
+/* Count the function entered if any arc counter is nonzero, else list it */
+static int gcov_summary_ctr(const gcov_fn_view_t *fn, const gcov_ctr_view_t *ctr, void *ctx)
+{
+    GcovSummary *s = (GcovSummary *)ctx;
+    u32 n;
+
+    if (ctr->kind != GCOV_COUNTER_ARCS) {
+        return 0;
+    }
+    if (!gcov_kernel_all_zero(ctr->values, ctr->num)) {
+        s->entered++;
+        return 0;
+    }
+    if (s->packet && !s->overflow) {
+        /* after room for the file header, moved down in gcov_summary_file */
+        n = gcov_put_leb128(s->packet + s->pos + GCOV_SUMMARY_FILE_BYTES,
+                            s->packet_bytes - s->pos - GCOV_SUMMARY_FILE_BYTES, fn->ident);
+        if (n) {
+            s->pos += n;
+            s->missed++;
+        } else {
+            s->overflow = 1;
+        }
+    }
+    return 0;
+}
+
+/* Summarize one file, and put its never-entered list in the packet */
+static void gcov_summary_file(GcovSummary *s, struct gcov_info *info, u32 index)
+{
+    u32 start = s->pos;
+    u32 n;
+
+    s->functions = 0;
+    s->entered = 0;
+    s->missed = 0;
+    s->overflow = (s->packet && s->packet_bytes - s->pos < GCOV_SUMMARY_FILE_BYTES);
+    (void)gcov_foreach(info, gcov_summary_fn, gcov_summary_ctr, s);
+
+    if (s->packet) {
+        if (s->overflow) {
+            /* a partial list would mislead, so drop it (later files may fit) */
+            s->pos = start;
+            s->summary->truncated = 1;
+        } else if (s->missed) {
+            unsigned char *list = s->packet + start + GCOV_SUMMARY_FILE_BYTES;
+            u32 len = s->pos - start;
+
+            n = gcov_put_leb128(s->packet + start, GCOV_SUMMARY_FILE_BYTES, index);
+            n += gcov_put_leb128(s->packet + start + n, GCOV_SUMMARY_FILE_BYTES - n, s->missed);
+            gcov_move_down(s->packet + start + n, list, len);
+            s->pos = start + n + len;
+        }
+    }
+
+    s->summary->files++;
+    s->summary->functions += s->functions;
+    s->summary->entered += s->entered;
+
+#ifdef GCOV_OPT_PRINT_STATUS
+    GCOV_PRINT_STR("Gcov Functions ");
+    GCOV_PRINT_NUM(index);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(s->entered);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(s->functions);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_STR(gcov_info_filename(info));
+    GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+}
+
+/*
+ * __gcov_function_summary counts the functions entered at least once,
+ * of those in the files whose filename contains match (or all, if NULL),
+ * into summary, and prints "Gcov Functions <index> <entered> <functions>
+ * <filename>" per file and "Gcov Functions Total <entered> <functions>"
+ * (if GCOV_OPT_PRINT_STATUS).
+ * If packet is not NULL, it is filled in with the counts and the idents
+ * of the functions never entered (see gcov_public.h), as many files' worth
+ * as fit in packet_bytes, and the byte count used is returned.
+ */
+gcov_unsigned_t __gcov_function_summary(const char *match, gcov_fn_summary_t *summary,
+                                        unsigned char *packet, gcov_unsigned_t packet_bytes)
+{
+    GcovInfo *listptr = gcov_headGcov;
+    gcov_fn_summary_t total;
+    GcovSummary s;
+    u32 index = 0;
+    u32 n;
+
+    if (!summary) {
+        summary = &total;
+    }
+    summary->files = 0;
+    summary->functions = 0;
+    summary->entered = 0;
+    summary->truncated = 0;
+
+    s.summary = summary;
+    s.packet = (packet_bytes >= GCOV_SUMMARY_HEADER_BYTES) ? packet : NULL;
+    s.packet_bytes = packet_bytes;
+    s.pos = GCOV_SUMMARY_HEADER_BYTES; // header is moved down at the end
+
+    while (listptr) {
+        if (gcov_contains(gcov_info_filename(listptr->info), match)) {
+            gcov_summary_file(&s, listptr->info, index);
+        }
+        index++;
+        listptr = listptr->next;
+    }
+
+#ifdef GCOV_OPT_PRINT_STATUS
+    GCOV_PRINT_STR("Gcov Functions Total ");
+    GCOV_PRINT_NUM(summary->entered);
+    GCOV_PRINT_STR(" ");
+    GCOV_PRINT_NUM(summary->functions);
+    GCOV_PRINT_STR("\n");
+#endif // GCOV_OPT_PRINT_STATUS
+
+    if (!packet) {
+        return 0;
+    }
+    if (!s.packet) {
+        summary->truncated = 1;
+        return 0;
+    }
+    packet[0] = summary->truncated ? 1 : 0;
+    n = 1;
+    n += gcov_put_leb128(packet + n, GCOV_SUMMARY_HEADER_BYTES - n, summary->functions);
+    n += gcov_put_leb128(packet + n, GCOV_SUMMARY_HEADER_BYTES - n, summary->entered);
+    gcov_move_down(packet + n, packet + GCOV_SUMMARY_HEADER_BYTES, s.pos - GCOV_SUMMARY_HEADER_BYTES);
+    return n + s.pos - GCOV_SUMMARY_HEADER_BYTES;
+}
+#endif // GCOV_OPT_PROVIDE_FUNCTION_SUMMARY
+
 /* ----------------------------------------------------------- */
 /*
  * This function should never be called. Merging is not supported.
@@ -458,6 +2421,30 @@ void __gcov_merge_add(gcov_type *counters, gcov_unsigned_t n_counters)
 #endif // GCOV_OPT_USE_STDLIB
 }
 
+/*
+ * Merge function of the condition counters of -fcondition-coverage
+ * (GCC 14 and later), and of the IOR counters of -fprofile-values.
+ * Never called either, but gcc puts it in the merge array of each
+ * gcov_info that has such counters, which is how the conversion
+ * knows to output them, so it has to be there to link.
+ */
+void __gcov_merge_ior(gcov_type *counters, gcov_unsigned_t n_counters)
+{
+    (void)counters; // ignore unused param
+    (void)n_counters; // ignore unused param
+
+#ifdef GCOV_OPT_PRINT_STATUS
+    GCOV_PRINT_STR("__gcov_merge_ior isn't called either");
+#endif // GCOV_OPT_PRINT_STATUS
+
+#ifdef GCOV_OPT_USE_STDLIB
+    fflush(stdout);
+    exit(1);
+#else
+    return;
+#endif // GCOV_OPT_USE_STDLIB
+}
+
 /** @}
  */
 /*
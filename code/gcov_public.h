@@ -60,6 +60,17 @@
  */
 //#define GCOV_OPT_RESET_WATCHDOG
 
+/* Use vector (SIMD) versions of the counter array kernels
+ * that clear, zero-test, OR-reduce, max-reduce and compare
+ * counter arrays (see gcov_gcc.c).
+ * Only useful on hosted simulation builds or larger processors,
+ * selects AVX2, SSE2 or AArch64 NEON code depending on the
+ * compiler target flags (such as -mavx2).
+ * If not defined, or if none of those are available,
+ * the portable scalar versions are used.
+ */
+//#define GCOV_OPT_USE_VECTOR_KERNELS
+
 /* Provide function to call constructor list (even in plain C)
  * (to call the gcc-generated code that calls __gcov_init).
  * Might be needed if you are not running a standard
@@ -97,11 +108,106 @@ extern void *__ctor_end;
  */
 #define GCOV_OPT_PROVIDE_CLEAR_COUNTERS
 
+/* Provide function to output and clear the counter data in one pass.
+ * This is only needed if you want coverage for each of a series
+ * of intervals, that would otherwise take __gcov_exit followed by
+ * __gcov_clear, and lose any counts made in between.
+ * Each counter array is read and zeroed in one step, either
+ * by atomic exchange (if GCOV_OPT_RESET_ATOMIC below),
+ * or by a short critical section per counter array, using
+ * GCOV_CRITICAL_ENTER and GCOV_CRITICAL_EXIT below.
+ */
+//#define GCOV_OPT_PROVIDE_DUMP_AND_RESET
+
+/* Use gcc atomic builtins to read and zero each counter value.
+ * Not used if you don't define GCOV_OPT_PROVIDE_DUMP_AND_RESET.
+ * Requires 64-bit atomic exchange on your processor
+ * (or linking with libatomic).
+ */
+//#define GCOV_OPT_RESET_ATOMIC
+
+/* Enter and exit a critical section around reading and zeroing
+ * one counter array, such as by masking interrupts.
+ * Not used if you don't define GCOV_OPT_PROVIDE_DUMP_AND_RESET,
+ * or if you define GCOV_OPT_RESET_ATOMIC.
+ * If you do, you need to set this as appropriate for your system.
+ * You might need to add header files to gcov_gcc.c
+ */
+#define GCOV_CRITICAL_ENTER()
+#define GCOV_CRITICAL_EXIT()
+//#define GCOV_CRITICAL_ENTER() __disable_irq()
+//#define GCOV_CRITICAL_EXIT() __enable_irq()
+
+/* Provide function to visit the counter data in place.
+ * This is only needed if your own code on the target wants to look at
+ * the counters (such as for a coverage summary or health telemetry,
+ * or a custom output format), without converting to gcda format
+ * and parsing it back.
+ * __gcov_foreach() calls your functions for each function
+ * and each counter array of each file, with views (see gcov_fn_view_t
+ * and gcov_ctr_view_t below) pointing straight at the live counters,
+ * so nothing is copied.
+ */
+//#define GCOV_OPT_PROVIDE_FOREACH
+
+/* Provide function to walk the list of gcov_info registered by __gcov_init.
+ * This is only needed if your own code converts the gcov_info itself,
+ * such as C++ code using gcov_serializer.hpp (which needs this for
+ * its write_all), instead of __gcov_exit().
+ * __gcov_info_next(NULL) returns the first, __gcov_info_next(info)
+ * the one after info, NULL after the last.
+ */
+//#define GCOV_OPT_PROVIDE_INFO_LIST
+
+/* Provide function to summarize function coverage on the target,
+ * such as for a quick pass/fail check after a smoke test,
+ * without a dump and host tools.
+ * __gcov_function_summary() walks the files once (all of them,
+ * or those whose filename contains a given string, such as the
+ * directory of one subsystem), counting the instrumented functions
+ * and those entered at least once (any nonzero arc counter).
+ * It fills in a gcov_fn_summary_t (see below), prints a
+ * "Gcov Functions" line per file and in total (if GCOV_OPT_PRINT_STATUS),
+ * and can fill in a compact packet listing the idents of the functions
+ * never entered, for telemetry.
+ * The packet is a flag byte (1 if the list did not all fit),
+ * then unsigned LEB128 numbers (7 bits per byte, low first,
+ * top bit set on all but the last byte): the count of functions,
+ * the count entered, then for each file with functions never entered,
+ * its index (as in the "Gcov Functions" lines), the count of
+ * functions never entered, and their idents (as in the .gcno file).
+ */
+//#define GCOV_OPT_PROVIDE_FUNCTION_SUMMARY
+
+/* Provide function to fold the arc counters into a fuzzing edge map.
+ * This is only needed if you run a coverage-guided fuzzer over your code
+ * on a hosted build (such as of a parser), and want its feedback from
+ * these counters instead of from a second instrumented build.
+ * __gcov_edge_map() ORs a hit count bucket into a byte of your map for
+ * each arc counter that is nonzero, as an AFL-style fuzzer expects
+ * of its shared map, and can zero those counters in the same pass,
+ * ready for the next iteration. Clear the map yourself before each
+ * iteration, as the fuzzer does.
+ * The byte of an arc is by a hash of the position of its file in the
+ * list of files (as registered by __gcov_init, so the same for each run
+ * of the same program), the function ident, and the arc, so unrelated
+ * arcs can share a byte, as in AFL.
+ * The buckets are those of AFL: 1, 2, 3, 4-7, 8-15, 16-31, 32-127,
+ * 128 and over, each a bit of the byte.
+ * Counter arrays of functions not entered are skipped with the counter
+ * array kernels (see GCOV_OPT_USE_VECTOR_KERNELS), so the cost is mostly
+ * in the functions the iteration ran.
+ */
+//#define GCOV_OPT_PROVIDE_EDGE_MAP
+
 /* Provide small imitation printf function.
  * This is only needed if you want serial port outputs and
  * do not have already-existing functions to do the printing.
  * If you select this, then you need to provide a function
  * write_bytes() that does the actual serial output in your system.
+ * Also provides the print primitives gcov_put_str, gcov_put_dec,
+ * gcov_put_u32_hex8 and gcov_put_u8_hex2, which the GCOV_PRINT_*
+ * defs below use by default, so the dump loop parses no format strings.
  * See gcov_printf.c
  */
 #define GCOV_OPT_PROVIDE_PRINTF_IMITATION
@@ -121,7 +227,7 @@ extern void *__ctor_end;
 //#define GCOV_OPT_OUTPUT_BINARY_FILE
 
 /* Modify this output filename if desired */
-/* Not used if you do not define GCOV_OPT_OUTPUT_BINARY_FILE */
+/* Not used if you do not define GCOV_OPT_OUTPUT_BINARY_FILE or GCOV_OPT_OUTPUT_BINARY_MMAP */
 #define GCOV_OUTPUT_BINARY_FILENAME "gcov_output.bin"
 
 /* Modify file headers, data type and functions, if needed */
@@ -134,7 +240,7 @@ extern void *__ctor_end;
 #include <unistd.h>
 
 typedef int GCOV_FILE_TYPE;
-#define GCOV_OPEN_FILE(filename) open((filename), (O_CREAT|O_WRONLY), (S_IRWXU|S_IRWXG|S_IRWXO))
+#define GCOV_OPEN_FILE(filename) open((filename), (O_CREAT|O_WRONLY|O_TRUNC), (S_IRWXU|S_IRWXG|S_IRWXO))
 #define GCOV_OPEN_ERROR(fileref) ((fileref) < 0)
 #define GCOV_CLOSE_FILE(fileref) close((fileref))
 #define GCOV_WRITE_BYTE(fileref, char_var) write((fileref), &(char_var), (1))
@@ -149,6 +255,65 @@ typedef FILE * GCOV_FILE_TYPE;
 #endif
 #endif // GCOV_OPT_OUTPUT_BINARY_FILE
 
+/* Output gcda data as binary format in file (same as
+ * GCOV_OPT_OUTPUT_BINARY_FILE, and instead of it), through a memory
+ * mapping, for builds hosted on Linux or another POSIX system.
+ * The file is sized in advance from the byte counts of all files
+ * (with room for GCOV_OPT_PACK_CONDITIONS and GCOV_OPT_COMPRESS_LZ
+ * to make the data bigger, at worst), mapped, and the data
+ * converted straight into the mapping,
+ * so there are no write calls and no buffer for a whole file;
+ * then synced, and cut to the size actually used.
+ * Uses GCOV_OUTPUT_BINARY_FILENAME.
+ * See scripts/bench_output.sh to time it against GCOV_OPT_OUTPUT_BINARY_FILE.
+ * Can be combined with other GCOV_OPT_OUTPUT_* options.
+ */
+//#define GCOV_OPT_OUTPUT_BINARY_MMAP
+
+/* Not used if you do not define GCOV_OPT_OUTPUT_BINARY_MMAP */
+#ifdef GCOV_OPT_OUTPUT_BINARY_MMAP
+#ifdef GCOV_OPT_OUTPUT_BINARY_FILE
+#error "Define only one of GCOV_OPT_OUTPUT_BINARY_FILE and GCOV_OPT_OUTPUT_BINARY_MMAP"
+#endif
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#endif // GCOV_OPT_OUTPUT_BINARY_MMAP
+
+/* Output gcda data directly as .gcda files, like libgcov,
+ * for builds hosted on Linux or another system with POSIX files.
+ * Each file is written to its own path (as compiled, so next to
+ * its .gcno file), with one open, write and close, creating
+ * directories as needed, so lcov or gcov can run on the result at once.
+ * Existing .gcda files are overwritten, not merged.
+ * Can be combined with other GCOV_OPT_OUTPUT_* options.
+ */
+//#define GCOV_OPT_OUTPUT_GCDA_FILES
+
+/* Relocate the .gcda files as libgcov does with GCOV_PREFIX
+ * and GCOV_PREFIX_STRIP: drop that many leading directories
+ * from each path, then put the prefix in front.
+ * Without a prefix, the paths are used as they are.
+ * If you define GCOV_OPT_USE_STDLIB, the environment variables
+ * GCOV_PREFIX and GCOV_PREFIX_STRIP override these.
+ * Not used if you do not define GCOV_OPT_OUTPUT_GCDA_FILES.
+ */
+#define GCOV_GCDA_PREFIX ""
+#define GCOV_GCDA_PREFIX_STRIP 0
+#define GCOV_GCDA_PATH_MAX 4096
+
+/* Not used if you do not define GCOV_OPT_OUTPUT_GCDA_FILES */
+#ifdef GCOV_OPT_OUTPUT_GCDA_FILES
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // GCOV_OPT_OUTPUT_GCDA_FILES
+
 /* Output gcda data as binary format in memory block.
  * Requires your custom code in gcov_public.c
  * to set the starting address of the block.
@@ -166,6 +331,281 @@ typedef FILE * GCOV_FILE_TYPE;
  */
 #define GCOV_OPT_OUTPUT_SERIAL_HEXDUMP
 
+/* Output gcda data as acknowledged chunks of hexdump ASCII on serial port,
+ * for links that can drop data or be interrupted.
+ * Each chunk line carries its (file entry, byte offset) cursor and a CRC,
+ * and the host acknowledges what it has received, by your command code
+ * calling __gcov_transfer_ack() (or a debugger writing gcov_ack.entry
+ * and gcov_ack.offset directly, see gcov_ack_t below).
+ * Up to GCOV_CHUNK_WINDOW chunks are sent ahead of the last
+ * acknowledgment, and if no acknowledgment arrives in time,
+ * sending goes back to the last acknowledged position, with that one
+ * chunk alone until it is acknowledged, as the host keeps the chunks
+ * after a lost one, so a loss costs one chunk again, not a window.
+ * If interrupted altogether, the next __gcov_exit() resumes from the
+ * last acknowledged position instead of starting over.
+ * The interrupted file itself resumes only if its data is unchanged:
+ * the cursor keeps a check of the data last sent for it, and the
+ * "Gcov Entry" line carries it to the host, so a file whose counters
+ * have moved on is sent again from its start, never joined to the
+ * acknowledged part of an older one. (So after __gcov_dump_and_reset(),
+ * which already zeroed the counters of the interrupted file, the counts
+ * of that file are lost, rather than mixed.)
+ * See tools/gcov_receive.c for the host side.
+ * Files already acknowledged are skipped for all outputs, so best not
+ * combined with other GCOV_OPT_OUTPUT_* options.
+ * If defined, you must also provide defs below
+ * for GCOV_PRINT_STR, GCOV_PRINT_NUM, GCOV_PRINT_HEX32
+ * and GCOV_PRINT_HEXDUMP_DATA.
+ */
+//#define GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+/* Chunk size, window, and waiting for acknowledgment */
+/* Not used if you do not define GCOV_OPT_OUTPUT_SERIAL_CHUNKED */
+/* Set GCOV_CHUNK_WINDOW to 0 to never wait (resume only on the next __gcov_exit) */
+#define GCOV_CHUNK_BYTES 64
+#define GCOV_CHUNK_WINDOW 8
+/* Count of GCOV_CHUNK_POLL calls without new acknowledgment before going back */
+#define GCOV_CHUNK_TIMEOUT 100000
+/* Count of go-backs without new acknowledgment before giving up */
+#define GCOV_CHUNK_RETRIES 10
+/* Called while waiting for acknowledgment, to service your command input
+ * (which calls __gcov_transfer_ack), or to delay. */
+#define GCOV_CHUNK_POLL()
+//#define GCOV_CHUNK_POLL() poll_commands()
+
+/* Address of the acknowledgment cursor.
+ * Not used if you do not define GCOV_OPT_OUTPUT_SERIAL_CHUNKED.
+ * Define GCOV_ACK_ADDRESS to put gcov_ack (see gcov_ack_t below)
+ * at a fixed address instead of in the program data (such as memory
+ * not initialized at startup, so a transfer interrupted by a processor
+ * reset can resume, if the counters are also kept there).
+ */
+//#define GCOV_ACK_ADDRESS 0x42010000
+
+/* Output gcda data as binary format (same as GCOV_OPT_OUTPUT_BINARY_FILE)
+ * through a DMA channel, such as to a UART or SpaceWire link.
+ * Data is converted in pieces into GCOV_DMA_BUFFERS buffers
+ * of GCOV_DMA_CHUNK_BYTES each, and while one buffer is being
+ * transmitted, the next is filled, so conversion overlaps transmission.
+ * If this is the only GCOV_OPT_OUTPUT_* option, no buffer for
+ * a whole file (gcov_buf) is needed.
+ * You provide GCOV_DMA_START below to start transmission of a buffer,
+ * without waiting for it, and your DMA completion interrupt
+ * (or GCOV_DMA_POLL, if you poll the DMA status instead)
+ * calls __gcov_dma_complete() when the transmission is done.
+ * GCOV_CRITICAL_ENTER and GCOV_CRITICAL_EXIT above must keep
+ * that interrupt out, if you use one.
+ * __gcov_exit() returns after the last buffer has been transmitted.
+ * Can be combined with other GCOV_OPT_OUTPUT_* options.
+ */
+//#define GCOV_OPT_OUTPUT_DMA
+
+/* Count and size of DMA buffers */
+/* Not used if you do not define GCOV_OPT_OUTPUT_DMA */
+/* Size must be a multiple of 4 */
+#define GCOV_DMA_BUFFERS 2
+#define GCOV_DMA_CHUNK_BYTES 512
+
+/* Start transmission of len bytes at data, without waiting.
+ * Not used if you do not define GCOV_OPT_OUTPUT_DMA.
+ * The default transmits nothing and completes at once.
+ */
+#define GCOV_DMA_START(data, len) __gcov_dma_complete()
+//#define GCOV_DMA_START(data, len) uart_dma_start((data), (len))
+
+/* Called while waiting for a buffer to be transmitted,
+ * to check the DMA status (calling __gcov_dma_complete() when done),
+ * or to do other work.
+ * Not used if you do not define GCOV_OPT_OUTPUT_DMA.
+ */
+#define GCOV_DMA_POLL()
+//#define GCOV_DMA_POLL() if (uart_dma_done()) __gcov_dma_complete()
+
+/* Output gcda data as binary format (same as GCOV_OPT_OUTPUT_BINARY_FILE)
+ * into NOR or NAND flash, for runs without a host connection.
+ * The flash area holds GCOV_FLASH_SLOTS dump slots, used in turn
+ * to spread the wear: each dump goes to the slot after the newest,
+ * with a sequence number in its header, so the newest can be found
+ * (by the target after a reset, and by the host in a flash image).
+ * Output is buffered into full pages, and the slot header page is
+ * programmed last, so a dump cut short by a reset or power loss
+ * is never valid, and the dumps before it are left intact.
+ * After each dump the next slot is erased, so the following dump
+ * (in the same run) costs page-program time only;
+ * so GCOV_FLASH_SLOTS - 1 dumps are kept.
+ * You provide GCOV_FLASH_ERASE, GCOV_FLASH_PROGRAM and GCOV_FLASH_READ
+ * below, or define GCOV_OPT_FLASH_SIMULATOR to try it out in RAM.
+ * See tools/gcov_unpack.c to extract the newest dump from a flash image.
+ * Can be combined with other GCOV_OPT_OUTPUT_* options.
+ */
+//#define GCOV_OPT_OUTPUT_FLASH
+
+/* Flash area and geometry.
+ * Not used if you do not define GCOV_OPT_OUTPUT_FLASH.
+ * Page size (the program unit) must be a multiple of 4, at least 28.
+ * Slot size must be a multiple of the page size and of the erase unit,
+ * and big enough for the binary format of all files.
+ */
+#define GCOV_FLASH_ADDRESS 0x08080000
+#define GCOV_FLASH_PAGE_BYTES 256
+#define GCOV_FLASH_SLOT_BYTES 65536
+#define GCOV_FLASH_SLOTS 4
+
+/* Use RAM instead of flash, such as for testing on a host.
+ * Not used if you do not define GCOV_OPT_OUTPUT_FLASH.
+ * The RAM is gcov_flash_sim[], which a test can save to a file
+ * as a flash image, or load from one to simulate a power cycle.
+ */
+//#define GCOV_OPT_FLASH_SIMULATOR
+
+/* Functions to erase len bytes at flash address addr,
+ * to program one page of GCOV_FLASH_PAGE_BYTES at addr from data,
+ * and to read len bytes at addr into data.
+ * Each must return 0 on success.
+ * Not used if you do not define GCOV_OPT_OUTPUT_FLASH.
+ */
+#ifdef GCOV_OPT_FLASH_SIMULATOR
+#define GCOV_FLASH_ERASE(addr, len) gcov_flash_sim_erase((addr), (len))
+#define GCOV_FLASH_PROGRAM(addr, data) gcov_flash_sim_program((addr), (data))
+#define GCOV_FLASH_READ(addr, data, len) gcov_flash_sim_read((addr), (data), (len))
+#else
+#define GCOV_FLASH_ERASE(addr, len) flash_erase((addr), (len))
+#define GCOV_FLASH_PROGRAM(addr, data) flash_program((addr), (data), GCOV_FLASH_PAGE_BYTES)
+#define GCOV_FLASH_READ(addr, data, len) flash_read((addr), (data), (len))
+#endif // GCOV_OPT_FLASH_SIMULATOR
+
+/* Output gcda data as binary format (same as GCOV_OPT_OUTPUT_BINARY_FILE)
+ * into a memory block of bounded size, gcov_ring (see gcov_ring_t below),
+ * for a debugger or host to read out. The header of the block gives
+ * the valid range of data, so it can be read in one transfer
+ * (two, if wrapped around), and whether the last dump is complete.
+ * GCOV_RING_POLICY says what to do when the data does not fit:
+ *   GCOV_RING_STOP: each dump starts at the beginning of the block,
+ *     and output stops when the block is full (status truncated).
+ *   GCOV_RING_WRAP: each dump follows the one before, such as for
+ *     __gcov_dump_and_reset() of a series of intervals, overwriting
+ *     the oldest data, and generation counts the wraps; the newest dump
+ *     is complete unless it is larger than the block (status truncated).
+ *   GCOV_RING_COMPRESS: as GCOV_RING_STOP, but each run of zero bytes
+ *     (mostly high words of counters) is stored as a zero byte and
+ *     a count byte, often saving a third or more of the space
+ *     (GCOV_OPT_COMPRESS_LZ below saves more, at more processor time).
+ * See tools/gcov_unpack.c to unpack an image of the block.
+ * Can be combined with other GCOV_OPT_OUTPUT_* options.
+ */
+//#define GCOV_OPT_OUTPUT_MEMORY_RING
+
+/* Policies for GCOV_RING_POLICY */
+#define GCOV_RING_STOP 0
+#define GCOV_RING_WRAP 1
+#define GCOV_RING_COMPRESS 2
+
+/* Size and policy of the memory ring.
+ * Not used if you do not define GCOV_OPT_OUTPUT_MEMORY_RING.
+ * Define GCOV_RING_ADDRESS to put gcov_ring at a fixed address
+ * instead of in the program data (such as memory not initialized
+ * at startup, so a wrapping ring survives a processor reset).
+ */
+#define GCOV_RING_BYTES 65536
+#define GCOV_RING_POLICY GCOV_RING_STOP
+//#define GCOV_RING_ADDRESS 0x42000000
+
+/* Compress the binary format on its way to the outputs that take it
+ * in pieces (GCOV_OPT_OUTPUT_DMA, GCOV_OPT_OUTPUT_FLASH,
+ * GCOV_OPT_OUTPUT_MEMORY_RING and GCOV_OPT_OUTPUT_BINARY_MMAP),
+ * trading processor time for link time or storage.
+ * The compression is LZSS: each byte either stands for itself,
+ * or starts a copy of 3 to 18 bytes from up to 4095 bytes back,
+ * found through a hash table of recent positions. The gcda format
+ * repeats itself a lot (tags, record lengths, high words of counters),
+ * so typically only a third to two fifths of the bytes are left,
+ * at some 10 to 20 processor cycles per byte
+ * (see scripts/bench_lz.sh to measure it).
+ * Uses a static window of 1 << GCOV_LZ_WINDOW_BITS bytes
+ * and a hash table of 4 << GCOV_LZ_HASH_BITS bytes, no malloc.
+ * Each dump is compressed as a whole, after a "GcvZ" header,
+ * and is unpacked by tools/gcov_unpack.c, which recognizes it.
+ * The outputs that take each file whole (such as
+ * GCOV_OPT_OUTPUT_SERIAL_HEXDUMP) are not compressed,
+ * so with none of the outputs above selected this does nothing.
+ */
+//#define GCOV_OPT_COMPRESS_LZ
+
+/* Window and hash table size of the compression.
+ * Not used if you do not define GCOV_OPT_COMPRESS_LZ.
+ * A smaller window finds fewer copies (the format allows up to 12 bits),
+ * and a smaller hash table forgets positions sooner.
+ */
+#define GCOV_LZ_WINDOW_BITS 12
+#define GCOV_LZ_HASH_BITS 10
+
+/* Pack the condition coverage counters of GCC 14 and later
+ * (-fcondition-coverage, for MC/DC) on their way to the outputs
+ * that take the binary format in pieces (as for GCOV_OPT_COMPRESS_LZ).
+ * Each condition expression has a pair of 64-bit counters, bitmasks
+ * of the terms seen true and seen false, so for the usual expression
+ * of a few terms nearly all of their 16 bytes are zero. Packed, each
+ * counter is an unsigned LEB128 number (7 bits per byte, the top bit
+ * set if more bytes follow), so such a pair takes 2 bytes, and the
+ * condition records cost less than the arc records beside them.
+ * The other records pass unchanged, a word at a time, in a single pass
+ * with no buffer of the file. The byte count of each file is still
+ * that of the unpacked .gcda data, with its top bit set to mark the
+ * file as packed; tools/gcov_unpack.c and the host decoder of
+ * tools/gcov_host.c unpack it back to the .gcda data exactly.
+ * Done before GCOV_OPT_COMPRESS_LZ if both are selected.
+ * (With GCC 5 to 9, counter kind 8 is instead of -fprofile-values,
+ * and is packed too, correctly but to no great gain.)
+ * See tools/gcov_mcdc.c for an MC/DC report of the unpacked data.
+ */
+//#define GCOV_OPT_PACK_CONDITIONS
+
+/* Provide function to output within a byte budget,
+ * such as for a short ground contact window.
+ * Files are ranked by the value of their data:
+ * a priority you set with __gcov_set_priority(), then whether
+ * the counters changed since the file was last output by
+ * __gcov_exit_budget(), then the density of nonzero counters.
+ * Unchanged files are skipped, and the best of the others are
+ * output (in the usual order) until the budget is spent.
+ * Files left out remain changed, so the next window continues
+ * with them; a "Gcov Deferred <count>" line says how many are left.
+ * Applies to all GCOV_OPT_OUTPUT_* options.
+ */
+//#define GCOV_OPT_BUDGET_DUMP
+
+/* Bytes on the link for a file of gcda data n bytes long,
+ * used to charge each file against the budget.
+ * Not used if you do not define GCOV_OPT_BUDGET_DUMP.
+ * Set this as appropriate for your output method(s).
+ */
+/* hexdump: 3 chars per byte, 11 per 16-byte line, plus headers */
+#define GCOV_BUDGET_WIRE_BYTES(n) ((n) * 3 + ((n) / 16 + 1) * 11 + 200)
+//#define GCOV_BUDGET_WIRE_BYTES(n) ((n) + 100)
+
+/* Skip output of files whose counters the host already has.
+ * A 64-bit hash of the counter contents of each file is compared
+ * against a table of hashes known to the host, and matching files
+ * are not output, saving most of the time of repeated dumps.
+ * The host fills the table gcov_known_hashes[] and sets
+ * gcov_known_hash_count, either directly with a debugger,
+ * or by your command code calling __gcov_add_known_hash().
+ * The hashes come from the "Gcov Hash" lines printed for each
+ * file output, or listed by __gcov_emit_hashes().
+ * See scripts/known_hashes.awk.
+ * Applies to all GCOV_OPT_OUTPUT_* options.
+ * Not applied by __gcov_dump_and_reset(), which outputs every file,
+ * as its counters could not be hashed and zeroed in one step.
+ * If defined, you must also provide defs below
+ * for GCOV_PRINT_STR, GCOV_PRINT_NUM and GCOV_PRINT_HEX32.
+ */
+//#define GCOV_OPT_HASH_DEDUP
+
+/* Size of the known hash table. Need one entry per file compiled for coverage. */
+/* Not used if you do not define GCOV_OPT_HASH_DEDUP */
+#define GCOV_KNOWN_HASHES_MAX 100
+
 /* Function to print a string without newline.
  * Not used if you don't define either GCOV_OPT_PRINT_STATUS
  * or GCOV_OPT_OUTPUT_SERIAL_HEXDUMP.
@@ -174,7 +614,8 @@ typedef FILE * GCOV_FILE_TYPE;
  */
 //#define GCOV_PRINT_STR(str) fputs((str), stdout)
 //#define GCOV_PRINT_STR(str) printf("%s", str)
-#define GCOV_PRINT_STR(str) gcov_printf("%s", str)
+//#define GCOV_PRINT_STR(str) gcov_printf("%s", str)
+#define GCOV_PRINT_STR(str) gcov_put_str((str))
 //#define GCOV_PRINT_STR(str) puts((str))
 
 /* Function to print a number without newline.
@@ -184,7 +625,8 @@ typedef FILE * GCOV_FILE_TYPE;
  * You might need to add header files to gcc_public.c
  */
 //#define GCOV_PRINT_NUM(num) printf("%d", (num))
-#define GCOV_PRINT_NUM(num) gcov_printf("%d", (num))
+//#define GCOV_PRINT_NUM(num) gcov_printf("%d", (num))
+#define GCOV_PRINT_NUM(num) gcov_put_dec((num))
 //#define GCOV_PRINT_NUM(num) print_num((num))
 
 /* Function to print hexdump address.
@@ -193,7 +635,8 @@ typedef FILE * GCOV_FILE_TYPE;
  * You might need to add header files to gcc_public.c
  */
 //#define GCOV_PRINT_HEXDUMP_ADDR(num) printf("%08x: ", (num))
-#define GCOV_PRINT_HEXDUMP_ADDR(num) gcov_printf("%08x: ", (num))
+//#define GCOV_PRINT_HEXDUMP_ADDR(num) gcov_printf("%08x: ", (num))
+#define GCOV_PRINT_HEXDUMP_ADDR(num) (gcov_put_u32_hex8((num)), gcov_put_str(": "))
 
 /* Function to print hexdump data value.
  * Not used if you don't define GCOV_OPT_OUTPUT_SERIAL_HEXDUMP.
@@ -201,7 +644,18 @@ typedef FILE * GCOV_FILE_TYPE;
  * You might need to add header files to gcc_public.c
  */
 //#define GCOV_PRINT_HEXDUMP_DATA(num) printf("%02x ", (num))
-#define GCOV_PRINT_HEXDUMP_DATA(num) gcov_printf("%02x ", (num))
+//#define GCOV_PRINT_HEXDUMP_DATA(num) gcov_printf("%02x ", (num))
+#define GCOV_PRINT_HEXDUMP_DATA(num) (gcov_put_u8_hex2((num)), gcov_put_str(" "))
+
+/* Function to print a 32-bit hex value (8 digits) without newline.
+ * Not used if you don't define GCOV_OPT_HASH_DEDUP
+ * or GCOV_OPT_OUTPUT_SERIAL_CHUNKED.
+ * If you do, you need to set this as appropriate for your system.
+ * You might need to add header files to gcc_public.c
+ */
+//#define GCOV_PRINT_HEX32(num) printf("%08x", (num))
+//#define GCOV_PRINT_HEX32(num) gcov_printf("%08x", (num))
+#define GCOV_PRINT_HEX32(num) gcov_put_u32_hex8((num))
 
 /* End of user settings ---------------------------------- */
 
@@ -215,21 +669,146 @@ struct gcov_info;
 typedef unsigned gcov_unsigned_t;
 typedef long long gcov_type;
 
+/* Our own creation */
+typedef unsigned long long gcov_hash_t;
+
+/* Counter kind of the arc (branch) execution counts,
+ * the only kind without -fprofile-values and the like.
+ * Compare to gcc/gcov-counter.def */
+#define GCOV_COUNTER_ARCS 0
+
+/* Counter kind of the condition bitmasks of -fcondition-coverage
+ * (GCC 14 and later), a pair of counters for each condition expression:
+ * the terms seen true, and the terms seen false.
+ * Compare to gcc/gcov-counter.def */
+#define GCOV_COUNTER_CONDITIONS 8
+
+/* Views over the live counter data, for __gcov_foreach() and gcov_foreach().
+ * Our own creation.
+ * The values are read in place, while your code may still be
+ * incrementing them (and a 64-bit value can be read half updated
+ * on a 32-bit processor), so stop that first if you need a snapshot. */
+typedef struct {
+    const char *filename;               // .gcda filename of the file
+    gcov_unsigned_t ident;              // unique ident of the function within the file
+    gcov_unsigned_t lineno_checksum;    // as in the .gcno file
+    gcov_unsigned_t cfg_checksum;       // as in the .gcno file
+} gcov_fn_view_t;
+typedef struct {
+    gcov_unsigned_t kind;               // counter kind, GCOV_COUNTER_ARCS etc.
+    gcov_unsigned_t num;                // count of values
+    const gcov_type *values;
+} gcov_ctr_view_t;
+
+/* Called for each function, and for each counter array of each function.
+ * Return nonzero to stop the walk (that value is returned from it). */
+typedef int (*gcov_fn_cb_t)(const gcov_fn_view_t *fn, void *ctx);
+typedef int (*gcov_ctr_cb_t)(const gcov_fn_view_t *fn, const gcov_ctr_view_t *ctr, void *ctx);
+
+/* Result of __gcov_function_summary() */
+/* Our own creation */
+typedef struct {
+    gcov_unsigned_t files;              // files summarized
+    gcov_unsigned_t functions;          // instrumented functions in them
+    gcov_unsigned_t entered;            // functions entered at least once
+    gcov_unsigned_t truncated;          // nonzero if the packet could not list all the others
+} gcov_fn_summary_t;
+
 /* Compare to libgcc/libgcov.h */
 void __gcov_init(struct gcov_info *info);
 void __gcov_exit(void);
 void __gcov_merge_add(gcov_type *counters, gcov_unsigned_t n_counters);
+void __gcov_merge_ior(gcov_type *counters, gcov_unsigned_t n_counters);
+
+#ifdef GCOV_OPT_OUTPUT_MEMORY_RING
+/* Memory ring block. All fields are in target byte order. */
+#define GCOV_RING_MAGIC 0x52696e67 /* "Ring" */
+#define GCOV_RING_COMPLETE 0
+#define GCOV_RING_IN_PROGRESS 1
+#define GCOV_RING_TRUNCATED 2
+typedef struct {
+    gcov_unsigned_t magic;      // GCOV_RING_MAGIC
+    gcov_unsigned_t policy;     // GCOV_RING_POLICY
+    gcov_unsigned_t capacity;   // GCOV_RING_BYTES
+    gcov_unsigned_t generation; // count of times the data wrapped around
+    gcov_unsigned_t start;      // data offset of the oldest valid byte
+    gcov_unsigned_t length;     // count of valid bytes from start on (wrapping)
+    gcov_unsigned_t dump;       // data offset of the newest dump
+    gcov_unsigned_t status;     // of the newest dump, GCOV_RING_COMPLETE etc.
+    unsigned char data[GCOV_RING_BYTES];
+} gcov_ring_t;
+#ifndef GCOV_RING_ADDRESS
+extern gcov_ring_t gcov_ring;
+#endif
+#endif // GCOV_OPT_OUTPUT_MEMORY_RING
+
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+/* Acknowledgment cursor. All fields are in target byte order. */
+#define GCOV_ACK_MAGIC 0x41636b73 /* "Acks" */
+typedef struct {
+    gcov_unsigned_t magic;      // GCOV_ACK_MAGIC
+    gcov_unsigned_t entry;      // host has all file entries before this one
+    gcov_unsigned_t offset;     // and this many bytes of this one
+    gcov_unsigned_t sent;       // file entry last sent
+    gcov_unsigned_t check;      // check of the data last sent for it
+} gcov_ack_t;
+#ifndef GCOV_ACK_ADDRESS
+extern volatile gcov_ack_t gcov_ack;
+#endif
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
 
 /* Our own creations */
 #ifdef GCOV_OPT_PROVIDE_CLEAR_COUNTERS
 void __gcov_clear(void);
 #endif
+#ifdef GCOV_OPT_PROVIDE_DUMP_AND_RESET
+void __gcov_dump_and_reset(void);
+#endif
 #ifdef GCOV_OPT_PROVIDE_CALL_CONSTRUCTORS
 void __gcov_call_constructors(void);
 #endif
+#ifdef GCOV_OPT_PROVIDE_INFO_LIST
+struct gcov_info *__gcov_info_next(const struct gcov_info *info);
+#endif
+#ifdef GCOV_OPT_PROVIDE_FOREACH
+int __gcov_foreach(gcov_fn_cb_t fn_cb, gcov_ctr_cb_t ctr_cb, void *ctx);
+#endif
+#ifdef GCOV_OPT_PROVIDE_FUNCTION_SUMMARY
+gcov_unsigned_t __gcov_function_summary(const char *match, gcov_fn_summary_t *summary,
+                                        unsigned char *packet, gcov_unsigned_t packet_bytes);
+#endif
+#ifdef GCOV_OPT_PROVIDE_EDGE_MAP
+gcov_unsigned_t __gcov_edge_map(unsigned char *map, gcov_unsigned_t map_bytes, int reset);
+#endif
+#ifdef GCOV_OPT_BUDGET_DUMP
+void __gcov_exit_budget(gcov_unsigned_t budget_bytes);
+void __gcov_set_priority(const char *filename, gcov_unsigned_t priority);
+#endif
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+void __gcov_transfer_ack(gcov_unsigned_t entry, gcov_unsigned_t offset);
+#endif
+#ifdef GCOV_OPT_OUTPUT_DMA
+void __gcov_dma_complete(void);
+#endif
+#if defined(GCOV_OPT_OUTPUT_FLASH) && defined(GCOV_OPT_FLASH_SIMULATOR)
+extern unsigned char gcov_flash_sim[GCOV_FLASH_SLOTS * GCOV_FLASH_SLOT_BYTES];
+int gcov_flash_sim_erase(gcov_unsigned_t addr, gcov_unsigned_t len);
+int gcov_flash_sim_program(gcov_unsigned_t addr, const unsigned char *data);
+int gcov_flash_sim_read(gcov_unsigned_t addr, unsigned char *data, gcov_unsigned_t len);
+#endif
+#ifdef GCOV_OPT_HASH_DEDUP
+extern gcov_hash_t gcov_known_hashes[GCOV_KNOWN_HASHES_MAX];
+extern gcov_unsigned_t gcov_known_hash_count;
+void __gcov_emit_hashes(void);
+void __gcov_add_known_hash(gcov_hash_t hash);
+#endif
 
 #ifdef GCOV_OPT_PROVIDE_PRINTF_IMITATION
 void gcov_printf(const char *fmt, ...);
+void gcov_put_str(const char *str);
+void gcov_put_dec(int num);
+void gcov_put_u32_hex8(gcov_unsigned_t num);
+void gcov_put_u8_hex2(unsigned char num);
 #endif
 
 #endif // __GCOV_PUBLIC_H__
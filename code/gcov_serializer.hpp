@@ -0,0 +1,287 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Optional C++17 header to convert gcov_info to .gcda data inline.
+ *
+ * For C++ code that wants the conversion of gcov_convert_to_gcda()
+ * compiled into its own output path: the serializer is a template on
+ * a sink policy (where each 32-bit word of .gcda data goes) and a
+ * layout policy (the gcov_info structures of the GCC in use), so the
+ * whole loop and the sink calls are inlined, with no function pointers,
+ * virtual calls or heap. The words are the same, in the same order,
+ * as gcov_convert_to_gcda() stores them (in the target byte order).
+ *
+ * A sink has a member void word(gcov_unsigned_t). It may also have
+ * void begin(const char *filename, size_t bytes), called before the
+ * words of each file with the byte count to come, and void end(),
+ * called after them. BufferSink and CountSink below are examples.
+ *
+ * Example, writing each file with your own output function:
+ *
+ *   struct UartSink {
+ *       void begin(const char *filename, size_t bytes) { uart_header(filename, bytes); }
+ *       void word(gcov_unsigned_t w) { uart_write(&w, sizeof(w)); }
+ *       void end() {}
+ *   };
+ *   UartSink sink;
+ *   gcov::Serializer<UartSink>::write_all(sink);
+ *
+ * write_all needs GCOV_OPT_PROVIDE_INFO_LIST (see gcov_public.h).
+ * See scripts/bench_serializer.sh to time it against gcov_convert_to_gcda().
+ *
+ **********************************************************************/
+
+#ifndef GCOV_SERIALIZER_HPP
+#define GCOV_SERIALIZER_HPP GCOV_SERIALIZER_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+extern "C" {
+#include "gcov_public.h"
+}
+
+namespace gcov {
+
+/*
+ * Layout of the gcov_info structures, as in gcov_gcc.c, for a GCC whose
+ * struct gcov_info has Counters merge functions (see GCOV_COUNTERS in
+ * gcov_gcc.h). If ArcsOnly, only the arc counters are output, without
+ * looking at the merge functions: only for code compiled without any
+ * other counter kinds (such as of -fprofile-values, or the condition
+ * counters of -fcondition-coverage), else use the default.
+ * The condition counters (GCC 14 and later, 9 kinds) are a pair of
+ * bitmasks per condition expression, output as two counters like any
+ * other kind, in the record of GCOV_COUNTER_CONDITIONS.
+ */
+template <unsigned Counters, bool ArcsOnly = false>
+struct GccLayout {
+    static constexpr unsigned counters = Counters;
+    static constexpr bool arcs_only = ArcsOnly;
+
+    struct ctr_info {
+        gcov_unsigned_t num;
+        gcov_type *values;
+    };
+
+    struct fn_info {
+        const void *key;
+        gcov_unsigned_t ident;
+        gcov_unsigned_t lineno_checksum;
+        gcov_unsigned_t cfg_checksum;
+        ctr_info ctrs[1];
+    };
+
+    struct info {
+        gcov_unsigned_t version;
+        info *next;
+        gcov_unsigned_t stamp;
+        gcov_unsigned_t checksum;
+        const char *filename;
+        void (*merge[Counters])(gcov_type *, gcov_unsigned_t);
+        unsigned n_functions;
+        fn_info **functions;
+    };
+};
+
+/* Layout for the compiler in use, as GCOV_COUNTERS in gcov_gcc.h */
+#if (__GNUC__ >= 14)
+using DefaultLayout = GccLayout<9>;
+#elif (__GNUC__ >= 10 && __GNUC__ < 14)
+using DefaultLayout = GccLayout<8>;
+#elif (__GNUC__ >= 5) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+using DefaultLayout = GccLayout<9>;
+#else
+using DefaultLayout = GccLayout<8>;
+#endif
+
+/* Records, as in gcov_gcc.h */
+constexpr gcov_unsigned_t data_magic = 0x67636461;
+constexpr gcov_unsigned_t tag_function = 0x01000000;
+constexpr gcov_unsigned_t tag_function_length = 3 * 4;
+constexpr gcov_unsigned_t tag_counter_base = 0x01a10000;
+
+constexpr gcov_unsigned_t tag_for_counter(unsigned kind)
+{
+    return tag_counter_base + (static_cast<gcov_unsigned_t>(kind) << 17);
+}
+
+constexpr gcov_unsigned_t counter_length(gcov_unsigned_t num)
+{
+    return num * 2 * 4;
+}
+
+static_assert(tag_for_counter(GCOV_COUNTER_ARCS) == 0x01a10000, "arc counter tag");
+static_assert(tag_for_counter(GCOV_COUNTER_CONDITIONS) == 0x01b10000, "condition counter tag");
+static_assert(GccLayout<9>::counters > GCOV_COUNTER_CONDITIONS, "room for the condition counters");
+
+/* Stores the words into a buffer (32-bit aligned, big enough) */
+struct BufferSink {
+    gcov_unsigned_t *at;
+
+    void word(gcov_unsigned_t w) { *at++ = w; }
+};
+
+/* Counts the bytes only */
+struct CountSink {
+    std::size_t bytes = 0;
+
+    void word(gcov_unsigned_t) { bytes += sizeof(gcov_unsigned_t); }
+};
+
+namespace detail {
+
+template <class Sink, class = void>
+struct has_begin : std::false_type {};
+template <class Sink>
+struct has_begin<Sink, std::void_t<decltype(std::declval<Sink &>().begin(static_cast<const char *>(nullptr),
+                                                                         std::size_t()))>>
+    : std::true_type {};
+
+template <class Sink, class = void>
+struct has_end : std::false_type {};
+template <class Sink>
+struct has_end<Sink, std::void_t<decltype(std::declval<Sink &>().end())>> : std::true_type {};
+
+}  // namespace detail
+
+template <class Sink, class Layout = DefaultLayout>
+class Serializer {
+    using info_t = typename Layout::info;
+    using fn_t = typename Layout::fn_info;
+    using ctr_t = typename Layout::ctr_info;
+
+    static const info_t *layout_of(const struct gcov_info *info)
+    {
+        return reinterpret_cast<const info_t *>(info);
+    }
+
+    static void counters(Sink &sink, unsigned kind, const ctr_t *ctr)
+    {
+        sink.word(tag_for_counter(kind));
+        sink.word(counter_length(ctr->num));
+        for (gcov_unsigned_t i = 0; i < ctr->num; i++) {
+            unsigned long long v = static_cast<unsigned long long>(ctr->values[i]);
+
+            sink.word(static_cast<gcov_unsigned_t>(v & 0xffffffffUL));
+            sink.word(static_cast<gcov_unsigned_t>(v >> 32));
+        }
+    }
+
+public:
+    /* Bytes of the .gcda data of a gcov_info, as gcov_convert_to_gcda(NULL, info) */
+    static std::size_t size(const struct gcov_info *gi)
+    {
+        const info_t *info = layout_of(gi);
+        std::size_t bytes = 4 * 4;
+
+        for (unsigned f = 0; f < info->n_functions; f++) {
+            const ctr_t *ctr = info->functions[f]->ctrs;
+
+            bytes += 2 * 4 + tag_function_length;
+            if constexpr (Layout::arcs_only) {
+                bytes += 2 * 4 + counter_length(ctr->num);
+            } else {
+                for (unsigned k = 0; k < Layout::counters; k++) {
+                    if (info->merge[k]) {
+                        bytes += 2 * 4 + counter_length(ctr->num);
+                        ctr++;
+                    }
+                }
+            }
+        }
+        return bytes;
+    }
+
+    /* Write the .gcda data of a gcov_info, as gcov_convert_to_gcda(buffer, info) stores it */
+    static void write(const struct gcov_info *gi, Sink &sink)
+    {
+        const info_t *info = layout_of(gi);
+
+        if constexpr (detail::has_begin<Sink>::value) {
+            sink.begin(info->filename, size(gi));
+        }
+
+        sink.word(data_magic);
+        sink.word(info->version);
+        sink.word(info->stamp);
+        sink.word(info->checksum);
+
+        for (unsigned f = 0; f < info->n_functions; f++) {
+            const fn_t *fn = info->functions[f];
+            const ctr_t *ctr = fn->ctrs;
+
+            sink.word(tag_function);
+            sink.word(tag_function_length);
+            sink.word(fn->ident);
+            sink.word(fn->lineno_checksum);
+            sink.word(fn->cfg_checksum);
+
+            if constexpr (Layout::arcs_only) {
+                counters(sink, GCOV_COUNTER_ARCS, ctr);
+            } else {
+                for (unsigned k = 0; k < Layout::counters; k++) {
+                    if (info->merge[k]) {
+                        counters(sink, k, ctr);
+                        ctr++;
+                    }
+                }
+            }
+        }
+
+        if constexpr (detail::has_end<Sink>::value) {
+            sink.end();
+        }
+    }
+
+#ifdef GCOV_OPT_PROVIDE_INFO_LIST
+    /* Write the .gcda data of each registered gcov_info, as __gcov_exit() does */
+    static void write_all(Sink &sink)
+    {
+        for (const struct gcov_info *gi = __gcov_info_next(nullptr); gi; gi = __gcov_info_next(gi)) {
+            write(gi, sink);
+        }
+    }
+#endif // GCOV_OPT_PROVIDE_INFO_LIST
+};
+
+}  // namespace gcov
+
+#endif /* GCOV_SERIALIZER_HPP */
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_serializer.hpp optional C++ serializer
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,154 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host benchmark of gcov_serializer.hpp against gcov_convert_to_gcda().
+ *
+ * Runs example/workload.c (built twice, as workload and workload_b),
+ * then for each registered gcov_info converts it both ways into
+ * a buffer, some number of times, and prints the fastest of each,
+ * in ns and cycles per byte (cycles from the time stamp counter,
+ * 0 where there is none), and whether the bytes are the same.
+ * Built by scripts/bench_serializer.sh, with GCOV_OPT_PROVIDE_INFO_LIST.
+ *
+ * Typical usage:
+ *   ./bench_serializer 200
+ *
+ * Arguments:
+ *   reps     conversions of each file each way (default 200)
+ *
+ * Exits with 1 if any file is not the same both ways.
+ *
+ **********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "gcov_serializer.hpp"
+extern "C" {
+#include "gcov_gcc.h"
+}
+
+extern "C" int workload(int rounds);
+extern "C" int workload_b(int rounds);
+
+/* Time stamp counter, or 0 where there is none */
+static unsigned long long bench_cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static long long bench_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Fastest of reps calls of convert, in ns and cycles */
+template <class Convert>
+static void best_of(int reps, Convert convert, long long &best_ns, unsigned long long &best_cycles)
+{
+    best_ns = -1;
+    best_cycles = 0;
+    for (int r = 0; r < reps; r++) {
+        long long ns = bench_ns();
+        unsigned long long cycles = bench_cycles();
+
+        convert();
+        cycles = bench_cycles() - cycles;
+        ns = bench_ns() - ns;
+        if (best_ns < 0 || ns < best_ns) {
+            best_ns = ns;
+            best_cycles = cycles;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int reps = (argc > 1) ? atoi(argv[1]) : 200;
+    int same = 1;
+
+    workload(3);
+    workload_b(5);
+
+    printf("%-20s %8s %12s %12s %12s %12s %8s\n", "file", "bytes", "convert ns", "cycles/byte",
+           "template ns", "cycles/byte", "same");
+    for (struct gcov_info *info = __gcov_info_next(nullptr); info; info = __gcov_info_next(info)) {
+        size_t bytes = gcov_convert_to_gcda(nullptr, info);
+        std::vector<gcov_unsigned_t> converted(bytes / 4 + 1);
+        std::vector<gcov_unsigned_t> serialized(bytes / 4 + 1);
+        long long convert_ns, template_ns;
+        unsigned long long convert_cycles, template_cycles;
+        const char *name = std::strrchr(gcov_info_filename(info), '/');
+        int file_same;
+
+        if (gcov::Serializer<gcov::CountSink>::size(info) != bytes) {
+            same = 0;
+        }
+        best_of(reps, [&] { gcov_convert_to_gcda(converted.data(), info); }, convert_ns, convert_cycles);
+        best_of(reps, [&] {
+            gcov::BufferSink sink{serialized.data()};
+            gcov::Serializer<gcov::BufferSink>::write(info, sink);
+        }, template_ns, template_cycles);
+        file_same = (std::memcmp(converted.data(), serialized.data(), bytes) == 0);
+        same = same && file_same;
+
+        printf("%-20s %8zu %12lld %12.2f %12lld %12.2f %8s\n", name ? name + 1 : "?", bytes,
+               convert_ns, (double)convert_cycles / bytes, template_ns, (double)template_cycles / bytes,
+               file_same ? "yes" : "NO");
+    }
+
+    /* not dumped again at exit */
+    fflush(stdout);
+    _exit(same ? 0 : 1);
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov bench_serializer.cpp host benchmark of the C++ serializer
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
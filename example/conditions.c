@@ -0,0 +1,141 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host stand-in with condition counters, for scripts/check_stream.sh.
+ *
+ * Registers a made-up gcov_info, as GCC 14 lays it out for code built
+ * with -fcondition-coverage (GCOV_COUNTERS 9, with arc counters and
+ * the condition counters of kind 8), and dumps it with __gcov_exit(),
+ * so that GCOV_OPT_PACK_CONDITIONS can be checked with any compiler.
+ * The condition counters take the values that are hard to pack:
+ * zeros, the edges of each LEB128 length, and values of 2^56 and more,
+ * which take 9 or 10 bytes instead of 8, in one function all of them,
+ * so that the packed file is bigger than the unpacked one.
+ * Not itself compiled with -fprofile-arcs, and the gcov code it is
+ * linked with must be built with GCOV_COUNTERS 9 too.
+ *
+ * Typical usage (see scripts/check_stream.sh):
+ *   ./conditions
+ *
+ **********************************************************************/
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "gcov_public.h"
+
+#define CONDITIONS_COUNTERS 9
+#define CONDITIONS_FUNCTIONS 3
+
+/* As in gcov_gcc.c, but with room for the two counter kinds used */
+struct gcov_ctr_info {
+    gcov_unsigned_t num;
+    gcov_type *values;
+};
+
+struct gcov_fn_info {
+    const struct gcov_info *key;
+    gcov_unsigned_t ident;
+    gcov_unsigned_t lineno_checksum;
+    gcov_unsigned_t cfg_checksum;
+    struct gcov_ctr_info ctrs[2];
+};
+
+struct gcov_info {
+    gcov_unsigned_t version;
+    struct gcov_info *next;
+    gcov_unsigned_t stamp;
+    gcov_unsigned_t checksum;
+    const char *filename;
+    void (*merge[CONDITIONS_COUNTERS])(gcov_type *, gcov_unsigned_t);
+    unsigned n_functions;
+    struct gcov_fn_info **functions;
+};
+
+#define BIG(n) ((gcov_type)(~0ULL >> (n)))
+
+static gcov_type arcs0[] = { 1, 5, 0, 12, 7, 0 };
+static gcov_type conditions0[] = {
+    0, 0, 1, 0, 0x7f, 0x80, 0x3fff, 0x4000,
+    (gcov_type)(1ULL << 56) - 1, (gcov_type)(1ULL << 56), (gcov_type)((1ULL << 63) - 1), (gcov_type)(1ULL << 63),
+    BIG(0), 0, 3, 2,
+};
+static gcov_type arcs1[] = { 3, 0, 0, 1 };
+static gcov_type conditions1[64];   // 9 and 10 byte values, set in main
+static gcov_type arcs2[] = { 0, 0 };
+static gcov_type conditions2[] = { 0, 0, 0, 0 };
+
+static struct gcov_fn_info fn[CONDITIONS_FUNCTIONS] = {
+    { NULL, 0x10000001, 0x2a2a0001, 0x5a5a0001,
+      { { sizeof(arcs0) / sizeof(arcs0[0]), arcs0 }, { sizeof(conditions0) / sizeof(conditions0[0]), conditions0 } } },
+    { NULL, 0x10000002, 0x2a2a0002, 0x5a5a0002,
+      { { sizeof(arcs1) / sizeof(arcs1[0]), arcs1 }, { sizeof(conditions1) / sizeof(conditions1[0]), conditions1 } } },
+    { NULL, 0x10000003, 0x2a2a0003, 0x5a5a0003,
+      { { sizeof(arcs2) / sizeof(arcs2[0]), arcs2 }, { sizeof(conditions2) / sizeof(conditions2[0]), conditions2 } } },
+};
+
+static struct gcov_fn_info *functions[CONDITIONS_FUNCTIONS] = { &fn[0], &fn[1], &fn[2] };
+
+static struct gcov_info info = {
+    0x4234302a, // a GCC 14 version word
+    NULL,
+    0x12345678,
+    0x9abcdef0,
+    "/tmp/conditions.gcda",
+    { __gcov_merge_add, NULL, NULL, NULL, NULL, NULL, NULL, NULL, __gcov_merge_ior },
+    CONDITIONS_FUNCTIONS,
+    functions,
+};
+
+int main(void)
+{
+    for (unsigned i = 0; i < sizeof(conditions1) / sizeof(conditions1[0]); i++) {
+        conditions1[i] = BIG(i % 2);
+    }
+    for (unsigned i = 0; i < CONDITIONS_FUNCTIONS; i++) {
+        fn[i].key = &info;
+    }
+
+    __gcov_init(&info);
+    __gcov_exit();
+
+    fflush(stdout);
+    _exit(0);
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov conditions.c host stand-in with condition counters
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
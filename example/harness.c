@@ -0,0 +1,208 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host stand-in for a target, for the check scripts in scripts/.
+ *
+ * Runs example/workload.c (built twice, as workload and workload_b),
+ * then dumps the coverage with __gcov_exit(),
+ * through the gcov code as built by the script, with the options
+ * the script selects in its copy of gcov_public.h.
+ * The workload is run again (for a given number of rounds)
+ * before each dump after the first, so that later dumps differ.
+ *
+ * Typical usage (see scripts/check_chunked.sh and scripts/bench_output.sh):
+ *   ./harness 2 1 < acks.fifo | lossy_link | gcov_receive -a acks.fifo -
+ *   ./harness 50 0 1 > /dev/null
+ *
+ * Arguments:
+ *   dumps    count of dumps (default 1)
+ *   rounds   rounds of the workload before each dump after the first
+ *            (default 0)
+ *   timing   if nonzero, time each dump and print the fastest to stderr,
+ *            "Harness best <ns> ns <cycles> cycles", with cycles
+ *            from the time stamp counter (0 where there is none)
+ *
+ * With GCOV_OPT_OUTPUT_SERIAL_CHUNKED, the "Gcov Ack" lines of the host
+ * are read from stdin by GCOV_CHUNK_POLL (defined as harness_poll()).
+ * With GCOV_OPT_OUTPUT_DMA, each buffer is "transmitted" by
+ * GCOV_DMA_START (defined as harness_dma()) to the file dma.bin,
+ * which is started over for each dump.
+ * With GCOV_OPT_FLASH_SIMULATOR, gcov_flash_sim is saved at the end
+ * to the file flash.img, a flash image for tools/gcov_unpack -f.
+ *
+ **********************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "gcov_public.h"
+
+int workload(int rounds);
+int workload_b(int rounds);
+
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+/* Pass the "Gcov Ack" lines waiting on stdin to __gcov_transfer_ack */
+void harness_poll(void)
+{
+    static char line[128];
+    static size_t len = 0;
+    char c;
+
+    while (read(0, &c, 1) == 1) {
+        if (c == '\n') {
+            unsigned entry, offset;
+
+            line[len] = '\0';
+            if (sscanf(line, "Gcov Ack %u %u", &entry, &offset) == 2) {
+                __gcov_transfer_ack(entry, offset);
+            }
+            len = 0;
+        } else if (len < sizeof(line) - 1) {
+            line[len++] = c;
+        }
+    }
+    usleep(10);
+}
+#endif // GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+
+/* Time stamp counter, or 0 where there is none */
+static unsigned long long harness_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static long long harness_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+#ifdef GCOV_OPT_OUTPUT_DMA
+static FILE *dma = NULL;
+
+/* Append a buffer to dma.bin, as the link would carry it, and complete */
+void harness_dma(const void *data, unsigned len)
+{
+    if (!dma) {
+        dma = fopen("dma.bin", "wb");
+    }
+    if (!dma || fwrite(data, 1, len, dma) != len || fflush(dma) != 0) {
+        perror("dma.bin");
+        _exit(1);
+    }
+    __gcov_dma_complete();
+}
+#endif // GCOV_OPT_OUTPUT_DMA
+
+int main(int argc, char *argv[])
+{
+    int dumps = (argc > 1) ? atoi(argv[1]) : 1;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 0;
+    int timing = (argc > 3) ? atoi(argv[3]) : 0;
+    long long best_ns = -1;
+    unsigned long long best_cycles = 0;
+
+    /* each line out at once, as on a serial port */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+#ifdef GCOV_OPT_OUTPUT_SERIAL_CHUNKED
+    (void)fcntl(0, F_SETFL, fcntl(0, F_GETFL) | O_NONBLOCK);
+#endif
+
+    workload(3);
+    workload_b(5);
+    for (int d = 0; d < dumps; d++) {
+        /* not even called for no rounds, so the coverage is unchanged */
+        if (d > 0 && rounds > 0) {
+            workload(rounds);
+            workload_b(rounds * 2);
+        }
+#ifdef GCOV_OPT_OUTPUT_DMA
+        if (dma) {
+            fclose(dma);
+            dma = NULL;
+        }
+#endif
+        if (timing) {
+            long long ns = harness_ns();
+            unsigned long long cycles = harness_cycles();
+
+            __gcov_exit();
+            cycles = harness_cycles() - cycles;
+            ns = harness_ns() - ns;
+            if (best_ns < 0 || ns < best_ns) {
+                best_ns = ns;
+                best_cycles = cycles;
+            }
+        } else {
+            __gcov_exit();
+        }
+    }
+    if (timing) {
+        fprintf(stderr, "Harness best %lld ns %llu cycles\n", best_ns, best_cycles);
+    }
+
+#if defined(GCOV_OPT_OUTPUT_FLASH) && defined(GCOV_OPT_FLASH_SIMULATOR)
+    {
+        FILE *img = fopen("flash.img", "wb");
+
+        if (!img || fwrite(gcov_flash_sim, 1, sizeof(gcov_flash_sim), img) != sizeof(gcov_flash_sim) ||
+            fclose(img) != 0) {
+            perror("flash.img");
+            _exit(1);
+        }
+    }
+#endif
+
+    /* not again for each file at exit */
+    fflush(stdout);
+    _exit(0);
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov harness.c host stand-in for a target, for the check scripts
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
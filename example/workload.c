@@ -0,0 +1,106 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Coverage workload for example/harness.c.
+ *
+ * 256 small functions, each with a loop and a few branches,
+ * made by macros so that there is enough coverage data
+ * (some tens of kilobytes) to check and time the outputs with,
+ * and counts that vary from function to function
+ * (some functions are never called, so have zero counters).
+ * Compiled with -fprofile-arcs, unlike the gcov code,
+ * and twice, the second time with -DWORKLOAD=workload_b,
+ * for two files of coverage data.
+ *
+ **********************************************************************/
+
+#define WORK(n) \
+static int work##n(int x) \
+{ \
+    int s = 0; \
+    for (int i = 0; i < (x + n) % 13; i++) { \
+        if ((i ^ n) & 1) { s += i; } else { s -= x; } \
+        if (i % (n % 5 + 2) == 0) { s ^= n; } \
+    } \
+    return (x > n % 17) ? s * 3 : s; \
+}
+#define WORK4(n) WORK(n##1) WORK(n##2) WORK(n##3) WORK(n##4)
+#define WORK16(n) WORK4(n##1) WORK4(n##2) WORK4(n##3) WORK4(n##4)
+#define WORK64(n) WORK16(n##1) WORK16(n##2) WORK16(n##3) WORK16(n##4)
+
+WORK64(1)
+WORK64(2)
+WORK64(3)
+WORK64(4)
+
+#define NAME(n) work##n,
+#define NAME4(n) NAME(n##1) NAME(n##2) NAME(n##3) NAME(n##4)
+#define NAME16(n) NAME4(n##1) NAME4(n##2) NAME4(n##3) NAME4(n##4)
+#define NAME64(n) NAME16(n##1) NAME16(n##2) NAME16(n##3) NAME16(n##4)
+
+static int (*const work[])(int) = {
+    NAME64(1)
+    NAME64(2)
+    NAME64(3)
+    NAME64(4)
+};
+
+#ifndef WORKLOAD
+#define WORKLOAD workload
+#endif
+
+/* Call the functions for some rounds, each a varying number of times */
+int WORKLOAD(int rounds)
+{
+    int s = 0;
+
+    for (int r = 0; r < rounds; r++) {
+        for (int f = 0; f < (int)(sizeof(work) / sizeof(work[0])); f++) {
+            if ((f * 7 + r) % 5 == 0 || f % 11 == 3) {
+                continue;
+            }
+            for (int k = 0; k < f % 4 + 1; k++) {
+                s += work[f](r * 7 + f + k);
+            }
+        }
+    }
+
+    return s;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov workload.c coverage workload for the check and benchmark scripts
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
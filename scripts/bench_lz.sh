@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Typical usage: ./bench_lz.sh [dumps]
+
+# Measures GCOV_OPT_COMPRESS_LZ on a whole dump (__gcov_exit) of
+# example/workload.c on the host, through GCOV_OPT_OUTPUT_BINARY_MMAP
+# (the stream outputs all compress the same way):
+# the compression ratio, and the time and cycles per byte of the
+# uncompressed data, with and without compression (the fastest of some
+# dumps, default 20, each), and checks that the compressed output
+# unpacks with tools/gcov_unpack to the same .gcda files, byte for byte.
+
+. ./check_build.sh
+check_setup
+
+dumps=${1:-20}
+
+check_harness plain GCOV_OPT_OUTPUT_BINARY_MMAP -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP -GCOV_OPT_PRINT_STATUS
+check_harness lz GCOV_OPT_OUTPUT_BINARY_MMAP -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP -GCOV_OPT_PRINT_STATUS \
+	GCOV_OPT_COMPRESS_LZ
+
+for output in plain lz
+do
+	(cd "$work/$output" && ./harness $dumps 0 1 2> harness.log > /dev/null) || exit 1
+	mkdir -p "$work/$output/gcda"
+	"$work/gcov_unpack" -o "$work/$output/gcda" "$work/$output/gcov_output.bin" > /dev/null || exit 1
+done
+
+# per byte of the uncompressed data, for both
+raw=$(stat -c %s "$work/plain/gcov_output.bin")
+printf "%-12s %10s %8s %12s %10s %12s\n" output bytes ratio "best ns" "ns/byte" "cycles/byte"
+for output in plain lz
+do
+	bytes=$(stat -c %s "$work/$output/gcov_output.bin")
+	awk -v output=$output -v bytes=$bytes -v raw=$raw \
+		'/^Harness best/ { printf "%-12s %10d %8.2f %12d %10.2f %12.2f\n", output, bytes, raw / bytes, $3, $3 / raw, $5 / raw }' \
+		"$work/$output/harness.log"
+done
+awk '/^Harness best/ { ns[FILENAME ~ /\/lz\/harness.log$/] = $3; cycles[FILENAME ~ /\/lz\/harness.log$/] = $5 }
+	END { printf "compression %.2f ns/byte %.2f cycles/byte\n", (ns[1] - ns[0]) / raw, (cycles[1] - cycles[0]) / raw }' \
+	raw=$raw "$work/plain/harness.log" "$work/lz/harness.log"
+
+fail=0
+for ref in "$work/plain/gcda"/*.gcda
+do
+	cmp "$ref" "$work/lz/gcda/$(basename "$ref")" || fail=1
+done
+if [ $fail -ne 0 ]
+then
+	echo "bench_lz: compressed output does not unpack the same"
+	exit 1
+fi
+echo "bench_lz: compressed output unpacks the same"
+
+# embedded-gcov bench_lz.sh script to measure the LZ compression
+#
+# Copyright (c) 2021 California Institute of Technology (“Caltech”).
+# U.S. Government sponsorship acknowledged.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#    Redistributions of source code must retain the above copyright notice,
+#        this list of conditions and the following disclaimer.
+#    Redistributions in binary form must reproduce the above copyright notice,
+#        this list of conditions and the following disclaimer in the documentation
+#        and/or other materials provided with the distribution.
+#    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+#        nor the names of its contributors may be used to endorse or promote products
+#        derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
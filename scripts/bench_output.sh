@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# Typical usage: ./bench_output.sh [dumps]
+
+# Times a whole dump (__gcov_exit) of example/workload.c on the host,
+# written to gcov_output.bin by GCOV_OPT_OUTPUT_BINARY_FILE
+# (one write call per byte, as in gcov_public.h) and by
+# GCOV_OPT_OUTPUT_BINARY_MMAP (converted into a memory mapping),
+# the fastest of some dumps (default 20) each, and checks that both
+# write the same file, byte for byte.
+
+. ./check_build.sh
+check_setup
+
+dumps=${1:-20}
+
+check_harness file GCOV_OPT_OUTPUT_BINARY_FILE -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP -GCOV_OPT_PRINT_STATUS
+check_harness mmap GCOV_OPT_OUTPUT_BINARY_MMAP -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP -GCOV_OPT_PRINT_STATUS
+
+printf "%-12s %10s %12s %10s %12s\n" output bytes "best ns" "ns/byte" "cycles/byte"
+for output in file mmap
+do
+	best=$(cd "$work/$output" && ./harness $dumps 0 1 2>&1 > /dev/null) || exit 1
+	bytes=$(stat -c %s "$work/$output/gcov_output.bin")
+	echo "$best" | awk -v output=$output -v bytes=$bytes \
+		'/^Harness best/ { printf "%-12s %10d %12d %10.2f %12.2f\n", output, bytes, $3, $3 / bytes, $5 / bytes }'
+done
+
+if ! cmp "$work/file/gcov_output.bin" "$work/mmap/gcov_output.bin"
+then
+	echo "bench_output: outputs differ"
+	exit 1
+fi
+echo "bench_output: outputs the same"
+
+# embedded-gcov bench_output.sh script to time the binary file outputs
+#
+# Copyright (c) 2021 California Institute of Technology (“Caltech”).
+# U.S. Government sponsorship acknowledged.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#    Redistributions of source code must retain the above copyright notice,
+#        this list of conditions and the following disclaimer.
+#    Redistributions in binary form must reproduce the above copyright notice,
+#        this list of conditions and the following disclaimer in the documentation
+#        and/or other materials provided with the distribution.
+#    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+#        nor the names of its contributors may be used to endorse or promote products
+#        derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# Typical usage: ./bench_serializer.sh [reps]
+
+# Times gcov::Serializer<BufferSink>::write (code/gcov_serializer.hpp)
+# against gcov_convert_to_gcda() on the coverage data of example/workload.c,
+# the fastest of some conversions (default 200) of each file each way,
+# and checks that both give the same bytes (see example/bench_serializer.cpp).
+
+. ./check_build.sh
+check_setup
+
+check_code serializer GCOV_OPT_PROVIDE_INFO_LIST -GCOV_OPT_PRINT_STATUS
+dir="$work/serializer"
+for source in gcov_public gcov_gcc gcov_printf
+do
+	gcc -Wall -O2 -I"$dir" -c -o "$dir/$source.o" "$dir/$source.c" || exit 1
+done
+g++ -Wall -O2 -std=c++17 -I"$dir" -o "$dir/bench_serializer" ../example/bench_serializer.cpp \
+	"$dir/gcov_public.o" "$dir/gcov_gcc.o" "$dir/gcov_printf.o" \
+	"$work/workload.o" "$work/workload_b.o" || exit 1
+
+if ! (cd "$dir" && ./bench_serializer ${1:-200})
+then
+	echo "bench_serializer: outputs differ"
+	exit 1
+fi
+echo "bench_serializer: outputs the same"
+
+# embedded-gcov bench_serializer.sh script to time the C++ serializer
+#
+# Copyright (c) 2021 California Institute of Technology (“Caltech”).
+# U.S. Government sponsorship acknowledged.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#    Redistributions of source code must retain the above copyright notice,
+#        this list of conditions and the following disclaimer.
+#    Redistributions in binary form must reproduce the above copyright notice,
+#        this list of conditions and the following disclaimer in the documentation
+#        and/or other materials provided with the distribution.
+#    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+#        nor the names of its contributors may be used to endorse or promote products
+#        derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
@@ -0,0 +1,103 @@
+#!/bin/bash
+
+# Typical usage (from another script in this directory):
+#   . ./check_build.sh
+#   check_setup
+#   check_harness ref GCOV_OPT_OUTPUT_BINARY_FILE -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP
+#   (cd "$work/ref" && ./harness 2 1)
+
+# Shared by the check and benchmark scripts: builds example/harness.c
+# against a copy of ../code with some options changed in its gcov_public.h,
+# so that each output can be run on the host as if on a target.
+# The workload is compiled (instrumented) only once, by check_setup,
+# as each compile gives the coverage data a new stamp,
+# so that the output of different builds can be compared byte for byte.
+
+# Make a work directory (removed on exit), build the host tools
+# that the scripts use into it, and compile the workload
+check_setup() {
+	work=$(mktemp -d) || exit 1
+	trap 'rm -rf "$work"' EXIT
+	gcc -Wall -O2 -o "$work/gcov_receive" ../tools/gcov_receive.c || exit 1
+	gcc -Wall -O2 -o "$work/gcov_unpack" ../tools/gcov_unpack.c ../tools/gcov_host.c || exit 1
+	gcc -Wall -O1 -fprofile-arcs -c -o "$work/workload.o" ../example/workload.c || exit 1
+	gcc -Wall -O1 -fprofile-arcs -DWORKLOAD=workload_b -c -o "$work/workload_b.o" ../example/workload.c || exit 1
+}
+
+# Change one option in a gcov_public.h:
+#   NAME        define it (uncomment "//#define NAME")
+#   -NAME       do not define it (comment out "#define NAME")
+#   NAME=value  define it as value
+# Only the first definition of NAME is changed.
+check_option() {
+	local header=$1
+	local name=${2%%=*}
+	local value=
+
+	case "$2" in
+	-*)
+		name=${name#-}
+		sed -i "0,/^#define $name\( .*\)\?\$/s//\/\/#define $name/" "$header"
+		grep -q "^//#define $name\( .*\)\?\$" "$header" || { echo "check_option: no $name" >&2; exit 1; }
+		return
+		;;
+	*=*)
+		value=" ${2#*=}"
+		;;
+	esac
+	sed -i "0,/^\(\/\/\)\?#define $name\( .*\)\?\$/s//#define $name${value//\//\\/}/" "$header"
+	grep -q "^#define $name\( .*\)\?\$" "$header" || { echo "check_option: no $name" >&2; exit 1; }
+}
+
+# Copy the gcov code of ../code to $work/name, with these options
+check_code() {
+	local dir="$work/$1"
+	shift
+
+	mkdir -p "$dir" || exit 1
+	cp ../code/* "$dir" || exit 1
+	for option in "$@"
+	do
+		check_option "$dir/gcov_public.h" "$option"
+	done
+}
+
+# Build $work/name/harness, with the gcov code of ../code and these options
+check_harness() {
+	local dir="$work/$1"
+
+	check_code "$@"
+	gcc -Wall -O2 -I"$dir" -o "$dir/harness" ../example/harness.c \
+		"$dir/gcov_public.c" "$dir/gcov_gcc.c" "$dir/gcov_printf.c" \
+		"$work/workload.o" "$work/workload_b.o" || exit 1
+}
+
+# embedded-gcov check_build.sh script to build the host harness for the check scripts
+#
+# Copyright (c) 2021 California Institute of Technology (“Caltech”).
+# U.S. Government sponsorship acknowledged.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#    Redistributions of source code must retain the above copyright notice,
+#        this list of conditions and the following disclaimer.
+#    Redistributions in binary form must reproduce the above copyright notice,
+#        this list of conditions and the following disclaimer in the documentation
+#        and/or other materials provided with the distribution.
+#    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+#        nor the names of its contributors may be used to endorse or promote products
+#        derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
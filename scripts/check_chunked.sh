@@ -0,0 +1,175 @@
+#!/bin/bash
+
+# Typical usage: ./check_chunked.sh
+
+# Checks GCOV_OPT_OUTPUT_SERIAL_CHUNKED end to end, over a lossy link:
+# example/harness.c dumps twice, through an awk filter that drops and
+# garbles some of the "Gcov Chunk" lines, and cuts the link in the middle
+# of the second file of the first dump until the target gives up
+# ("Gcov Stalled"), into tools/gcov_receive, whose acknowledgments
+# go back to the harness through a fifo.
+# The second dump resumes the interrupted file if its data is unchanged
+# (rounds 0), or starts it over if it has changed (rounds 1),
+# and the received .gcda files must be the same, byte for byte,
+# as those of GCOV_OPT_OUTPUT_BINARY_FILE unpacked by tools/gcov_unpack:
+# the interrupted file as of the second dump, the others as of the first.
+# The chunks sent are counted too, and must be near the count with no loss:
+# at most 1.2 times it, besides the chunks lost in the outage
+# (and when started over, those sent of the file before it),
+# so that the 3% of chunks lost cost little more than sending them again.
+
+. ./check_build.sh
+check_setup
+
+check_harness ref GCOV_OPT_OUTPUT_BINARY_FILE -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP
+check_harness chunked GCOV_OPT_OUTPUT_SERIAL_CHUNKED -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP \
+	'GCOV_CHUNK_POLL()=do { extern void harness_poll(void); harness_poll(); } while (0)' \
+	GCOV_CHUNK_TIMEOUT=200
+
+# mawk reads its input a block at a time, unless told not to,
+# which would hold the lines back until the target times out
+interactive=
+if awk -W version 2>&1 | grep -q mawk
+then
+	interactive="-W interactive"
+fi
+
+# The lossy link, which also notes what it saw:
+# "stalled <filename>" for the interrupted file, and
+# "resumed <offset>" for where the target went on with it after the outage
+# (before any acknowledgment, so not as asked by gcov_receive),
+# "sent <count>" for all chunks, "lost <count>" for those in the outage,
+# and "before <count>" for those of the interrupted file before the outage
+lossy_link() {
+	awk $interactive -v notes="$1" '
+	BEGIN { srand(54); outage = 0; stalled = 0; resumed = -1 }
+	/Gcov Chunk / { sent++; if (outage) lost++ }
+	/Gcov Entry 1 / && !stalled { name = $NF }
+	/Gcov Chunk 1 / && !stalled && ++seen == 100 { outage = 1; before = seen - 1 }
+	/Gcov Stalled/ && outage { outage = 0; stalled = 1; print; fflush(); next }
+	outage { next }
+	/Gcov Chunk 1 / && stalled && resumed < 0 { resumed = $4 }
+	/Gcov Chunk / {
+		r = rand()
+		if (r < 0.02) next
+		if (r < 0.03) $0 = substr($0, 1, length($0) - 1) (substr($0, length($0)) == "0" ? "1" : "0")
+	}
+	{ print; fflush() }
+	END {
+		print "stalled " name > notes; print "resumed " resumed > notes
+		print "sent " sent > notes; print "lost " lost > notes; print "before " before > notes
+	}'
+}
+
+fail=0
+for rounds in 0 1
+do
+	# references as of the first and of the second dump
+	for dumps in 1 2
+	do
+		(cd "$work/ref" && ./harness $dumps $rounds > /dev/null) || exit 1
+		mkdir -p "$work/ref${dumps}_$rounds"
+		"$work/gcov_unpack" -o "$work/ref${dumps}_$rounds" "$work/ref/gcov_output.bin" > /dev/null || exit 1
+	done
+
+	out="$work/out_$rounds"
+	mkdir -p "$out"
+	rm -f "$work/acks"
+	mkfifo "$work/acks" || exit 1
+	"$work/chunked/harness" 2 $rounds < "$work/acks" \
+		| lossy_link "$work/notes_$rounds" \
+		| "$work/gcov_receive" -a "$work/acks" -o "$out" - > "$work/receive_$rounds.log" 2>&1
+	status=${PIPESTATUS[2]}
+
+	stalled=$(basename "$(awk '/^stalled/ { print $2 }' "$work/notes_$rounds")" .gcda).gcda
+	resumed=$(awk '/^resumed/ { print $2 }' "$work/notes_$rounds")
+	if [ $status -ne 0 ] || [ "$stalled" = ".gcda" ]
+	then
+		echo "rounds $rounds: transfer not complete (gcov_receive status $status)"
+		cat "$work/receive_$rounds.log"
+		fail=1
+		continue
+	fi
+	if [ $rounds -eq 0 ] && [ "$resumed" -le 0 ]
+	then
+		echo "rounds $rounds: unchanged $stalled was started over, not resumed"
+		fail=1
+	fi
+	if [ $rounds -ne 0 ] && [ "$resumed" -ne 0 ]
+	then
+		echo "rounds $rounds: changed $stalled was resumed, not started over"
+		fail=1
+	fi
+
+	# chunks of GCOV_CHUNK_BYTES (64) needed with no loss
+	needed=0
+	for ref in "$work/ref1_$rounds"/*.gcda
+	do
+		needed=$((needed + ($(stat -c %s "$ref") + 63) / 64))
+	done
+	sent=$(awk '/^sent/ { print $2 }' "$work/notes_$rounds")
+	allowed=$(awk '/^lost/ { print $2 }' "$work/notes_$rounds")
+	if [ $rounds -ne 0 ]
+	then
+		allowed=$((allowed + $(awk '/^before/ { print $2 }' "$work/notes_$rounds")))
+	fi
+	overhead=$(awk -v sent=$sent -v allowed=$allowed -v needed=$needed 'BEGIN { printf "%.2f", (sent - allowed) / needed }')
+	echo "rounds $rounds: sent $sent chunks, $allowed for the outage, $needed needed with no loss: ${overhead}x"
+	if awk -v overhead=$overhead 'BEGIN { exit !(overhead > 1.2) }'
+	then
+		echo "rounds $rounds: too many chunks sent again"
+		fail=1
+	fi
+
+	for ref in "$work/ref1_$rounds"/*.gcda
+	do
+		file=$(basename "$ref")
+		if [ "$file" = "$stalled" ]
+		then
+			ref="$work/ref2_$rounds/$file"
+		fi
+		if cmp "$ref" "$out/$file"
+		then
+			echo "rounds $rounds: $file OK"
+		else
+			fail=1
+		fi
+	done
+done
+
+if [ $fail -ne 0 ]
+then
+	echo "check_chunked: FAILED"
+	exit 1
+fi
+echo "check_chunked: OK"
+
+# embedded-gcov check_chunked.sh script to check chunked output over a lossy link
+#
+# Copyright (c) 2021 California Institute of Technology (“Caltech”).
+# U.S. Government sponsorship acknowledged.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#    Redistributions of source code must retain the above copyright notice,
+#        this list of conditions and the following disclaimer.
+#    Redistributions in binary form must reproduce the above copyright notice,
+#        this list of conditions and the following disclaimer in the documentation
+#        and/or other materials provided with the distribution.
+#    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+#        nor the names of its contributors may be used to endorse or promote products
+#        derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
@@ -0,0 +1,155 @@
+#!/bin/bash
+
+# Typical usage: ./check_stream.sh
+
+# Checks the streamed outputs end to end: example/harness.c dumps twice
+# through GCOV_OPT_OUTPUT_FLASH (into gcov_flash_sim, saved as a flash
+# image) and GCOV_OPT_OUTPUT_DMA (each buffer appended to a file,
+# as captured from the link), alone, combined, and with
+# GCOV_OPT_COMPRESS_LZ or GCOV_OPT_PACK_CONDITIONS, and the .gcda files
+# unpacked by tools/gcov_unpack (the newest flash dump, the last DMA dump)
+# must be the same, byte for byte, as those of GCOV_OPT_OUTPUT_BINARY_FILE.
+# Then the same for the made-up condition counters of example/conditions.c
+# (which the compiler in use may not have), packed by
+# GCOV_OPT_PACK_CONDITIONS through GCOV_OPT_OUTPUT_BINARY_MMAP,
+# with and without GCOV_OPT_COMPRESS_LZ.
+
+. ./check_build.sh
+check_setup
+
+flash="GCOV_OPT_OUTPUT_FLASH GCOV_OPT_FLASH_SIMULATOR"
+dma="GCOV_OPT_OUTPUT_DMA"
+dma_start='GCOV_DMA_START(data, len)=do { extern void harness_dma(const void *, unsigned); harness_dma((data), (len)); } while (0)'
+
+check_harness ref GCOV_OPT_OUTPUT_BINARY_FILE -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP
+(cd "$work/ref" && ./harness 2 1 > /dev/null) || exit 1
+mkdir -p "$work/ref/gcda"
+"$work/gcov_unpack" -o "$work/ref/gcda" "$work/ref/gcov_output.bin" > /dev/null || exit 1
+
+# Unpack one output of a variant and compare it with the reference
+check_output() {
+	local name=$1
+	local image=$2
+	shift 2
+
+	mkdir -p "$work/$name/$image.gcda"
+	if ! "$work/gcov_unpack" "$@" -o "$work/$name/$image.gcda" "$work/$name/$image" > /dev/null
+	then
+		echo "$name: $image does not unpack"
+		fail=1
+		return
+	fi
+	for ref in "$work/ref/gcda"/*.gcda
+	do
+		if cmp "$ref" "$work/$name/$image.gcda/$(basename "$ref")"
+		then
+			echo "$name: $image $(basename "$ref") OK"
+		else
+			fail=1
+		fi
+	done
+}
+
+fail=0
+for variant in flash flash_lz flash_pack dma dma_lz dma_flash dma_flash_pack
+do
+	options="-GCOV_OPT_OUTPUT_SERIAL_HEXDUMP"
+	case $variant in
+	*flash*) options="$options $flash" ;;
+	esac
+	case $variant in
+	*lz) options="$options GCOV_OPT_COMPRESS_LZ" ;;
+	*pack) options="$options GCOV_OPT_PACK_CONDITIONS" ;;
+	esac
+	case $variant in
+	dma*) check_harness $variant $options $dma "$dma_start" ;;
+	*) check_harness $variant $options ;;
+	esac
+	(cd "$work/$variant" && ./harness 2 1 > /dev/null) || exit 1
+	case $variant in
+	*flash*) check_output $variant flash.img -f ;;
+	esac
+	case $variant in
+	dma*) check_output $variant dma.bin ;;
+	esac
+done
+
+# Build $work/name/conditions, with GCOV_COUNTERS 9 as for GCC 14
+check_conditions() {
+	local dir="$work/$1"
+
+	check_code "$@"
+	sed -i 's/^#if (__GNUC__ >= 14)$/#if 1 \/\/ as GCC 14, for example\/conditions.c/' "$dir/gcov_gcc.h"
+	grep -q "^#if 1 // as GCC 14" "$dir/gcov_gcc.h" || { echo "check_stream: no GCOV_COUNTERS in gcov_gcc.h"; exit 1; }
+	gcc -Wall -O2 -I"$dir" -o "$dir/conditions" ../example/conditions.c \
+		"$dir/gcov_public.c" "$dir/gcov_gcc.c" "$dir/gcov_printf.c" || exit 1
+	(cd "$dir" && ./conditions > /dev/null) || exit 1
+}
+
+check_conditions cond_ref GCOV_OPT_OUTPUT_BINARY_FILE -GCOV_OPT_OUTPUT_SERIAL_HEXDUMP
+mkdir -p "$work/cond_ref/gcda"
+"$work/gcov_unpack" -o "$work/cond_ref/gcda" "$work/cond_ref/gcov_output.bin" > /dev/null || exit 1
+for variant in cond_pack cond_pack_lz
+do
+	options="-GCOV_OPT_OUTPUT_SERIAL_HEXDUMP GCOV_OPT_OUTPUT_BINARY_MMAP GCOV_OPT_PACK_CONDITIONS"
+	case $variant in
+	*lz) options="$options GCOV_OPT_COMPRESS_LZ" ;;
+	esac
+	check_conditions $variant $options
+	# the tag of a packed condition record, 0x01b10001 in target byte order
+	if [ $variant = cond_pack ] && ! LC_ALL=C grep -q -a -P '\x01\x00\xb1\x01|\x01\xb1\x00\x01' "$work/$variant/gcov_output.bin"
+	then
+		echo "$variant: no packed condition record"
+		fail=1
+	fi
+	mkdir -p "$work/$variant/gcda"
+	if ! "$work/gcov_unpack" -o "$work/$variant/gcda" "$work/$variant/gcov_output.bin" > /dev/null
+	then
+		echo "$variant: gcov_output.bin does not unpack"
+		fail=1
+		continue
+	fi
+	if cmp "$work/cond_ref/gcda/conditions.gcda" "$work/$variant/gcda/conditions.gcda"
+	then
+		echo "$variant: conditions.gcda OK"
+	else
+		fail=1
+	fi
+done
+
+if [ $fail -ne 0 ]
+then
+	echo "check_stream: FAILED"
+	exit 1
+fi
+echo "check_stream: OK"
+
+# embedded-gcov check_stream.sh script to check the flash and DMA outputs
+#
+# Copyright (c) 2021 California Institute of Technology (“Caltech”).
+# U.S. Government sponsorship acknowledged.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#    Redistributions of source code must retain the above copyright notice,
+#        this list of conditions and the following disclaimer.
+#    Redistributions in binary form must reproduce the above copyright notice,
+#        this list of conditions and the following disclaimer in the documentation
+#        and/or other materials provided with the distribution.
+#    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+#        nor the names of its contributors may be used to endorse or promote products
+#        derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
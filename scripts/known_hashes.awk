@@ -0,0 +1,110 @@
+# Typical usage: awk -f known_hashes.awk ../test01_serial_log.txt ../test02_serial_log.txt
+# or, to get gdb commands to fill the target table directly:
+#   awk -v gdb=1 -f known_hashes.awk ../test*_serial_log.txt > known_hashes.gdb
+
+# Lists the counter hashes (see GCOV_OPT_HASH_DEDUP in gcov_public.h)
+# of the files that the host already has from these serial logs,
+# for the reply to the target before its next __gcov_exit().
+# A hash is known if its "Gcov Hash" line was followed by
+# the complete output of that file, or if the target reported it
+# as "Gcov Unchanged".
+# If the logs contain a __gcov_emit_hashes() listing
+# (ended by "Gcov Hash End"), only the known hashes in the last listing
+# are printed, otherwise all known hashes are printed.
+
+{
+	sub(/\r$/, "");
+}
+
+/^Gcov Hash End/ {
+	# the hash lines just seen were a listing, not followed by output
+	nlist = 0;
+	for (i = 0; i < nblock; i++) {
+		list[nlist++] = block[i];
+	}
+	nblock = 0;
+	next;
+}
+
+/^Gcov Hash / && NF >= 5 {
+	block[nblock++] = $4;
+	pending[$5] = $4;
+	next;
+}
+
+/^Gcov Unchanged / && NF >= 5 {
+	known[$4] = 1;
+	next;
+}
+
+/Emit/ {
+	nblock = 0;
+	cur = $NF;
+	next;
+}
+
+/gcda/ {
+	# filename line at the end of the file output
+	if (cur != "" && $0 == cur && (cur in pending)) {
+		known[pending[cur]] = 1;
+	}
+	cur = "";
+	next;
+}
+
+END {
+	n = 0;
+	if (nlist > 0) {
+		for (i = 0; i < nlist; i++) {
+			if ((list[i] in known) && !(list[i] in done)) {
+				out[n++] = list[i];
+				done[list[i]] = 1;
+			}
+		}
+	} else {
+		for (h in known) {
+			out[n++] = h;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		if (gdb) {
+			printf("set var gcov_known_hashes[%d] = 0x%sULL\n", i, out[i]);
+		} else {
+			printf("0x%s\n", out[i]);
+		}
+	}
+	if (gdb) {
+		printf("set var gcov_known_hash_count = %d\n", n);
+	}
+}
+
+# embedded-gcov known_hashes.awk script to list gcov counter hashes the host already has
+#
+# Copyright (c) 2021 California Institute of Technology (“Caltech”).
+# U.S. Government sponsorship acknowledged.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#    Redistributions of source code must retain the above copyright notice,
+#        this list of conditions and the following disclaimer.
+#    Redistributions in binary form must reproduce the above copyright notice,
+#        this list of conditions and the following disclaimer in the documentation
+#        and/or other materials provided with the distribution.
+#    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+#        nor the names of its contributors may be used to endorse or promote products
+#        derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
@@ -1,5 +1,21 @@
 #!/bin/bash
 
+# Typical usage: ./lcov_baseline.sh
+
+# If tools/gcov_index is built, the baseline comes straight from
+# an index of the .gcno files (updated only if any has changed),
+# and is kept in ../results/ by the build ID of the .gcno files,
+# so for a build already seen this costs next to nothing,
+# and lcov_combine_new_base.sh can run this every time.
+# ../results/baseline.info is then a link to the baseline of this build.
+if [ -x ../tools/gcov_index ]
+then
+	../tools/gcov_index -o ../results/notes.gcidx ../objs/ > /dev/null || exit 1
+	baseline=$(../tools/gcov_index -i ../results/notes.gcidx -b ../results) || exit 1
+	ln -sf "$(basename "$baseline")" ../results/baseline.info
+	exit 0
+fi
+
 # NOTE: The --gcov-tool argument must specify a gcov executable
 # that goes with the compiler that build the program you are analyzing.
 # In most embedded sytems, that means a gcov version matching
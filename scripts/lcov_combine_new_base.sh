@@ -23,6 +23,13 @@ else
 	totlbl=_"$2"
 fi
 
+# Baseline of the current build, from its cache if already made
+# (or as left by lcov_baseline.sh, without tools/gcov_index)
+if [ -x ../tools/gcov_index ] || [ ! -e ../results/baseline.info ]
+then
+	./lcov_baseline.sh || exit 1
+fi
+
 lcov -a ../results/baseline.info \
 	-a ../results/newcov${newlbl}.info \
 	-o ../results/totcov${totlbl}.info
@@ -2,6 +2,9 @@
 	print;
 	init = 1;
 	tstr = "";
+	# "Emitting N bytes for ..." gives the expected size
+	want = $2;
+	have = 0;
 	next;
 }
 
@@ -16,6 +19,8 @@
 		next;
 	}
 	tstr = tstr""$0"\n";
+	# count data bytes after the address
+	have += NF - 1;
 	next;
 }
 
@@ -23,6 +28,13 @@
 	if (!init) { 
 		next;
 	}
+	if (have != want) {
+		# do not leave a partial file to be mistaken for a whole one
+		printf("Skipping %s: %d of %d bytes\n", $0, have, want) > "/dev/stderr";
+		init = 0;
+		tstr = "";
+		next;
+	}
 	# to create file at full path location
 	#print tstr > $0".xxd";
 
@@ -0,0 +1,662 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host service to merge gcov output of many targets as it arrives.
+ *
+ * Listens on a local Unix or TCP socket, and takes target output
+ * (in any form that gcov_ingest takes) from any number of producers
+ * at once: one connection per target, such as a serial capture per rig
+ * piped in with socat or nc, or tools/gcov_replay for a saved log.
+ * Each connection is decoded on a pool of threads, and each .gcda file
+ * is merged into the fleet coverage as soon as it is complete,
+ * counter by counter as libgcov would merge runs (see gcov_host.h),
+ * so the merged coverage is always current, at a cost per dump
+ * instead of the growing cost of chaining "lcov -a" over all results.
+ *
+ * The merged coverage is kept in memory, in shards by filename that are
+ * locked separately, so merges of different files never wait for
+ * each other, and snapshotted as .gcda files (only those changed since
+ * the last snapshot) into the output directory on request:
+ *   - periodically (-t),
+ *   - on SIGUSR1,
+ *   - on a "Gcov Snapshot" request (gcov_aggregate -s, which prints the reply),
+ *   - and on SIGINT or SIGTERM before it exits.
+ * After each snapshot, -e runs a command, such as lcov -c on the
+ * output directory for .info, as the .gcno files are needed for that.
+ * A snapshot of each file is consistent, but a dump being merged
+ * at that moment may be in some files of a snapshot and not yet others.
+ *
+ * Files salvaged from damaged output (see gcov_host.c) are merged too,
+ * as far as they go.
+ * All files merged must be of the same build (same stamp and records);
+ * a file of another build is rejected and reported, or with -R replaces
+ * the merged file, for when the fleet moves to a new build.
+ *
+ * Typical usage:
+ *   ./gcov_aggregate -l /tmp/gcov.sock -o ../objs -t 60 -e "lcov -q -c -d ../objs -o ../results/fleet.info"
+ *   socat -u /dev/ttyUSB0,raw,b115200 UNIX-CONNECT:/tmp/gcov.sock
+ *   ./gcov_replay /tmp/gcov.sock ../rig*_serial_log.txt
+ *   ./gcov_aggregate -s /tmp/gcov.sock
+ *
+ * Options:
+ *   -l addr  listen on a Unix socket path (anything with a '/'),
+ *            or on [host:]port for TCP (host 127.0.0.1 if not given)
+ *   -o dir   directory for the .gcda snapshots (default current directory),
+ *            files are named by the basename of the target filename
+ *   -j n     decoding threads (default 4)
+ *   -t secs  snapshot every secs seconds (if anything changed)
+ *   -e cmd   run cmd (by the shell) after each snapshot
+ *   -R       a file of a different build replaces the merged file
+ *   -s addr  ask the service at addr for a snapshot, and print its reply
+ *
+ **********************************************************************/
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+
+/* Shards of the merged coverage, and hash buckets in each */
+#define SHARDS 64
+#define BUCKETS 256
+
+/* Most connections (one per target) */
+#define MAX_CONNS 1024
+
+#define SNAPSHOT_REQUEST "Gcov Snapshot\n"
+
+/* ----------------------------------------------------------- */
+/* Merged coverage */
+
+typedef struct Entry {
+    struct Entry *next;
+    char *name;                 /* target filename */
+    unsigned char *data;        /* merged .gcda data */
+    size_t bytes;
+    unsigned long long merges;
+    int changed;                /* since the last snapshot */
+} Entry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    Entry *bucket[BUCKETS];
+} Shard;
+
+static Shard shards[SHARDS];
+static int replace_builds = 0;
+
+static unsigned name_hash(const char *name)
+{
+    unsigned h = 2166136261u; // FNV-1a
+
+    while (*name) {
+        h = (h ^ (unsigned char)*name++) * 16777619u;
+    }
+    return h;
+}
+
+/* Merge one file, returns NULL if merged, else why not */
+static const char *merge_file(const char *name, const unsigned char *data, size_t bytes)
+{
+    unsigned h = name_hash(name);
+    Shard *s = &shards[h % SHARDS];
+    Entry **link = &s->bucket[(h / SHARDS) % BUCKETS];
+    const char *why = gcov_gcda_check(data, bytes);
+    Entry *e;
+
+    if (why) {
+        return why;
+    }
+    pthread_mutex_lock(&s->lock);
+    for (e = *link; e; e = e->next) {
+        if (strcmp(e->name, name) == 0) {
+            break;
+        }
+    }
+    if (!e) {
+        e = calloc(1, sizeof(*e));
+        if (!e || !(e->name = strdup(name))) {
+            perror("calloc");
+            exit(1);
+        }
+        e->next = *link;
+        *link = e;
+    } else {
+        why = gcov_gcda_merge(e->data, e->bytes, data, bytes);
+        if (why && bytes > e->bytes) {
+            /* what was merged so far may be salvaged, and lack functions of this */
+            unsigned char *whole = malloc(bytes);
+
+            if (!whole) {
+                perror("malloc");
+                exit(1);
+            }
+            memcpy(whole, data, bytes);
+            if (!gcov_gcda_merge(whole, bytes, e->data, e->bytes)) {
+                free(e->data);
+                e->data = whole;
+                e->bytes = bytes;
+                why = NULL;
+            } else {
+                free(whole);
+            }
+        }
+    }
+    if (e->data && why && replace_builds) {
+        printf("Replacing %s: %s\n", name, why);
+        why = NULL;
+        free(e->data);
+        e->data = NULL;
+        e->merges = 0;
+    }
+    if (!e->data) {
+        e->data = malloc(bytes ? bytes : 1);
+        if (!e->data) {
+            perror("malloc");
+            exit(1);
+        }
+        memcpy(e->data, data, bytes);
+        e->bytes = bytes;
+    }
+    if (!why) {
+        e->merges++;
+        e->changed = 1;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return why;
+}
+
+/* ----------------------------------------------------------- */
+/* Snapshots */
+
+static const char *out_dir = ".";
+static const char *snapshot_cmd = NULL;
+static pthread_mutex_t snapshot_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Write the files changed since the last snapshot,
+ * copying each under its shard lock and writing it after.
+ * Puts a report line in reply, and prints it unless quiet and nothing changed.
+ */
+static void snapshot(char *reply, size_t reply_len, int quiet)
+{
+    unsigned files = 0, written = 0, failed = 0;
+    GcovBuf copy = { NULL, 0, 0 };
+    char path[4096];
+
+    pthread_mutex_lock(&snapshot_lock);
+    for (int i = 0; i < SHARDS; i++) {
+        Shard *s = &shards[i];
+
+        for (int b = 0; b < BUCKETS; b++) {
+            for (Entry *e = NULL; ; ) {
+                const char *base;
+
+                /* (the list may grow while unlocked, but only at its head) */
+                pthread_mutex_lock(&s->lock);
+                e = e ? e->next : s->bucket[b];
+                if (!e) {
+                    pthread_mutex_unlock(&s->lock);
+                    break;
+                }
+                files++;
+                if (!e->changed) {
+                    pthread_mutex_unlock(&s->lock);
+                    continue;
+                }
+                copy.len = 0;
+                gcov_buf_add(&copy, e->data, e->bytes);
+                e->changed = 0;
+                pthread_mutex_unlock(&s->lock);
+
+                base = strrchr(e->name, '/');
+                base = base ? base + 1 : e->name;
+                snprintf(path, sizeof(path), "%s/%s", out_dir, base);
+                if (gcov_write_whole(path, copy.data, copy.len) != 0) {
+                    fprintf(stderr, "gcov_aggregate: cannot write %s: %s\n", path, strerror(errno));
+                    pthread_mutex_lock(&s->lock);
+                    e->changed = 1; // try again next time
+                    pthread_mutex_unlock(&s->lock);
+                    failed++;
+                } else {
+                    written++;
+                }
+            }
+        }
+    }
+    free(copy.data);
+    if (written && snapshot_cmd && system(snapshot_cmd) != 0) {
+        fprintf(stderr, "gcov_aggregate: command failed: %s\n", snapshot_cmd);
+    }
+    pthread_mutex_unlock(&snapshot_lock);
+
+    snprintf(reply, reply_len, "Gcov Snapshot %u files, %u written, %u failed, in %s\n",
+             files, written, failed, out_dir);
+    if (!quiet || written || failed) {
+        fputs(reply, stdout);
+    }
+}
+
+/* ----------------------------------------------------------- */
+/* Connections, decoded by the worker threads */
+
+enum { UNKNOWN, DATA, CONTROL };
+
+typedef struct Conn {
+    struct Conn *next;          /* in the work queue */
+    int fd;
+    char label[64];
+    GcovDecoder *dec;
+    int kind;
+    GcovBuf head;               /* first bytes, until the kind is known */
+
+    /* shared with the I/O thread, under lock */
+    pthread_mutex_t lock;
+    GcovBuf pending;            /* read, not yet decoded */
+    int queued;                 /* in the work queue or with a worker */
+    int closed;                 /* no more to read */
+
+    /* for the worker only */
+    unsigned dumps, merged, salvaged, skipped, rejected;
+} Conn;
+
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static Conn *queue_head = NULL;
+static Conn *queue_tail = NULL;
+
+static void enqueue(Conn *c)
+{
+    pthread_mutex_lock(&queue_lock);
+    c->next = NULL;
+    if (queue_tail) {
+        queue_tail->next = c;
+    } else {
+        queue_head = c;
+    }
+    queue_tail = c;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+static Conn *dequeue(void)
+{
+    Conn *c;
+
+    pthread_mutex_lock(&queue_lock);
+    while (!queue_head) {
+        pthread_cond_wait(&queue_cond, &queue_lock);
+    }
+    c = queue_head;
+    queue_head = c->next;
+    if (!queue_head) {
+        queue_tail = NULL;
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return c;
+}
+
+static void on_file(void *ctx, const char *filename, const unsigned char *data, size_t bytes)
+{
+    Conn *c = ctx;
+    const char *why = merge_file(filename, data, bytes);
+
+    if (why) {
+        fprintf(stderr, "gcov_aggregate: %s: rejecting %s: %s\n", c->label, filename, why);
+        c->rejected++;
+    } else {
+        c->merged++;
+    }
+}
+
+static void on_salvaged(void *ctx, const char *filename, const unsigned char *data, size_t bytes,
+                        const char *lost)
+{
+    Conn *c = ctx;
+
+    fprintf(stderr, "gcov_aggregate: %s: salvaged %s: %s\n", c->label, filename, lost);
+    on_file(ctx, filename, data, bytes);
+    c->salvaged++;
+}
+
+static void on_skip(void *ctx, const char *filename, const char *why)
+{
+    Conn *c = ctx;
+
+    fprintf(stderr, "gcov_aggregate: %s: skipping %s: %s\n", c->label, filename, why);
+}
+
+static void on_end(void *ctx, unsigned written, unsigned salvaged, unsigned skipped)
+{
+    Conn *c = ctx;
+
+    c->dumps++;
+    c->skipped += skipped;
+    printf("%s: gcov dump %s: %u files, %u salvaged, %u skipped\n", c->label,
+           (salvaged || skipped) ? "incomplete" : "complete", written, salvaged, skipped);
+}
+
+static void take(Conn *c, const unsigned char *data, size_t len, int closed)
+{
+    if (c->kind == UNKNOWN) {
+        /* a snapshot request, or target output */
+        size_t want = strlen(SNAPSHOT_REQUEST);
+
+        gcov_buf_add(&c->head, data, len);
+        if (c->head.len < want && !closed) {
+            return;
+        }
+        if (c->head.len >= want && memcmp(c->head.data, SNAPSHOT_REQUEST, want) == 0) {
+            char reply[256];
+
+            c->kind = CONTROL;
+            snapshot(reply, sizeof(reply), 0);
+            if (write(c->fd, reply, strlen(reply)) < 0) {
+                fprintf(stderr, "gcov_aggregate: %s: %s\n", c->label, strerror(errno));
+            }
+            shutdown(c->fd, SHUT_WR);
+            return;
+        }
+        c->kind = DATA;
+        gcov_decoder_feed(c->dec, c->head.data, c->head.len);
+        free(c->head.data);
+        c->head.data = NULL;
+        return;
+    }
+    if (c->kind == DATA) {
+        gcov_decoder_feed(c->dec, data, len);
+    }
+}
+
+static void *worker(void *arg)
+{
+    GcovBuf local = { NULL, 0, 0 };
+
+    (void)arg;
+    for (;;) {
+        Conn *c = dequeue();
+
+        for (;;) {
+            GcovBuf swap;
+            int closed;
+
+            pthread_mutex_lock(&c->lock);
+            swap = c->pending;
+            c->pending = local;
+            c->pending.len = 0;
+            local = swap;
+            closed = c->closed;
+            if (local.len == 0 && !closed) {
+                c->queued = 0;
+                pthread_mutex_unlock(&c->lock);
+                break;
+            }
+            pthread_mutex_unlock(&c->lock);
+
+            take(c, local.data, local.len, closed);
+            if (closed) {
+                if (c->kind == DATA) {
+                    int idle = gcov_decoder_finish(c->dec);
+
+                    printf("%s: closed: %u dumps, %u files merged (%u salvaged), %u skipped, %u rejected%s\n",
+                           c->label, c->dumps, c->merged, c->salvaged, c->skipped, c->rejected,
+                           idle ? "" : ", ended within a dump");
+                }
+                close(c->fd);
+                gcov_decoder_free(c->dec);
+                free(c->head.data);
+                free(c->pending.data);
+                pthread_mutex_destroy(&c->lock);
+                free(c);
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* ----------------------------------------------------------- */
+/* Signals, passed to the I/O thread through a pipe */
+
+static int signal_pipe[2];
+
+static void on_signal(int sig)
+{
+    unsigned char s = (unsigned char)sig;
+    int saved = errno;
+
+    if (write(signal_pipe[1], &s, 1) < 0) {
+        // nothing to do about it here
+    }
+    errno = saved;
+}
+
+/* Ask a running service for a snapshot, print the reply */
+static int request_snapshot(const char *addr)
+{
+    int fd = gcov_host_connect(addr);
+    char reply[256];
+    ssize_t got;
+
+    if (fd < 0) {
+        return 1;
+    }
+    if (write(fd, SNAPSHOT_REQUEST, strlen(SNAPSHOT_REQUEST)) < 0) {
+        perror(addr);
+        return 1;
+    }
+    shutdown(fd, SHUT_WR);
+    while ((got = read(fd, reply, sizeof(reply))) > 0) {
+        fwrite(reply, 1, (size_t)got, stdout);
+    }
+    close(fd);
+    return 0;
+}
+
+static int usage(const char *name)
+{
+    fprintf(stderr, "usage: %s -l addr [-o dir] [-j threads] [-t secs] [-e cmd] [-R]\n"
+                    "       %s -s addr\n", name, name);
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *listen_addr = NULL;
+    int threads = 4;
+    int period = 0;
+    time_t next_snapshot = 0;
+    int listen_fd;
+    static struct pollfd fds[2 + MAX_CONNS];
+    static Conn *conns[2 + MAX_CONNS];
+    int nfds = 2;
+    unsigned accepted = 0;
+    struct sigaction sa;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:o:j:t:e:Rs:")) != -1) {
+        switch (opt) {
+        case 'l': listen_addr = optarg; break;
+        case 'o': out_dir = optarg; break;
+        case 'j': threads = atoi(optarg); break;
+        case 't': period = atoi(optarg); break;
+        case 'e': snapshot_cmd = optarg; break;
+        case 'R': replace_builds = 1; break;
+        case 's': return request_snapshot(optarg);
+        default: return usage(argv[0]);
+        }
+    }
+    if (!listen_addr || optind != argc || threads < 1) {
+        return usage(argv[0]);
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0); // progress shows at once in a log
+
+    for (int i = 0; i < SHARDS; i++) {
+        pthread_mutex_init(&shards[i].lock, NULL);
+    }
+    if (pipe(signal_pipe) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN); // a control client that went away
+
+    listen_fd = gcov_host_listen(listen_addr);
+    if (listen_fd < 0) {
+        return 1;
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_t t;
+
+        if (pthread_create(&t, NULL, worker, NULL) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+        pthread_detach(t);
+    }
+    printf("Listening on %s with %d threads\n", listen_addr, threads);
+    if (period > 0) {
+        next_snapshot = time(NULL) + period;
+    }
+
+    fds[0].fd = signal_pipe[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = listen_fd;
+    fds[1].events = POLLIN;
+
+    /* I/O thread: read each connection as data arrives, hand it to the workers */
+    for (;;) {
+        int timeout = period > 0 ? (int)(next_snapshot - time(NULL)) * 1000 : -1;
+        char reply[256];
+
+        if (period > 0 && timeout <= 0) {
+            snapshot(reply, sizeof(reply), 1);
+            next_snapshot = time(NULL) + period;
+            continue;
+        }
+        if (poll(fds, (nfds_t)nfds, timeout) < 0) {
+            if (errno != EINTR) {
+                perror("poll");
+                return 1;
+            }
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            unsigned char sig;
+
+            if (read(signal_pipe[0], &sig, 1) == 1) {
+                snapshot(reply, sizeof(reply), 0);
+                if (sig != SIGUSR1) {
+                    return 0;
+                }
+            }
+        }
+
+        if ((fds[1].revents & POLLIN) && nfds < 2 + MAX_CONNS) {
+            int fd = accept(listen_fd, NULL, NULL);
+
+            if (fd >= 0) {
+                Conn *c = calloc(1, sizeof(*c));
+                static const GcovDecoderCallbacks cb = { on_file, on_salvaged, on_skip, on_end };
+
+                if (!c) {
+                    perror("calloc");
+                    exit(1);
+                }
+                c->fd = fd;
+                snprintf(c->label, sizeof(c->label), "producer %u", ++accepted);
+                c->dec = gcov_decoder_new(&cb, c);
+                pthread_mutex_init(&c->lock, NULL);
+                fds[nfds].fd = fd;
+                fds[nfds].events = POLLIN;
+                fds[nfds].revents = 0;
+                conns[nfds++] = c;
+            }
+        }
+
+        for (int i = 2; i < nfds; i++) {
+            Conn *c = conns[i];
+            unsigned char chunk[65536];
+            ssize_t got = 0;
+            int queue;
+
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            got = read(fds[i].fd, chunk, sizeof(chunk));
+            if (got < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            pthread_mutex_lock(&c->lock);
+            if (got > 0) {
+                gcov_buf_add(&c->pending, chunk, (size_t)got);
+            } else {
+                c->closed = 1; // the worker closes and frees it
+            }
+            queue = !c->queued;
+            c->queued = 1;
+            pthread_mutex_unlock(&c->lock);
+            if (queue) {
+                enqueue(c);
+            }
+            if (got <= 0) {
+                /* stop polling it */
+                fds[i] = fds[--nfds];
+                conns[i] = conns[nfds];
+                fds[i].revents = 0;
+                i--;
+            }
+        }
+    }
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_aggregate.c host service to merge gcov output of many targets
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,657 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool to report the memory that coverage instrumentation takes.
+ *
+ * Coverage adds, for each instrumented function, its arc counters
+ * (__gcov0.<function>, in .bss) and its gcov_fn_info (__gcov_.<function>,
+ * initialized data), and for each file, its gcov_info, the array of
+ * pointers to its gcov_fn_info, and its gcov_GcovInfo entry in
+ * gcov_public.c. Output takes gcov_buf, enough for the largest .gcda
+ * file (for the outputs that convert a whole file at a time).
+ *
+ * This tool reads the symbol table of the instrumented program (ELF,
+ * 32 or 64 bit, either byte order) for the sizes of the counters and
+ * gcov_fn_info of each function, and the .gcno index of the build
+ * (see gcov_index) for the functions of each file, their counters,
+ * lines, and source files. The gcov_info, the pointer arrays and the
+ * gcov_GcovInfo entries have no symbols, so are figured from the
+ * pointer size of the program and the GCC version of the .gcno files,
+ * as is anything of a function not found in the symbol table
+ * (such as when the program is stripped).
+ *
+ * Given a budget of RAM bytes (-b), it picks source files to instrument,
+ * greedily by instrumented lines per byte, and writes the GCC options
+ * (-fprofile-filter-files or -fprofile-exclude-files, GCC 9 and later)
+ * that instrument just those. These options go by the source file of
+ * each function, so a function inlined from a header is by the header.
+ *
+ * Typical usage:
+ *   ./gcov_index -o ../results/notes.gcidx ../objs
+ *   ./gcov_budget -i ../results/notes.gcidx ../example/example
+ *   ./gcov_budget -i ../results/notes.gcidx -b 32768 ../build/fsw.elf
+ *
+ * Options:
+ *   -i index  index of the build (required)
+ *   -b bytes  RAM budget for coverage, to suggest files to instrument
+ *   -v        also report each function
+ *
+ * Writes a line for each file (each .gcno file), totals, the sizes
+ * gcov_public.c needs, and with -b, the files picked and the options.
+ *
+ **********************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+#include "gcov_notes.h"
+
+#define SHT_SYMTAB 2
+#define SHF_WRITE 1
+#define STT_OBJECT 1
+#define STT_FILE 4
+
+/* What the program takes for one function */
+typedef struct {
+    uint64_t counter_bytes;
+    uint64_t fn_info_bytes;
+    int counters_found;         /* from the symbol table, else figured */
+    int fn_info_found;
+    int fn_info_ram;            /* in a writable section */
+} FunctionUse;
+
+/* What the program takes for one file */
+typedef struct {
+    uint64_t counter_bytes;
+    uint64_t fn_info_bytes;     /* of those in RAM */
+    uint64_t fn_info_rom;
+    uint64_t info_bytes;        /* gcov_info and its pointer array */
+    uint64_t filename_bytes;
+    uint64_t gcda_bytes;
+    int found;                  /* any function found in the symbol table */
+} UnitUse;
+
+/* A source file, for picking what to instrument */
+typedef struct {
+    uint32_t source;
+    uint64_t lines;
+    uint64_t bytes;
+    int picked;
+} Source;
+
+static const GcovIndex *ix;
+static FunctionUse *use;
+static UnitUse *unit_use;
+static unsigned pointer_bytes;
+static int verbose;
+
+/* Symbols of one FILE symbol of the symbol table, until the next */
+typedef struct {
+    const char *name;           /* function name, after __gcov0. or __gcov_. */
+    int is_counters;
+    uint64_t size;
+    int ram;
+} GcovSymbol;
+
+static GcovSymbol *group;
+static size_t group_count;
+static size_t group_cap;
+static uint32_t *votes;
+static unsigned unmatched;
+
+static uint64_t elf_value(const unsigned char *p, int bytes, int le)
+{
+    uint64_t v = 0;
+
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint64_t)p[le ? i : bytes - 1 - i] << (8 * i);
+    }
+    return v;
+}
+
+/* Unit of a function named in a group, preferring the unit most of the group is in */
+static const GcovIndexFunction *group_function(const char *name, uint32_t unit)
+{
+    const GcovIndexFunction *f;
+    const GcovIndexFunction *only = NULL;
+    uint32_t pos = 0;
+    unsigned count = 0;
+
+    while ((f = gcov_index_named(ix, name, &pos)) != NULL) {
+        if (f->unit == unit) {
+            return f;
+        }
+        only = f;
+        count++;
+    }
+    return count == 1 ? only : NULL;
+}
+
+/* Give the symbols of a group to the functions of the index */
+static void take_group(void)
+{
+    const GcovIndexFunction *f;
+    uint32_t best = UINT32_MAX;
+
+    for (size_t i = 0; i < group_count; i++) {
+        uint32_t pos = 0;
+
+        while ((f = gcov_index_named(ix, group[i].name, &pos)) != NULL) {
+            if (++votes[f->unit] > (best == UINT32_MAX ? 0 : votes[best])) {
+                best = f->unit;
+            }
+        }
+    }
+    for (size_t i = 0; i < group_count; i++) {
+        FunctionUse *u;
+
+        f = group_function(group[i].name, best);
+        if (!f) {
+            unmatched++;
+            continue;
+        }
+        u = &use[f - ix->function];
+        if (group[i].is_counters) {
+            u->counter_bytes = group[i].size;
+            u->counters_found = 1;
+        } else {
+            u->fn_info_bytes = group[i].size;
+            u->fn_info_found = 1;
+            u->fn_info_ram = group[i].ram;
+        }
+    }
+    for (size_t i = 0; i < group_count; i++) {
+        uint32_t pos = 0;
+
+        while ((f = gcov_index_named(ix, group[i].name, &pos)) != NULL) {
+            votes[f->unit] = 0;
+        }
+    }
+    group_count = 0;
+}
+
+/* Read the gcov symbols of the program, returns 0, or -1 after printing why not */
+static int read_elf(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    GcovBuf b = { NULL, 0, 0 };
+    unsigned char chunk[65536];
+    const unsigned char *e;
+    size_t got;
+    int wide;
+    int le;
+    uint64_t shoff;
+    unsigned shentsize;
+    unsigned shnum;
+    unsigned symtabs = 0;
+
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    while ((got = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        gcov_buf_add(&b, chunk, got);
+    }
+    fclose(fp);
+    e = b.data;
+    if (b.len < 52 || memcmp(e, "\177ELF", 4) != 0 || (e[4] != 1 && e[4] != 2) || (e[5] != 1 && e[5] != 2)) {
+        fprintf(stderr, "gcov_budget: %s: not an ELF file\n", path);
+        free(b.data);
+        return -1;
+    }
+    wide = e[4] == 2;
+    le = e[5] == 1;
+    pointer_bytes = wide ? 8 : 4;
+    shoff = elf_value(e + (wide ? 0x28 : 0x20), wide ? 8 : 4, le);
+    shentsize = (unsigned)elf_value(e + (wide ? 0x3a : 0x2e), 2, le);
+    shnum = (unsigned)elf_value(e + (wide ? 0x3c : 0x30), 2, le);
+    if (shoff > b.len || (uint64_t)shnum * shentsize > b.len - shoff || shentsize < (wide ? 64u : 40u)) {
+        fprintf(stderr, "gcov_budget: %s: bad section headers\n", path);
+        free(b.data);
+        return -1;
+    }
+
+    for (unsigned s = 0; s < shnum; s++) {
+        const unsigned char *sh = e + shoff + (uint64_t)s * shentsize;
+        const unsigned char *strsh;
+        uint64_t off, size, entsize, str_off, str_size;
+        unsigned link;
+
+        if (elf_value(sh + 4, 4, le) != SHT_SYMTAB) {
+            continue;
+        }
+        off = elf_value(sh + (wide ? 0x18 : 0x10), wide ? 8 : 4, le);
+        size = elf_value(sh + (wide ? 0x20 : 0x14), wide ? 8 : 4, le);
+        link = (unsigned)elf_value(sh + (wide ? 0x28 : 0x18), 4, le);
+        entsize = elf_value(sh + (wide ? 0x38 : 0x24), wide ? 8 : 4, le);
+        if (link >= shnum || entsize < (wide ? 24u : 16u) || off > b.len || size > b.len - off) {
+            continue;
+        }
+        strsh = e + shoff + (uint64_t)link * shentsize;
+        str_off = elf_value(strsh + (wide ? 0x18 : 0x10), wide ? 8 : 4, le);
+        str_size = elf_value(strsh + (wide ? 0x20 : 0x14), wide ? 8 : 4, le);
+        if (str_off > b.len || str_size > b.len - str_off) {
+            continue;
+        }
+        symtabs++;
+
+        for (uint64_t at = off; at + entsize <= off + size; at += entsize) {
+            const unsigned char *sym = e + at;
+            uint64_t name = elf_value(sym, 4, le);
+            unsigned info = sym[wide ? 4 : 12];
+            unsigned shndx = (unsigned)elf_value(sym + (wide ? 6 : 14), 2, le);
+            uint64_t sym_size = elf_value(sym + (wide ? 16 : 8), wide ? 8 : 4, le);
+            const char *n;
+            int is_counters;
+
+            if (name >= str_size) {
+                continue;
+            }
+            n = (const char *)e + str_off + name;
+            if ((info & 0xf) == STT_FILE) {
+                take_group();
+                continue;
+            }
+            if ((info & 0xf) != STT_OBJECT || strnlen(n, str_size - name) == str_size - name) {
+                continue;
+            }
+            if (strncmp(n, "__gcov0.", 8) == 0) {
+                is_counters = 1;
+            } else if (strncmp(n, "__gcov_.", 8) == 0) {
+                is_counters = 0;
+            } else {
+                continue;
+            }
+            if (group_count == group_cap) {
+                group_cap = group_cap ? 2 * group_cap : 1024;
+                group = realloc(group, group_cap * sizeof(*group));
+                if (!group) {
+                    perror("realloc");
+                    exit(1);
+                }
+            }
+            group[group_count].name = n + 8;
+            group[group_count].is_counters = is_counters;
+            group[group_count].size = sym_size;
+            group[group_count].ram = 1;
+            if (shndx > 0 && shndx < shnum) {
+                const unsigned char *in = e + shoff + (uint64_t)shndx * shentsize;
+
+                group[group_count].ram = (elf_value(in + 8, wide ? 8 : 4, le) & SHF_WRITE) != 0;
+            }
+            group_count++;
+        }
+        take_group();
+    }
+    if (!symtabs) {
+        fprintf(stderr, "gcov_budget: %s: no symbol table, figuring all sizes\n", path);
+    }
+    /* the names are in b, only the sizes are kept */
+    free(b.data);
+    return 0;
+}
+
+static uint64_t align_up(uint64_t n, uint64_t to)
+{
+    return (n + to - 1) / to * to;
+}
+
+/* Counter kinds of struct gcov_info of the GCC of a .gcno version, as in gcov_gcc.h */
+static unsigned gcov_counters(uint32_t version)
+{
+    int major = ((int)(version >> 24) - 'A') * 10 + ((int)(version >> 16 & 0xff) - '0');
+
+    return (major >= 10 && major < 14) ? 8 : 9;
+}
+
+/* Bytes of struct gcov_info, as in gcov_gcc.c, for the pointer size */
+static uint64_t gcov_info_bytes(uint32_t version)
+{
+    uint64_t p = pointer_bytes;
+    uint64_t n = 4;                             /* version */
+
+    n = align_up(n, p) + p;                     /* next */
+    n += 4 + 4;                                 /* stamp, checksum */
+    n = align_up(n, p) + p;                     /* filename */
+    n += p * gcov_counters(version);            /* merge */
+    n += 4;                                     /* n_functions */
+    n = align_up(n, p) + p;                     /* functions */
+    return align_up(n, p);
+}
+
+/* Bytes of a gcov_fn_info with the arc counters only, as in gcov_gcc.c */
+static uint64_t gcov_fn_info_bytes(void)
+{
+    uint64_t p = pointer_bytes;
+
+    return align_up(p + 12, p) + align_up(4, p) + p;
+}
+
+static void figure(void)
+{
+    for (uint32_t i = 0; i < ix->header->units; i++) {
+        const GcovIndexUnit *u = &ix->unit[i];
+        UnitUse *uu = &unit_use[i];
+
+        uu->info_bytes = gcov_info_bytes(u->version) + (uint64_t)pointer_bytes * u->functions;
+        uu->filename_bytes = strlen(gcov_index_string(ix, u->path)) + 1;
+        uu->gcda_bytes = 16;
+        for (uint32_t k = u->first_function; k < u->first_function + u->functions; k++) {
+            const GcovIndexFunction *f = &ix->function[k];
+            FunctionUse *fu = &use[k];
+
+            if (!fu->counters_found) {
+                fu->counter_bytes = 8ull * f->counters;
+            }
+            if (!fu->fn_info_found) {
+                fu->fn_info_bytes = gcov_fn_info_bytes();
+                fu->fn_info_ram = 1;
+            }
+            uu->found |= fu->counters_found | fu->fn_info_found;
+            uu->counter_bytes += fu->counter_bytes;
+            if (fu->fn_info_ram) {
+                uu->fn_info_bytes += fu->fn_info_bytes;
+            } else {
+                uu->fn_info_rom += fu->fn_info_bytes;
+            }
+            uu->gcda_bytes += 20 + 8 + 8ull * f->counters;
+        }
+    }
+}
+
+/* RAM of a function: counters, gcov_fn_info if in RAM, pointer to it */
+static uint64_t function_ram(uint32_t k)
+{
+    return use[k].counter_bytes + (use[k].fn_info_ram ? use[k].fn_info_bytes : 0) + pointer_bytes;
+}
+
+/* RAM of a file apart from its functions: gcov_info and gcov_GcovInfo entry */
+static uint64_t unit_fixed_ram(uint32_t i)
+{
+    return gcov_info_bytes(ix->unit[i].version) + 2ull * pointer_bytes;
+}
+
+/* Write a source file as a regular expression matching it by its basename */
+static void print_pattern(const char *source)
+{
+    const char *base = strrchr(source, '/');
+
+    printf("(^|/)");
+    for (const char *c = base ? base + 1 : source; *c; c++) {
+        if (strchr(".[]()*+?{}|^$\\", *c)) {
+            putchar('\\');
+        }
+        putchar(*c);
+    }
+    printf("$");
+}
+
+static int by_source(const void *a, const void *b)
+{
+    return strcmp(gcov_index_string(ix, ((const Source *)a)->source),
+                  gcov_index_string(ix, ((const Source *)b)->source));
+}
+
+/* Pick source files greedily by lines per byte within the budget */
+static void suggest(uint64_t budget, uint64_t buffer_bytes)
+{
+    Source *src = calloc(ix->header->functions + 1, sizeof(*src));
+    uint32_t *source_of = calloc(ix->header->functions + 1, sizeof(*source_of));
+    char *active = calloc(ix->header->units + 1, 1);
+    uint32_t *mark = calloc(ix->header->functions + 1, sizeof(*mark));
+    uint32_t count = 0;
+    uint64_t spent = buffer_bytes;
+    uint32_t picked = 0;
+    int first;
+
+    if (!src || !source_of || !active || !mark) {
+        perror("calloc");
+        exit(1);
+    }
+    /* sources by name, each function to its source */
+    for (uint32_t k = 0; k < ix->header->functions; k++) {
+        src[count++].source = ix->function[k].source;
+    }
+    qsort(src, count, sizeof(*src), by_source);
+    {
+        uint32_t n = 0;
+
+        for (uint32_t i = 0; i < count; i++) {
+            if (n == 0 || strcmp(gcov_index_string(ix, src[n - 1].source), gcov_index_string(ix, src[i].source)) != 0) {
+                src[n++].source = src[i].source;
+            }
+        }
+        count = n;
+    }
+    for (uint32_t k = 0; k < ix->header->functions; k++) {
+        Source key = { ix->function[k].source, 0, 0, 0 };
+        Source *s = bsearch(&key, src, count, sizeof(*src), by_source);
+
+        source_of[k] = (uint32_t)(s - src);
+        s->lines += ix->function[k].lines;
+        s->bytes += function_ram(k);
+    }
+
+    printf("budget %llu bytes, %llu for gcov_buf\n", (unsigned long long)budget, (unsigned long long)buffer_bytes);
+    for (;;) {
+        uint64_t *cost = calloc(count, sizeof(*cost));
+        double best_rate = -1;
+        uint32_t best = count;
+
+        if (!cost) {
+            perror("calloc");
+            exit(1);
+        }
+        /* each source costs its functions, and the files it would be the first of */
+        for (uint32_t i = 0; i < ix->header->units; i++) {
+            const GcovIndexUnit *u = &ix->unit[i];
+
+            if (active[i]) {
+                continue;
+            }
+            for (uint32_t k = u->first_function; k < u->first_function + u->functions; k++) {
+                uint32_t s = source_of[k];
+
+                if (mark[s] != i + 1) {
+                    mark[s] = i + 1;
+                    cost[s] += unit_fixed_ram(i);
+                }
+            }
+        }
+        for (uint32_t s = 0; s < count; s++) {
+            uint64_t c = cost[s] + src[s].bytes;
+            double rate = (double)src[s].lines / (double)(c ? c : 1);
+
+            if (!src[s].picked && spent + c <= budget && rate > best_rate) {
+                best_rate = rate;
+                best = s;
+            }
+        }
+        if (best == count) {
+            free(cost);
+            break;
+        }
+        spent += cost[best] + src[best].bytes;
+        free(cost);
+        memset(mark, 0, (ix->header->functions + 1) * sizeof(*mark));
+        src[best].picked = 1;
+        picked++;
+        for (uint32_t k = 0; k < ix->header->functions; k++) {
+            if (source_of[k] == best) {
+                active[ix->function[k].unit] = 1;
+            }
+        }
+        printf("include %s %llu lines %llu bytes\n", gcov_index_string(ix, src[best].source),
+               (unsigned long long)src[best].lines, (unsigned long long)src[best].bytes);
+    }
+    printf("%u of %u source files fit, %llu bytes\n", picked, count, (unsigned long long)spent);
+    if (picked == 0) {
+        printf("nothing fits in the budget\n");
+    } else if (picked == count) {
+        printf("everything fits in the budget\n");
+    } else {
+        printf("-fprofile-filter-files='");
+        first = 1;
+        for (uint32_t s = 0; s < count; s++) {
+            if (src[s].picked) {
+                printf(first ? "" : ";");
+                print_pattern(gcov_index_string(ix, src[s].source));
+                first = 0;
+            }
+        }
+        printf("'\n-fprofile-exclude-files='");
+        first = 1;
+        for (uint32_t s = 0; s < count; s++) {
+            if (!src[s].picked) {
+                printf(first ? "" : ";");
+                print_pattern(gcov_index_string(ix, src[s].source));
+                first = 0;
+            }
+        }
+        printf("'\n");
+    }
+    free(src);
+    free(source_of);
+    free(active);
+    free(mark);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *index_path = NULL;
+    uint64_t budget = 0;
+    int have_budget = 0;
+    uint64_t counters = 0, fn_info = 0, fn_info_rom = 0, info = 0, filenames = 0;
+    uint64_t largest = 0;
+    uint32_t largest_unit = 0;
+    unsigned figured = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:b:v")) != -1) {
+        switch (opt) {
+        case 'i': index_path = optarg; break;
+        case 'b': budget = strtoull(optarg, NULL, 0); have_budget = 1; break;
+        case 'v': verbose = 1; break;
+        default:
+            index_path = NULL;
+            optind = argc;
+            break;
+        }
+    }
+    if (!index_path || optind != argc - 1) {
+        fprintf(stderr, "usage: %s -i index [-b bytes] [-v] program\n", argv[0]);
+        return 1;
+    }
+    ix = gcov_index_open(index_path);
+    if (!ix) {
+        return 1;
+    }
+    if (gcov_index_stale(ix)) {
+        fprintf(stderr, "gcov_budget: %s is stale, build it again first\n", index_path);
+        return 1;
+    }
+    use = calloc(ix->header->functions + 1, sizeof(*use));
+    unit_use = calloc(ix->header->units + 1, sizeof(*unit_use));
+    votes = calloc(ix->header->units + 1, sizeof(*votes));
+    if (!use || !unit_use || !votes) {
+        perror("calloc");
+        return 1;
+    }
+    if (read_elf(argv[optind]) != 0) {
+        return 1;
+    }
+    if (unmatched) {
+        fprintf(stderr, "gcov_budget: %u gcov symbols of %s not in the index (of another build?)\n",
+                unmatched, argv[optind]);
+    }
+    figure();
+
+    printf("%-24s %9s %10s %10s %10s %10s\n", "file", "functions", "counters", "fn_info", "gcov_info", "gcda");
+    for (uint32_t i = 0; i < ix->header->units; i++) {
+        const GcovIndexUnit *u = &ix->unit[i];
+        const UnitUse *uu = &unit_use[i];
+
+        printf("%-24s %9u %10llu %10llu %10llu %10llu%s\n", gcov_index_string(ix, u->stem), u->functions,
+               (unsigned long long)uu->counter_bytes, (unsigned long long)(uu->fn_info_bytes + uu->fn_info_rom),
+               (unsigned long long)uu->info_bytes, (unsigned long long)uu->gcda_bytes,
+               uu->found ? "" : " (figured, not in the program)");
+        figured += !uu->found;
+        counters += uu->counter_bytes;
+        fn_info += uu->fn_info_bytes;
+        fn_info_rom += uu->fn_info_rom;
+        info += uu->info_bytes;
+        filenames += uu->filename_bytes;
+        if (uu->gcda_bytes > largest) {
+            largest = uu->gcda_bytes;
+            largest_unit = i;
+        }
+        if (verbose) {
+            for (uint32_t k = u->first_function; k < u->first_function + u->functions; k++) {
+                const GcovIndexFunction *f = &ix->function[k];
+
+                printf("  %s %s:%u %llu %llu%s\n", gcov_index_string(ix, f->name), gcov_index_string(ix, f->source),
+                       f->start_line, (unsigned long long)use[k].counter_bytes,
+                       (unsigned long long)use[k].fn_info_bytes,
+                       use[k].counters_found ? "" : " (figured)");
+            }
+        }
+    }
+
+    printf("%u files, %u functions, %u-bit pointers%s\n", ix->header->units, ix->header->functions,
+           8 * pointer_bytes, figured ? ", some figured" : "");
+    printf("RAM: %llu counters, %llu gcov_fn_info, %llu gcov_info and pointers, %llu gcov_GcovInfo, total %llu\n",
+           (unsigned long long)counters, (unsigned long long)fn_info, (unsigned long long)info,
+           (unsigned long long)(2ull * pointer_bytes * ix->header->units),
+           (unsigned long long)(counters + fn_info + info + 2ull * pointer_bytes * ix->header->units));
+    printf("ROM: %llu gcov_fn_info, %llu filenames\n", (unsigned long long)fn_info_rom, (unsigned long long)filenames);
+    printf("gcov_GcovInfo[%u] at least (without GCOV_OPT_USE_MALLOC)\n", ix->header->units);
+    printf("gcov_buf[%llu] at least, for %s.gcda (%llu bytes)\n", (unsigned long long)((largest + 3) / 4),
+           gcov_index_string(ix, ix->unit[largest_unit].stem), (unsigned long long)largest);
+
+    if (have_budget) {
+        suggest(budget, align_up(largest, 4));
+    }
+    gcov_index_close((GcovIndex *)ix);
+    return 0;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_budget.c host tool to report the memory that coverage instrumentation takes
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
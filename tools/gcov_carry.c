@@ -0,0 +1,478 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool to carry coverage of unchanged functions to a new build.
+ *
+ * A new build makes all .gcda files of the old build unusable,
+ * although most of its functions have not changed. This tool takes
+ * the (merged) .gcda files of the old build, and the .gcno index of
+ * the new build (see gcov_index), and writes .gcda files for the new
+ * build with the arc counters of each function that is unchanged:
+ * whose lineno and cfg checksums (as in gcov_fn_info) are the same
+ * in both builds, and whose arc counter count is the same.
+ * All other functions get zero counters, and are listed to retest,
+ * so that an incremental release needs only the tests that reach them.
+ *
+ * The lineno checksum is of the function's name, source file, and
+ * first line, so a function moved by a change above it no longer
+ * matches. Given the index of the old build as well (-O), functions
+ * are also matched by name, and a function that only moved (the same
+ * cfg checksum, arcs, and lines, all shifted by the same count) is
+ * carried too, and changed functions are told apart from new ones.
+ *
+ * The checksums cover the control flow and position of a function,
+ * not every expression in it: a change that keeps the control flow
+ * and lines (a changed constant, say) is not seen as a change.
+ * Only arc counters are carried, which are what gcov and lcov report.
+ *
+ * Typical usage:
+ *   ./gcov_index -o ../results/notes.gcidx ../objs
+ *   ./gcov_carry -N ../results/notes.gcidx -o ../objs ../release1/objs/main.gcda ../release1/objs/util.gcda
+ *   ./gcov_carry -N new.gcidx -O old.gcidx -o ../objs ../release1/merged/main.gcda ../release1/merged/util.gcda > retest.txt
+ *
+ * Options:
+ *   -N index  index of the new build (required)
+ *   -O index  index of the old build, to match functions by name too
+ *   -o dir    directory for the new .gcda files (default current directory)
+ *   -v        also list each function carried
+ *
+ * Writes to stdout a line for each function to retest, and a summary.
+ *
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+#include "gcov_notes.h"
+
+/* One function record of an old .gcda file */
+typedef struct {
+    uint32_t ident;
+    uint32_t lineno_checksum;
+    uint32_t cfg_checksum;
+    const unsigned char *arcs;  /* arc counter values, NULL if none */
+    uint32_t counters;
+    int taken;                  /* carried to a new function */
+} OldFunction;
+
+/* One old .gcda file */
+typedef struct {
+    const char *path;
+    unsigned char *data;
+    size_t bytes;
+    int le;
+    OldFunction *function;
+    size_t functions;
+    OldFunction **by_checksum;  /* sorted by (lineno, cfg) checksums */
+    const GcovIndexUnit *old_unit;
+    int used;
+} OldFile;
+
+static const GcovIndex *new_ix;
+static const GcovIndex *old_ix;
+static const char *out_dir = ".";
+static int verbose = 0;
+
+static unsigned carried;
+static unsigned moved;
+static unsigned changed;
+static unsigned added;
+static unsigned removed;
+static unsigned uncovered_units;
+
+static uint32_t gcda_word(const unsigned char *p, int le)
+{
+    return le ? (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24
+              : (uint32_t)p[3] | (uint32_t)p[2] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[0] << 24;
+}
+
+static void put_word(GcovBuf *out, uint32_t v, int le)
+{
+    unsigned char p[4];
+
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (le ? 8 * i : 24 - 8 * i));
+    }
+    gcov_buf_add(out, p, 4);
+}
+
+static int by_checksums(const void *a, const void *b)
+{
+    const OldFunction *x = *(OldFunction *const *)a;
+    const OldFunction *y = *(OldFunction *const *)b;
+
+    if (x->lineno_checksum != y->lineno_checksum) {
+        return x->lineno_checksum < y->lineno_checksum ? -1 : 1;
+    }
+    return x->cfg_checksum < y->cfg_checksum ? -1 : x->cfg_checksum > y->cfg_checksum;
+}
+
+/* Read and take apart an old .gcda file, returns 0, or -1 after printing why not */
+static int read_old(OldFile *o, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    GcovBuf data = { NULL, 0, 0 };
+    unsigned char chunk[65536];
+    size_t got;
+    const char *why;
+
+    memset(o, 0, sizeof(*o));
+    o->path = path;
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        gcov_buf_add(&data, chunk, got);
+    }
+    fclose(f);
+    why = gcov_gcda_check(data.data, data.len);
+    if (why) {
+        fprintf(stderr, "gcov_carry: %s: %s\n", path, why);
+        free(data.data);
+        return -1;
+    }
+    o->data = data.data;
+    o->bytes = data.len;
+    o->le = gcda_word(o->data, 1) == GCOV_HOST_DATA_MAGIC;
+    o->function = calloc(o->bytes / 20 + 1, sizeof(*o->function));
+    o->by_checksum = calloc(o->bytes / 20 + 1, sizeof(*o->by_checksum));
+    if (!o->function || !o->by_checksum) {
+        perror("calloc");
+        exit(1);
+    }
+    for (size_t pos = 16; pos + 8 <= o->bytes; ) {
+        uint32_t tag = gcda_word(o->data + pos, o->le);
+        uint32_t bytes = gcda_word(o->data + pos + 4, o->le);
+
+        if (tag == GCOV_HOST_TAG_FUNCTION && bytes == 12) {
+            OldFunction *fn = &o->function[o->functions++];
+
+            fn->ident = gcda_word(o->data + pos + 8, o->le);
+            fn->lineno_checksum = gcda_word(o->data + pos + 12, o->le);
+            fn->cfg_checksum = gcda_word(o->data + pos + 16, o->le);
+        } else if (tag == GCOV_HOST_TAG_COUNTER_BASE) {
+            /* checked: a counter record follows a function record */
+            o->function[o->functions - 1].arcs = o->data + pos + 8;
+            o->function[o->functions - 1].counters = bytes / 8;
+        }
+        pos += 8 + bytes;
+    }
+    for (size_t i = 0; i < o->functions; i++) {
+        o->by_checksum[i] = &o->function[i];
+    }
+    qsort(o->by_checksum, o->functions, sizeof(*o->by_checksum), by_checksums);
+    return 0;
+}
+
+/* The old function of the same checksums, or NULL if none, or not only one */
+static OldFunction *same_checksums(const OldFile *o, const GcovIndexFunction *f)
+{
+    OldFunction key;
+    OldFunction *k = &key;
+    OldFunction **at;
+
+    key.lineno_checksum = f->lineno_checksum;
+    key.cfg_checksum = f->cfg_checksum;
+    at = bsearch(&k, o->by_checksum, o->functions, sizeof(*o->by_checksum), by_checksums);
+    if (!at || (at > o->by_checksum && by_checksums(at - 1, at) == 0)
+        || (at + 1 < o->by_checksum + o->functions && by_checksums(at, at + 1) == 0)) {
+        return NULL;
+    }
+    return *at;
+}
+
+static OldFunction *old_by_ident(const OldFile *o, uint32_t ident)
+{
+    for (size_t i = 0; i < o->functions; i++) {
+        if (o->function[i].ident == ident) {
+            return &o->function[i];
+        }
+    }
+    return NULL;
+}
+
+/* The function of the old build of this name in this unit, or NULL */
+static const GcovIndexFunction *old_named(const OldFile *o, const GcovIndexFunction *f)
+{
+    uint32_t pos = 0;
+    const GcovIndexFunction *g;
+
+    while ((g = gcov_index_named(old_ix, gcov_index_string(new_ix, f->name), &pos)) != NULL) {
+        if (&old_ix->unit[g->unit] == o->old_unit) {
+            return g;
+        }
+    }
+    return NULL;
+}
+
+/* Whether old function g became f by only moving: the same arcs, and lines shifted alike */
+static int only_moved(const GcovIndexFunction *g, const GcovIndexFunction *f)
+{
+    int64_t shift = (int64_t)f->start_line - g->start_line;
+
+    if (g->cfg_checksum != f->cfg_checksum || g->arcs != f->arcs || g->lines != f->lines
+        || g->counters != f->counters || (int64_t)g->end_line + shift != f->end_line
+        || g->first_arc + g->arcs > old_ix->header->arcs || f->first_arc + f->arcs > new_ix->header->arcs
+        || g->first_line + g->lines > old_ix->header->lines || f->first_line + f->lines > new_ix->header->lines) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < f->arcs; i++) {
+        const GcovIndexArc *a = &old_ix->arc[g->first_arc + i];
+        const GcovIndexArc *b = &new_ix->arc[f->first_arc + i];
+
+        if (a->src != b->src || a->dest != b->dest || a->flags != b->flags) {
+            return 0;
+        }
+    }
+    for (uint32_t i = 0; i < f->lines; i++) {
+        const GcovIndexLine *a = &old_ix->line[g->first_line + i];
+        const GcovIndexLine *b = &new_ix->line[f->first_line + i];
+
+        if (a->block != b->block || (int64_t)a->line + shift != b->line
+            || strcmp(gcov_index_string(old_ix, a->source), gcov_index_string(new_ix, b->source)) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void retest(const GcovIndexFunction *f, const char *why)
+{
+    printf("retest %s %s:%u (%s)\n", gcov_index_string(new_ix, f->name),
+           gcov_index_string(new_ix, f->source), f->start_line, why);
+}
+
+/* Write the .gcda file of a new unit from the old file of the same name */
+static int carry_unit(const GcovIndexUnit *u, OldFile *o)
+{
+    GcovBuf out = { NULL, 0, 0 };
+    char path[4096];
+    int le = o->le;
+    int failed;
+
+    put_word(&out, GCOV_HOST_DATA_MAGIC, le);
+    put_word(&out, u->version, le);
+    put_word(&out, u->stamp, le);
+    /* the checksum of the object's gcov_info is not in the notes (0 there),
+     * so 0, which gcov ignores and gcov_gcda_merge takes as not known */
+    put_word(&out, 0, le);
+    for (uint32_t i = u->first_function; i < u->first_function + u->functions; i++) {
+        const GcovIndexFunction *f = &new_ix->function[i];
+        OldFunction *from = same_checksums(o, f);
+        const char *how = "carried";
+
+        if (from && (from->counters != f->counters || from->taken)) {
+            from = NULL;
+        }
+        if (!from && old_ix && o->old_unit) {
+            const GcovIndexFunction *g = old_named(o, f);
+
+            if (!g) {
+                retest(f, "new");
+                added++;
+            } else if ((from = old_by_ident(o, g->ident)) != NULL && !from->taken
+                       && from->counters == f->counters && only_moved(g, f)) {
+                how = "carried, moved";
+                moved++;
+            } else {
+                from = NULL;
+                retest(f, "changed");
+                changed++;
+            }
+        } else if (!from) {
+            retest(f, old_ix ? "changed or new, no old notes" : "changed or new");
+            changed++;
+        }
+        if (from) {
+            from->taken = 1;
+            carried++;
+            if (verbose) {
+                printf("%s %s %s:%u\n", how, gcov_index_string(new_ix, f->name),
+                       gcov_index_string(new_ix, f->source), f->start_line);
+            }
+        }
+
+        put_word(&out, GCOV_HOST_TAG_FUNCTION, le);
+        put_word(&out, 12, le);
+        put_word(&out, f->ident, le);
+        put_word(&out, f->lineno_checksum, le);
+        put_word(&out, f->cfg_checksum, le);
+        put_word(&out, GCOV_HOST_TAG_COUNTER_BASE, le);
+        put_word(&out, f->counters * 8, le);
+        if (from) {
+            /* the same byte order, so the values as they are */
+            gcov_buf_add(&out, from->arcs, (size_t)f->counters * 8);
+        } else {
+            for (uint32_t c = 0; c < 2 * f->counters; c++) {
+                put_word(&out, 0, le);
+            }
+        }
+    }
+    if (old_ix && o->old_unit) {
+        for (size_t i = 0; i < o->functions; i++) {
+            if (!o->function[i].taken) {
+                const GcovIndexFunction *g = gcov_index_function(old_ix, o->old_unit, o->function[i].ident);
+
+                /* a function of the old build not in the new, rather than changed */
+                if (g) {
+                    uint32_t pos = 0;
+                    const GcovIndexFunction *h;
+                    int found = 0;
+
+                    while (!found && (h = gcov_index_named(new_ix, gcov_index_string(old_ix, g->name), &pos))) {
+                        found = &new_ix->unit[h->unit] == u;
+                    }
+                    if (!found) {
+                        printf("removed %s %s:%u\n", gcov_index_string(old_ix, g->name),
+                               gcov_index_string(old_ix, g->source), g->start_line);
+                        removed++;
+                    }
+                }
+            }
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s/%s.gcda", out_dir, gcov_index_string(new_ix, u->stem));
+    failed = gcov_write_whole(path, out.data, out.len);
+    if (failed) {
+        perror(path);
+    }
+    free(out.data);
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *new_path = NULL;
+    const char *old_path = NULL;
+    OldFile *old;
+    int count;
+    int failed = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "N:O:o:v")) != -1) {
+        switch (opt) {
+        case 'N': new_path = optarg; break;
+        case 'O': old_path = optarg; break;
+        case 'o': out_dir = optarg; break;
+        case 'v': verbose = 1; break;
+        default:
+            new_path = NULL;
+            optind = argc;
+            break;
+        }
+    }
+    if (!new_path || optind >= argc) {
+        fprintf(stderr, "usage: %s -N new_index [-O old_index] [-o dir] [-v] old.gcda...\n", argv[0]);
+        return 1;
+    }
+    new_ix = gcov_index_open(new_path);
+    if (!new_ix || (old_path && !(old_ix = gcov_index_open(old_path)))) {
+        return 1;
+    }
+    if (gcov_index_stale(new_ix)) {
+        fprintf(stderr, "gcov_carry: %s is stale, build it again first\n", new_path);
+        return 1;
+    }
+
+    count = argc - optind;
+    old = calloc((size_t)count, sizeof(*old));
+    if (!old) {
+        perror("calloc");
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (read_old(&old[i], argv[optind + i]) != 0) {
+            failed = 1;
+            continue;
+        }
+        if (old_ix) {
+            old[i].old_unit = gcov_index_unit(old_ix, old[i].path);
+            if (old[i].old_unit && old[i].old_unit->stamp != gcda_word(old[i].data + 8, old[i].le)) {
+                fprintf(stderr, "gcov_carry: %s: not of the build of %s, matching by checksums only\n",
+                        old[i].path, old_path);
+                old[i].old_unit = NULL;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < new_ix->header->units; i++) {
+        const GcovIndexUnit *u = &new_ix->unit[i];
+        OldFile *o = NULL;
+        char name[4096];
+
+        snprintf(name, sizeof(name), "%s.gcda", gcov_index_string(new_ix, u->stem));
+        for (int j = 0; j < count && !o; j++) {
+            if (old[j].data && gcov_index_unit(new_ix, old[j].path) == u) {
+                o = &old[j];
+            }
+        }
+        if (!o) {
+            printf("retest %s: no coverage from the old build (%u functions)\n", name, u->functions);
+            uncovered_units++;
+            continue;
+        }
+        if (o->used) {
+            continue;
+        }
+        o->used = 1;
+        failed |= carry_unit(u, o);
+    }
+    for (int i = 0; i < count; i++) {
+        if (old[i].data && !old[i].used) {
+            printf("removed %s: not in the new build\n", old[i].path);
+        }
+        free(old[i].data);
+        free(old[i].function);
+        free(old[i].by_checksum);
+    }
+    free(old);
+
+    printf("%u functions carried (%u moved), %u to retest (%u changed, %u new), %u removed, "
+           "%u units without coverage\n", carried, moved, changed + added, changed, added, removed,
+           uncovered_units);
+    gcov_index_close((GcovIndex *)new_ix);
+    gcov_index_close((GcovIndex *)old_ix);
+    return failed;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_carry.c host tool to carry coverage forward to a new build
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,1324 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool code to decode and merge gcov output.
+ *
+ * The decoder takes target output in whatever pieces it arrives,
+ * and reports each .gcda file as soon as its data is complete:
+ *   GCOV_OPT_OUTPUT_SERIAL_HEXDUMP output: "Emitting N bytes for"
+ *     lines, hexdump lines, and the filename line that ends each file
+ *     (files with missing or garbled bytes are skipped, not reported),
+ *   binary format (GCOV_OPT_OUTPUT_BINARY_FILE, GCOV_OPT_OUTPUT_DMA etc.),
+ *     starting at the beginning of a line, and also
+ *     compressed by GCOV_OPT_COMPRESS_LZ, decompressed as it arrives,
+ *     and files packed by GCOV_OPT_PACK_CONDITIONS, unpacked,
+ * and "Gcov End" as the end of a dump.
+ *
+ * Output damaged on the way, such as by a reboot of the target
+ * (which may also leave NULs in a serial log) or a noisy link,
+ * is checked for at each level: the address of each hexdump line,
+ * the name, byte count, and magic of each file in binary format,
+ * and the record structure of the .gcda data itself.
+ * Decoding resyncs at the next line or file that checks out,
+ * and of a damaged file the complete function records are salvaged,
+ * and what was lost is reported, so a glitch in a long test costs
+ * only the coverage of the functions it hit, not a rerun.
+ *
+ * The gcda functions check and merge the .gcda data itself,
+ * so that host tools need not go through gcov-tool or lcov to combine
+ * the results of many runs.
+ *
+ **********************************************************************/
+
+#include <errno.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+
+enum { TEXT, BINARY, COMPRESSED };
+
+struct GcovDecoder {
+    GcovDecoderCallbacks cb;
+    void *ctx;
+
+    GcovBuf in;                 /* input not yet taken */
+    unsigned long long offset;  /* input bytes taken */
+    unsigned long long resume;  /* input bytes up to the last idle point */
+
+    int mode;
+    unsigned files_written;     /* in the current dump */
+    unsigned files_salvaged;    /* in the current dump */
+    unsigned files_skipped;     /* in the current dump */
+
+    /* Hexdump file in progress */
+    int tu_active;
+    char *tu_name;              /* NULL if not known (yet) */
+    size_t tu_want;             /* from "Emitting N bytes for", 0 if not known */
+    GcovBuf tu_data;
+    GcovBuf tu_known;           /* for each byte of tu_data, one of the below */
+    size_t tu_missing;          /* bytes of tu_data not (reliably) received */
+
+    /* Binary format: name of the last file, to resync after damage */
+    char *last_name;
+
+    /* Compressed dump in progress: decompressed bytes and decoder state */
+    GcovBuf plain;
+    size_t plain_pos;           /* next frame in plain */
+    size_t plain_need;          /* plain length for the frame to be complete */
+    unsigned lz_flags;
+    int lz_item;                /* item within group, 8 if flag byte next */
+    int lz_first;               /* first byte of a copy item, or -1 */
+
+    /* File of GCOV_OPT_PACK_CONDITIONS, unpacked */
+    GcovBuf unpacked;
+};
+
+void gcov_buf_add(GcovBuf *b, const void *p, size_t n)
+{
+    if (b->len + n > b->cap) {
+        b->cap = (b->len + n) * 2 + 4096;
+        b->data = realloc(b->data, b->cap);
+        if (!b->data) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    memcpy(b->data + b->len, p, n);
+    b->len += n;
+}
+
+static void found_file(GcovDecoder *d, const char *filename, const unsigned char *data, size_t bytes)
+{
+    d->files_written++;
+    if (d->cb.file) {
+        d->cb.file(d->ctx, filename, data, bytes);
+    }
+}
+
+static void salvaged_file(GcovDecoder *d, const char *filename, const unsigned char *data, size_t bytes,
+                          const char *lost)
+{
+    d->files_salvaged++;
+    if (d->cb.salvaged) {
+        d->cb.salvaged(d->ctx, filename, data, bytes, lost);
+    }
+}
+
+static void skip_file(GcovDecoder *d, const char *filename, const char *why)
+{
+    d->files_skipped++;
+    if (d->cb.skip) {
+        d->cb.skip(d->ctx, filename, why);
+    }
+}
+
+/*
+ * Take a file as received: whole if nothing is missing and its records
+ * are sound, else the function records that are complete, else skip it.
+ * known is NULL if every byte was received, damage NULL if none seen yet.
+ */
+static void take_file(GcovDecoder *d, const char *filename, const unsigned char *data,
+                      const unsigned char *known, size_t bytes, const char *damage)
+{
+    GcovBuf out = { NULL, 0, 0 };
+    unsigned kept, dropped;
+    size_t lost;
+    char why[256];
+
+    if (!damage && (damage = gcov_gcda_check(data, bytes)) == NULL) {
+        found_file(d, filename, data, bytes);
+        return;
+    }
+    kept = gcov_gcda_salvage(data, known, bytes, &out, &dropped, &lost);
+    if (kept) {
+        snprintf(why, sizeof(why), "%s; kept %u functions, lost %u and %zu bytes",
+                 damage, kept, dropped, lost);
+        salvaged_file(d, filename, out.data, out.len, why);
+    } else {
+        snprintf(why, sizeof(why), "%s; no complete functions", damage);
+        skip_file(d, filename, why);
+    }
+    free(out.data);
+}
+
+/* ----------------------------------------------------------- */
+/* Hexdump output, line by line (compare to scripts/serial_split.awk) */
+
+/* Each byte of a hexdump file is one of these */
+enum { MISSING, RECEIVED, CONFLICT };
+
+static void drop_tu(GcovDecoder *d)
+{
+    free(d->tu_name);
+    d->tu_name = NULL;
+    d->tu_active = 0;
+    d->tu_want = 0;
+    d->tu_data.len = 0;
+    d->tu_known.len = 0;
+    d->tu_missing = 0;
+}
+
+static void start_tu(GcovDecoder *d, const char *name, size_t want)
+{
+    drop_tu(d);
+    d->tu_active = 1;
+    d->tu_name = name ? strdup(name) : NULL;
+    d->tu_want = want;
+}
+
+/*
+ * End of a hexdump file, at its filename line or where the next thing
+ * starts (ended says what, if its filename line is missing).
+ * Whatever was received is used, as take_file can.
+ */
+static void finish_tu(GcovDecoder *d, const char *ended)
+{
+    size_t have = d->tu_data.len - d->tu_missing;
+    size_t want = d->tu_want ? d->tu_want : d->tu_data.len;
+    char damage[128];
+
+    if (!d->tu_active) {
+        return;
+    }
+    if (!d->tu_name) {
+        snprintf(damage, sizeof(damage), "%zu bytes without Emitting or filename line", have);
+        skip_file(d, "unnamed hexdump file", damage);
+    } else if (d->tu_missing || d->tu_data.len != want) {
+        snprintf(damage, sizeof(damage), "%s%shave %zu of %zu bytes",
+                 ended ? ended : "", ended ? ", " : "", have, want);
+        take_file(d, d->tu_name, d->tu_data.data, d->tu_known.data, d->tu_data.len, damage);
+    } else {
+        take_file(d, d->tu_name, d->tu_data.data, NULL, d->tu_data.len, NULL);
+    }
+    drop_tu(d);
+}
+
+/* End of a dump */
+static void dump_end(GcovDecoder *d)
+{
+    unsigned written, salvaged, skipped;
+
+    finish_tu(d, "no filename line before end");
+    written = d->files_written;
+    salvaged = d->files_salvaged;
+    skipped = d->files_skipped;
+    d->files_written = 0;
+    d->files_salvaged = 0;
+    d->files_skipped = 0;
+    if (d->cb.end) {
+        d->cb.end(d->ctx, written, salvaged, skipped);
+    }
+}
+
+static int hex_digit(char c)
+{
+    return (c >= '0' && c <= '9') ? c - '0'
+         : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+         : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+}
+
+/*
+ * Parse a hexdump line: 8 hex digits of address, ":", then up to 16 bytes
+ * of 2 hex digits, each followed by a space (or the end of the line).
+ * Returns the count of bytes before anything garbled, or -1 if not hexdump.
+ */
+static int parse_hexdump(const char *line, unsigned *addr, unsigned char *bytes)
+{
+    const char *p = line + 9;
+    int n = 0;
+
+    *addr = 0;
+    for (int i = 0; i < 8; i++) {
+        if (hex_digit(line[i]) < 0) {
+            return -1;
+        }
+        *addr = (*addr << 4) | (unsigned)hex_digit(line[i]);
+    }
+    if (line[8] != ':') {
+        return -1;
+    }
+    while (*p == ' ' && n < 16) {
+        p++;
+        if (hex_digit(p[0]) < 0 || hex_digit(p[1]) < 0 || (p[2] != ' ' && p[2] != '\0')) {
+            break;
+        }
+        bytes[n++] = (unsigned char)(hex_digit(p[0]) << 4 | hex_digit(p[1]));
+        p += 2;
+    }
+    return n;
+}
+
+/*
+ * Lines may be lost, repeated, or garbled (such as by a reboot of the target,
+ * or a noisy link), so each byte is placed by the address of its line,
+ * and marked missing until received, or conflicting if received differently.
+ */
+static void do_hexdump(GcovDecoder *d, const char *line)
+{
+    unsigned char bytes[16];
+    unsigned addr;
+    int n = parse_hexdump(line, &addr, bytes);
+
+    if (n < 0) {
+        return; // not hexdump, other output of the target
+    }
+    if (!d->tu_active) {
+        if (addr != 0) {
+            return; // nothing to place it in
+        }
+        start_tu(d, NULL, 0); // Emitting line lost, named by its filename line
+    } else if (addr == 0 && d->tu_data.len
+               && (d->tu_data.len < (size_t)n || memcmp(d->tu_data.data, bytes, (size_t)n) != 0)) {
+        /* not a repeat of the first line, so the next file, its Emitting line lost */
+        finish_tu(d, "no filename line");
+        start_tu(d, NULL, 0);
+    }
+    if ((addr & 15) || (d->tu_want && addr + (unsigned)n > d->tu_want)
+        || addr > d->tu_data.len + 65536) {
+        return; // garbled address, the line is lost
+    }
+    for (int i = 0; i < n; i++) {
+        size_t at = addr + (size_t)i;
+        unsigned char *known;
+
+        while (d->tu_data.len < at) {
+            unsigned char missing = MISSING;
+
+            gcov_buf_add(&d->tu_data, "", 1);
+            gcov_buf_add(&d->tu_known, &missing, 1);
+            d->tu_missing++;
+        }
+        if (at == d->tu_data.len) {
+            unsigned char received = RECEIVED;
+
+            gcov_buf_add(&d->tu_data, &bytes[i], 1);
+            gcov_buf_add(&d->tu_known, &received, 1);
+            continue;
+        }
+        known = &d->tu_known.data[at];
+        if (*known == MISSING) {
+            d->tu_data.data[at] = bytes[i];
+            *known = RECEIVED;
+            d->tu_missing--;
+        } else if (*known == RECEIVED && d->tu_data.data[at] != bytes[i]) {
+            *known = CONFLICT;
+            d->tu_missing++;
+        }
+    }
+}
+
+/* Whether a line may be the filename line of a file: a .gcda name alone */
+static int filename_line(const char *line)
+{
+    size_t len = strlen(line);
+
+    return len > 5 && strcmp(line + len - 5, ".gcda") == 0 && !strchr(line, ' ');
+}
+
+static void do_line(GcovDecoder *d, char *line)
+{
+    char *p;
+    char *q = line;
+    unsigned bytes;
+    char name[GCOV_HOST_MAX_LINE];
+
+    /* drop carriage returns (and NULs, already made into them) */
+    for (p = line; *p; p++) {
+        if (*p != '\r') *q++ = *p;
+    }
+    *q = '\0';
+
+    if ((p = strstr(line, "Emitting ")) != NULL
+        && sscanf(p, "Emitting %u bytes for %4095s", &bytes, name) == 2) {
+        finish_tu(d, "no filename line");
+        start_tu(d, name, bytes);
+        return;
+    }
+    if (strstr(line, "__gcov_init")) {
+        /* target restarted, so a dump in progress was cut short */
+        finish_tu(d, "target restarted");
+        if (d->files_written || d->files_salvaged || d->files_skipped) {
+            skip_file(d, "rest of dump", "target restarted");
+            dump_end(d);
+        }
+        return;
+    }
+    if (strstr(line, "Gcov End")) {
+        dump_end(d);
+        return;
+    }
+    if (d->tu_active && ((d->tu_name && strcmp(line, d->tu_name) == 0) || filename_line(line))) {
+        /* (if the name differs, the filename line is garbled, the name of the Emitting line holds) */
+        if (!d->tu_name) {
+            d->tu_name = strdup(line);
+        }
+        finish_tu(d, NULL);
+        return;
+    }
+    do_hexdump(d, line);
+}
+
+/* ----------------------------------------------------------- */
+/* Binary format, file by file (compare to tools/gcov_unpack.c) */
+
+static unsigned field(const unsigned char *p)
+{
+    return ((unsigned)p[0] << 24) | ((unsigned)p[1] << 16) | ((unsigned)p[2] << 8) | p[3];
+}
+
+static unsigned field_le(const unsigned char *p)
+{
+    return ((unsigned)p[3] << 24) | ((unsigned)p[2] << 16) | ((unsigned)p[1] << 8) | p[0];
+}
+
+/* Whether data starts with the gcda magic, in either byte order */
+static int gcda_magic(const unsigned char *p)
+{
+    return field(p) == GCOV_HOST_DATA_MAGIC || field_le(p) == GCOV_HOST_DATA_MAGIC;
+}
+
+enum { NEED_MORE, FRAME, END, DAMAGED, RESYNC };
+
+static size_t sound_length(const unsigned char *data, size_t bytes);
+static const unsigned char *name_start(GcovDecoder *d, const unsigned char *line, const unsigned char *nul);
+
+/*
+ * Offset of the next file of binary format within the data of a file,
+ * which is there if the byte count of the file was damaged, or the target
+ * restarted in the middle of the file (bytes if none).
+ */
+static size_t frame_within(GcovDecoder *d, const unsigned char *data, size_t bytes)
+{
+    const unsigned char *nul;
+
+    for (nul = data; (nul = memchr(nul, '\0', bytes - (size_t)(nul - data))) != NULL; nul++) {
+        if (nul - data >= 6 && memcmp(nul - 5, ".gcda", 5) == 0
+            && bytes - (size_t)(nul - data) >= 1 + 8 && field(nul + 1) && gcda_magic(nul + 5)) {
+            return (size_t)(name_start(d, data, nul) - data);
+        }
+    }
+    return bytes;
+}
+
+/*
+ * Take a file of GCOV_OPT_PACK_CONDITIONS, whose data (have bytes so far)
+ * starts at offset start, unpacked to bytes bytes. Returns as do_frame,
+ * but with no file within it to look for, as that is not of the packed data.
+ */
+static int do_packed(GcovDecoder *d, const char *name, const unsigned char *data, size_t have, unsigned bytes,
+                     size_t *pos, size_t start, size_t *need, int at_eof)
+{
+    size_t used;
+    int got = gcov_gcda_unpack(data, have, bytes, &d->unpacked, &used);
+    char damage[128];
+
+    if (got == 0 && !at_eof) {
+        /* each 8 bytes still to unpack take at least 1 more */
+        *need = start + used + (bytes - d->unpacked.len + 7) / 8;
+        if (*need <= start + have) {
+            *need = start + have + 1;
+        }
+        return NEED_MORE;
+    }
+    free(d->last_name);
+    d->last_name = strdup(name);
+    *pos = start + used;
+    if (got > 0) {
+        take_file(d, name, d->unpacked.data, NULL, d->unpacked.len, NULL);
+        return FRAME;
+    }
+    if (got == 0) {
+        snprintf(damage, sizeof(damage), "cut short, have %zu of %u bytes unpacked", d->unpacked.len, bytes);
+    } else {
+        snprintf(damage, sizeof(damage), "packed data damaged after %zu of %u bytes", d->unpacked.len, bytes);
+    }
+    take_file(d, name, d->unpacked.data, NULL, d->unpacked.len, damage);
+    return RESYNC;
+}
+
+/*
+ * Take one file (or the end marker) of binary format at *pos.
+ * Sets *need to the length needed if NEED_MORE.
+ * A file with damaged records is salvaged, then returns FRAME to go on
+ * at a file within it, else RESYNC to go on from where its records broke.
+ * At the end of input, a file cut short is salvaged too.
+ */
+static int do_frame(GcovDecoder *d, const unsigned char *p, size_t len, size_t *pos, size_t *need, int at_eof)
+{
+    const unsigned char *nul = memchr(p + *pos, '\0', len - *pos);
+    const char *name = (const char *)p + *pos;
+    const unsigned char *data;
+    const char *why;
+    size_t after, have, inner;
+    unsigned bytes;
+    int packed;
+    char damage[128];
+
+    if (!nul) {
+        if (len - *pos > GCOV_HOST_MAX_LINE) {
+            return DAMAGED;
+        }
+        *need = len + 1;
+        return NEED_MORE;
+    }
+    after = (size_t)(nul - p) + 1;
+    if (strcmp(name, "Gcov End") == 0) {
+        *pos = after;
+        return END;
+    }
+    if (len < after + 8) {
+        *need = after + 8;
+        return NEED_MORE;
+    }
+    bytes = field(p + after);
+    packed = (bytes & GCOV_HOST_PACKED_FILE) != 0;
+    bytes &= ~GCOV_HOST_PACKED_FILE;
+    if (bytes && !gcda_magic(p + after + 4)) {
+        return DAMAGED;
+    }
+    data = p + after + 4;
+    have = len - (after + 4);
+    if (packed) {
+        return do_packed(d, name, data, have, bytes, pos, after + 4, need, at_eof);
+    }
+    if (have < bytes && !at_eof) {
+        *need = after + 4 + bytes;
+        return NEED_MORE;
+    }
+    free(d->last_name);
+    d->last_name = strdup(name);
+    if (!bytes) {
+        found_file(d, name, data, bytes);
+        *pos = after + 4;
+        return FRAME;
+    }
+
+    if (have > bytes) {
+        have = bytes;
+    }
+    if (have < bytes) {
+        snprintf(damage, sizeof(damage), "cut short, have %zu of %u bytes", have, bytes);
+    } else if ((why = gcov_gcda_check(data, have)) != NULL) {
+        snprintf(damage, sizeof(damage), "%s", why);
+    } else {
+        take_file(d, name, data, NULL, have, NULL);
+        *pos = after + 4 + have;
+        return FRAME;
+    }
+    inner = frame_within(d, data, have);
+    take_file(d, name, data, NULL, inner, damage);
+    if (inner < have) {
+        /* the target may have restarted, so the dump in progress was cut short */
+        size_t sound = sound_length(data, inner);
+        static const char restart[] = "__gcov_init";
+
+        for (size_t at = sound; at + sizeof(restart) - 1 <= inner; at++) {
+            if (memcmp(data + at, restart, sizeof(restart) - 1) == 0) {
+                skip_file(d, "rest of dump", "target restarted");
+                dump_end(d);
+                break;
+            }
+        }
+        *pos = after + 4 + inner;
+        return FRAME;
+    }
+    *pos = after + 4 + sound_length(data, have);
+    return RESYNC;
+}
+
+/* Take the files of a plain binary dump, returns bytes used */
+static size_t do_binary(GcovDecoder *d, const unsigned char *p, size_t len, int at_eof)
+{
+    size_t pos = 0;
+    size_t need;
+    int got;
+
+    while ((got = do_frame(d, p, len, &pos, &need, at_eof)) == FRAME) {
+    }
+    if (got == END) {
+        d->mode = TEXT;
+        dump_end(d);
+    } else if (got == DAMAGED) {
+        skip_file(d, "binary output", "damaged, resyncing at the next file");
+        d->mode = TEXT;
+    } else if (got == RESYNC) {
+        d->mode = TEXT;
+    }
+    return pos;
+}
+
+/* Decompress GCOV_OPT_COMPRESS_LZ output as it arrives, returns bytes used */
+static size_t do_compressed(GcovDecoder *d, const unsigned char *p, size_t len)
+{
+    GcovBuf *plain = &d->plain;
+    size_t used = 0;
+    size_t need;
+    int got;
+
+    while (used < len) {
+        unsigned char c = p[used++];
+
+        if (d->lz_item == 8) {
+            d->lz_flags = c;
+            d->lz_item = 0;
+            continue;
+        }
+        if (!(d->lz_flags & (1u << d->lz_item))) {
+            gcov_buf_add(plain, &c, 1);
+        } else if (d->lz_first < 0) {
+            d->lz_first = c;
+            continue;
+        } else {
+            unsigned offset = ((unsigned)d->lz_first << 4) | (c >> 4);
+            unsigned count = (c & 15) + 3;
+
+            d->lz_first = -1;
+            if (offset == 0 || offset > plain->len) {
+                /* (no way to resync within compressed data) */
+                skip_file(d, "compressed output", "damaged, rest of dump lost");
+                d->mode = TEXT;
+                return used;
+            }
+            for (unsigned i = 0; i < count; i++) {
+                unsigned char b = plain->data[plain->len - offset];
+
+                gcov_buf_add(plain, &b, 1);
+            }
+        }
+        d->lz_item++;
+
+        /* take each file as soon as it is complete, and stop at the end */
+        while (plain->len >= d->plain_need) {
+            got = do_frame(d, plain->data, plain->len, &d->plain_pos, &need, 0);
+            if (got == NEED_MORE) {
+                d->plain_need = need;
+            } else if (got == END) {
+                d->mode = TEXT;
+                dump_end(d);
+                return used;
+            } else if (got == DAMAGED || got == RESYNC) {
+                skip_file(d, "compressed output", "damaged, rest of dump lost");
+                d->mode = TEXT;
+                return used;
+            }
+        }
+    }
+    return used;
+}
+
+/*
+ * Start of a name in binary format that ends at nul: the printable chars
+ * before it, from the directory of the last name if that is among them
+ * (as the bytes before may happen to be printable too).
+ */
+static const unsigned char *name_start(GcovDecoder *d, const unsigned char *line, const unsigned char *nul)
+{
+    const unsigned char *start = nul;
+    const char *slash = d->last_name ? strrchr(d->last_name, '/') : NULL;
+
+    while (start > line && start[-1] >= 0x20 && start[-1] < 0x7f) {
+        start--;
+    }
+    if (slash) {
+        size_t dir_len = (size_t)(slash - d->last_name) + 1;
+
+        for (const unsigned char *q = start; q + dir_len <= nul; q++) {
+            if (memcmp(q, d->last_name, dir_len) == 0) {
+                return q;
+            }
+        }
+    }
+    return start;
+}
+
+/*
+ * Check a line for binary format: at its beginning, the compressed header,
+ * or anywhere in it (to resync after damage, or a reboot in a dump),
+ * a filename ending in .gcda with trailing null char, its byte count,
+ * and gcda data.
+ * Returns 1 if so (and sets mode, and *skip to where it starts),
+ * 0 if not, -1 if cannot tell yet.
+ */
+static int binary_start(GcovDecoder *d, const unsigned char *p, size_t len, size_t *skip)
+{
+    const unsigned char *nul;
+    const unsigned char *nl;
+    const unsigned char *end;
+
+    *skip = 0;
+
+    if (len >= 4 && memcmp(p, "GcvZ", 4) == 0) {
+        if (len < 5) {
+            return -1;
+        }
+        if (p[4] > 12) {
+            return 0;
+        }
+        d->mode = COMPRESSED;
+        d->plain.len = 0;
+        d->plain_pos = 0;
+        d->plain_need = 1;
+        d->lz_item = 8;
+        d->lz_first = -1;
+        return 1;
+    }
+    /* (filename in this line only, so each line is scanned once) */
+    nl = memchr(p, '\n', len);
+    end = nl ? nl : p + len;
+    for (nul = p; (nul = memchr(nul, '\0', (size_t)(end - nul))) != NULL; nul++) {
+        const unsigned char *start;
+
+        if (nul - p < 5 || memcmp(nul - 5, ".gcda", 5) != 0) {
+            continue;
+        }
+        if ((size_t)(p + len - nul) < 1 + 8) {
+            return -1;
+        }
+        if (!field(nul + 1) || !gcda_magic(nul + 5)) {
+            continue; // (not an empty file, that may be a filename line and NULs of a reboot)
+        }
+        start = name_start(d, p, nul);
+        if (nul - start < 5 + 1) {
+            continue;
+        }
+        *skip = (size_t)(start - p);
+        d->mode = BINARY;
+        return 1;
+    }
+    return (nl || len > GCOV_HOST_MAX_LINE) ? 0 : -1;
+}
+
+/* Take what input there is, returns bytes used (the rest waits for more) */
+static size_t do_input(GcovDecoder *d, unsigned char *p, size_t len, int at_eof)
+{
+    size_t pos = 0;
+
+    while (pos < len) {
+        if (d->mode == BINARY) {
+            pos += do_binary(d, p + pos, len - pos, at_eof);
+            if (d->mode == BINARY) {
+                break; // wait for more
+            }
+        } else if (d->mode == COMPRESSED) {
+            pos += do_compressed(d, p + pos, len - pos);
+            if (d->mode == COMPRESSED) {
+                break; // all used, wait for more
+            }
+        } else {
+            unsigned char *nl;
+            size_t skip;
+            int bin = binary_start(d, p + pos, len - pos, &skip);
+
+            if (bin > 0) {
+                pos += (d->mode == COMPRESSED) ? 5 : skip;
+                continue;
+            }
+            if (bin < 0 && !at_eof) {
+                break;
+            }
+            nl = memchr(p + pos, '\n', len - pos);
+            if (!nl) {
+                if (len - pos > GCOV_HOST_MAX_LINE) {
+                    /* overlong junk line, but keep what may be the start of a name */
+                    pos = len - GCOV_HOST_MAX_LINE;
+                }
+                break;
+            }
+            /* serial logs can have NULs after a reboot, do not let them cut lines short */
+            for (unsigned char *q = p + pos; q < nl; q++) {
+                if (*q == '\0') *q = '\r';
+            }
+            *nl = '\0';
+            do_line(d, (char *)p + pos);
+            pos = (size_t)(nl - p) + 1;
+        }
+        if (gcov_decoder_idle(d)) {
+            d->resume = d->offset + pos;
+        }
+    }
+    return pos;
+}
+
+GcovDecoder *gcov_decoder_new(const GcovDecoderCallbacks *cb, void *ctx)
+{
+    GcovDecoder *d = calloc(1, sizeof(*d));
+
+    if (!d) {
+        perror("calloc");
+        exit(1);
+    }
+    d->cb = *cb;
+    d->ctx = ctx;
+    d->mode = TEXT;
+    d->lz_item = 8;
+    d->lz_first = -1;
+    return d;
+}
+
+void gcov_decoder_free(GcovDecoder *d)
+{
+    if (d) {
+        free(d->in.data);
+        free(d->tu_name);
+        free(d->tu_data.data);
+        free(d->tu_known.data);
+        free(d->last_name);
+        free(d->plain.data);
+        free(d->unpacked.data);
+        free(d);
+    }
+}
+
+void gcov_decoder_feed(GcovDecoder *d, const unsigned char *data, size_t len)
+{
+    size_t used;
+
+    gcov_buf_add(&d->in, data, len);
+    used = do_input(d, d->in.data, d->in.len, 0);
+    memmove(d->in.data, d->in.data + used, d->in.len - used);
+    d->in.len -= used;
+    d->offset += used;
+}
+
+int gcov_decoder_finish(GcovDecoder *d)
+{
+    /* whatever is left, such as a last line without newline */
+    if (d->in.len) {
+        if (d->mode != BINARY) {
+            gcov_buf_add(&d->in, "\n", 1);
+        }
+        (void)do_input(d, d->in.data, d->in.len, 1);
+        d->offset += d->in.len;
+        d->in.len = 0;
+    }
+    /* and a compressed file cut short */
+    if (d->mode == COMPRESSED && d->plain_pos < d->plain.len) {
+        size_t need;
+
+        (void)do_frame(d, d->plain.data, d->plain.len, &d->plain_pos, &need, 1);
+    }
+    return gcov_decoder_idle(d);
+}
+
+void gcov_decoder_reset(GcovDecoder *d)
+{
+    d->in.len = 0;
+    d->offset = 0;
+    d->resume = 0;
+    d->mode = TEXT;
+    drop_tu(d);
+}
+
+int gcov_decoder_idle(const GcovDecoder *d)
+{
+    return d->mode == TEXT && !d->tu_name;
+}
+
+unsigned long long gcov_decoder_offset(const GcovDecoder *d)
+{
+    return d->offset;
+}
+
+unsigned long long gcov_decoder_resume_offset(const GcovDecoder *d)
+{
+    return d->resume;
+}
+
+/* ----------------------------------------------------------- */
+/* gcda data */
+
+/* Counter types, in the order of gcc/gcov-counter.def for GCC 10 and later */
+enum {
+    CTR_ARCS, CTR_INTERVAL, CTR_POW2, CTR_TOPN, CTR_INDIRECT,
+    CTR_AVERAGE, CTR_IOR, CTR_TIME_PROFILER, CTR_CONDITIONS
+};
+
+static unsigned word(const unsigned char *p, int le)
+{
+    return le ? field_le(p) : field(p);
+}
+
+static unsigned long long counter(const unsigned char *p, int le)
+{
+    /* low word first */
+    return ((unsigned long long)word(p + 4, le) << 32) | word(p, le);
+}
+
+static void set_counter(unsigned char *p, int le, unsigned long long v)
+{
+    for (int i = 0; i < 4; i++) {
+        unsigned lo = (unsigned)v;
+        unsigned hi = (unsigned)(v >> 32);
+        int shift = le ? 8 * i : 24 - 8 * i;
+
+        p[i] = (unsigned char)(lo >> shift);
+        p[4 + i] = (unsigned char)(hi >> shift);
+    }
+}
+
+/* Counter type of a record tag, or -1 if not a counter tag */
+static int counter_kind(unsigned tag)
+{
+    if (tag < GCOV_HOST_TAG_COUNTER_BASE || (tag - GCOV_HOST_TAG_COUNTER_BASE) & ((1u << 17) - 1)) {
+        return -1;
+    }
+    return (int)((tag - GCOV_HOST_TAG_COUNTER_BASE) >> 17);
+}
+
+/* Whether a record tag is a function or counter record, that the tools use */
+static int known_record(unsigned tag)
+{
+    return tag == GCOV_HOST_TAG_FUNCTION || (counter_kind(tag) >= 0 && counter_kind(tag) < 32);
+}
+
+/* Check the record structure, setting *sound to the length that is sound.
+ * Other records (such as the object summary of libgcov and gcov-tool)
+ * are skipped whole, as gcov does. */
+static const char *check_records(const unsigned char *data, size_t bytes, size_t *sound)
+{
+    size_t pos = 16;
+    int have_function = 0;
+    int le;
+
+    *sound = 0;
+
+    if (bytes < 16) {
+        return "too short for a gcda header";
+    }
+    if (bytes % 4) {
+        return "not whole words";
+    }
+    if (!gcda_magic(data)) {
+        return "no gcda magic";
+    }
+    le = (field_le(data) == GCOV_HOST_DATA_MAGIC);
+    *sound = pos;
+    while (pos < bytes) {
+        unsigned tag, length;
+
+        if (bytes - pos < 8) {
+            /* as libgcov ends the data, with a zero word */
+            if (bytes - pos == 4 && word(data + pos, le) == 0) {
+                *sound = bytes;
+                break;
+            }
+            return "record header cut short";
+        }
+        tag = word(data + pos, le);
+        length = word(data + pos + 4, le);
+        if (length > bytes - pos - 8) {
+            return "record runs past the end";
+        }
+        if (tag == GCOV_HOST_TAG_FUNCTION) {
+            /* libgcov writes an empty one for a function of another object */
+            if (length != 12 && length != 0) {
+                return "function record of wrong length";
+            }
+            have_function = (length == 12);
+        } else if (known_record(tag)) {
+            if (!have_function) {
+                return "counter record before any function";
+            }
+            if (length % 8) {
+                return "counter record of odd length";
+            }
+        }
+        pos += 8 + length;
+        *sound = pos;
+    }
+    return NULL;
+}
+
+static size_t sound_length(const unsigned char *data, size_t bytes)
+{
+    size_t sound;
+
+    return check_records(data, bytes, &sound) ? sound : bytes;
+}
+
+const char *gcov_gcda_check(const unsigned char *data, size_t bytes)
+{
+    size_t sound;
+
+    return check_records(data, bytes, &sound);
+}
+
+/* Whether bytes [at, at + n) were all received */
+static int all_known(const unsigned char *known, size_t at, size_t n)
+{
+    if (known) {
+        for (size_t i = 0; i < n; i++) {
+            if (known[at + i] != RECEIVED) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Whether a function record header starts at pos */
+static int function_at(const unsigned char *data, const unsigned char *known, size_t bytes, size_t pos, int le)
+{
+    return bytes - pos >= 20 && all_known(known, pos, 8)
+        && word(data + pos, le) == GCOV_HOST_TAG_FUNCTION && word(data + pos + 4, le) == 12;
+}
+
+unsigned gcov_gcda_salvage(const unsigned char *data, const unsigned char *known, size_t bytes,
+                           GcovBuf *out, unsigned *dropped, size_t *lost)
+{
+    size_t pos = 16;
+    unsigned kept = 0;
+    int le;
+
+    out->len = 0;
+    *dropped = 0;
+    *lost = 0;
+    bytes &= ~(size_t)3;
+    if (bytes < 16 || !all_known(known, 0, 16) || !gcda_magic(data)) {
+        *lost = bytes;
+        return 0; // without the header, nothing can be used
+    }
+    le = (field_le(data) == GCOV_HOST_DATA_MAGIC);
+    gcov_buf_add(out, data, 16);
+
+    while (pos < bytes) {
+        size_t end = pos + 20;
+        int sound;
+        int counters = 0;
+
+        if (!function_at(data, known, bytes, pos, le)) {
+            /* resync at the next function record, word by word */
+            *lost += 4;
+            pos += 4;
+            continue;
+        }
+
+        /* the function record, then its counter records */
+        sound = all_known(known, pos + 8, 12);
+        while (bytes - end >= 8 && all_known(known, end, 8)) {
+            unsigned length = word(data + end + 4, le);
+            int kind = counter_kind(word(data + end, le));
+
+            if (kind < 0 || kind >= 32 || length % 8 || length > bytes - end - 8) {
+                break;
+            }
+            sound = sound && all_known(known, end + 8, length);
+            end += 8 + length;
+            counters++;
+        }
+        /* and complete only if the next function (or the end) follows */
+        if (!counters || (end < bytes && !function_at(data, known, bytes, end, le))) {
+            sound = 0;
+        }
+        if (sound) {
+            gcov_buf_add(out, data + pos, end - pos);
+            kept++;
+        } else {
+            (*dropped)++;
+            *lost += end - pos;
+        }
+        pos = end;
+    }
+    return kept;
+}
+
+const char *gcov_gcda_merge(unsigned char *into, size_t into_bytes, const unsigned char *from, size_t from_bytes)
+{
+    int le = (field_le(into) == GCOV_HOST_DATA_MAGIC);
+    unsigned into_checksum = word(into + 12, le);
+    unsigned from_checksum = word(from + 12, le);
+    size_t i, f;
+
+    /* a checksum of 0 is not known (as from gcov_carry), and matches any */
+    if (memcmp(into, from, 12) != 0 || (into_checksum && from_checksum && into_checksum != from_checksum)) {
+        return "different version, stamp, or checksum (not the same build)";
+    }
+
+    /* each record of from must match one of into (other than counter values)
+     * before anything changes; into may have functions that from lacks */
+    for (int merge = 0; merge < 2; merge++) {
+        for (i = 16, f = 16; f + 8 <= from_bytes; ) {
+            unsigned tag = word(from + f, le);
+            unsigned length = word(from + f + 4, le);
+            int kind = counter_kind(tag);
+
+            /* other records are not merged, as gcov does not use them */
+            if (!known_record(tag)) {
+                f += 8 + length;
+                continue;
+            }
+            while (i + 8 <= into_bytes && !known_record(word(into + i, le))) {
+                i += 8 + word(into + i + 4, le);
+            }
+            if (tag == GCOV_HOST_TAG_FUNCTION) {
+                while (i + 8 <= into_bytes
+                       && (into_bytes - i < 8 + length || memcmp(into + i, from + f, 8 + length) != 0)) {
+                    i += 8 + word(into + i + 4, le);
+                }
+                if (i + 8 > into_bytes) {
+                    return "different functions (not the same build)";
+                }
+            } else if (i + 8 > into_bytes || memcmp(into + i, from + f, 8) != 0) {
+                return "different records (not the same build)";
+            } else if (merge && kind != CTR_TOPN && kind != CTR_INDIRECT) {
+                for (size_t at = 8; at < 8 + length; at += 8) {
+                    unsigned long long a = counter(into + i + at, le);
+                    unsigned long long b = counter(from + f + at, le);
+
+                    if (kind == CTR_IOR || kind == CTR_CONDITIONS) {
+                        a |= b;
+                    } else if (kind == CTR_TIME_PROFILER) {
+                        a = (a == 0 || (b != 0 && b < a)) ? b : a;
+                    } else {
+                        a += b;
+                    }
+                    set_counter(into + i + at, le, a);
+                }
+            }
+            i += 8 + length;
+            f += 8 + length;
+        }
+    }
+    if (!into_checksum) {
+        memcpy(into + 12, from + 12, 4);
+    }
+    return NULL;
+}
+
+int gcov_gcda_unpack(const unsigned char *in, size_t in_len, size_t bytes, GcovBuf *out, size_t *used)
+{
+    size_t pos = 16;
+    int le;
+
+    out->len = 0;
+    *used = 0;
+    if (bytes < 16 || bytes % 4) {
+        return -1;
+    }
+    if (in_len < 16) {
+        return 0;
+    }
+    if (!gcda_magic(in)) {
+        return -1;
+    }
+    le = (field_le(in) == GCOV_HOST_DATA_MAGIC);
+    gcov_buf_add(out, in, 16);
+    *used = pos;
+
+    while (out->len < bytes) {
+        size_t record = out->len;
+        unsigned tag, length;
+        unsigned char head[8];
+
+        if (bytes - out->len < 8) {
+            return -1;
+        }
+        if (in_len - pos < 8) {
+            return 0;
+        }
+        tag = word(in + pos, le);
+        length = word(in + pos + 4, le);
+        if (length % 4 || length > bytes - out->len - 8) {
+            return -1;
+        }
+        if (tag != GCOV_HOST_TAG_PACKED_CONDITIONS) {
+            if (in_len - pos - 8 < length) {
+                return 0;
+            }
+            gcov_buf_add(out, in + pos, 8 + length);
+            pos += 8 + length;
+            *used = pos;
+            continue;
+        }
+
+        /* the counters as LEB128 numbers, back to low word then high word */
+        if (length % 8) {
+            return -1;
+        }
+        set_counter(head, le, ((unsigned long long)length << 32) | GCOV_HOST_TAG_CONDITIONS);
+        gcov_buf_add(out, head, 8);
+        pos += 8;
+        for (unsigned n = 0; n < length / 8; n++) {
+            unsigned long long value = 0;
+            unsigned shift = 0;
+            unsigned char c;
+
+            do {
+                if (pos == in_len) {
+                    out->len = record;
+                    return 0;
+                }
+                if (shift >= 64) {
+                    out->len = record;
+                    return -1;
+                }
+                c = in[pos++];
+                value |= (unsigned long long)(c & 0x7f) << shift;
+                shift += 7;
+            } while (c & 0x80);
+            set_counter(head, le, value);
+            gcov_buf_add(out, head, 8);
+        }
+        *used = pos;
+    }
+    return 1;
+}
+
+int gcov_write_whole(const char *path, const void *data, size_t bytes)
+{
+    char tmp[4096 + 8];
+    FILE *f;
+    int err;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    f = fopen(tmp, "wb");
+    if (!f) {
+        return -1;
+    }
+    if (fwrite(data, 1, bytes, f) != bytes) {
+        err = errno;
+        fclose(f);
+        remove(tmp);
+        errno = err;
+        return -1;
+    }
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        err = errno;
+        remove(tmp);
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+/* ----------------------------------------------------------- */
+/* Local socket transport */
+
+/* Open a socket for addr and bind or connect it, returns -1 if cannot */
+static int host_socket(const char *addr, int server)
+{
+    int fd;
+
+    if (strchr(addr, '/')) {
+        struct sockaddr_un sun;
+
+        if (strlen(addr) >= sizeof(sun.sun_path)) {
+            fprintf(stderr, "%s: socket path too long\n", addr);
+            return -1;
+        }
+        memset(&sun, 0, sizeof(sun));
+        sun.sun_family = AF_UNIX;
+        strcpy(sun.sun_path, addr);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            perror("socket");
+            return -1;
+        }
+        if (server) {
+            unlink(addr); // left by a previous run
+        }
+        if ((server ? bind(fd, (struct sockaddr *)&sun, sizeof(sun))
+                    : connect(fd, (struct sockaddr *)&sun, sizeof(sun))) != 0) {
+            perror(addr);
+            close(fd);
+            return -1;
+        }
+    } else {
+        char host[256] = "127.0.0.1";
+        const char *port = addr;
+        const char *colon = strrchr(addr, ':');
+        struct addrinfo hints, *ai;
+        int got, one = 1;
+
+        if (colon) {
+            snprintf(host, sizeof(host), "%.*s", (int)(colon - addr), addr);
+            port = colon + 1;
+        }
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        got = getaddrinfo(host, port, &hints, &ai);
+        if (got != 0) {
+            fprintf(stderr, "%s: %s\n", addr, gai_strerror(got));
+            return -1;
+        }
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            perror("socket");
+            freeaddrinfo(ai);
+            return -1;
+        }
+        if (server) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        }
+        if ((server ? bind(fd, ai->ai_addr, ai->ai_addrlen)
+                    : connect(fd, ai->ai_addr, ai->ai_addrlen)) != 0) {
+            perror(addr);
+            close(fd);
+            freeaddrinfo(ai);
+            return -1;
+        }
+        freeaddrinfo(ai);
+    }
+    return fd;
+}
+
+int gcov_host_listen(const char *addr)
+{
+    int fd = host_socket(addr, 1);
+
+    if (fd >= 0 && listen(fd, 64) != 0) {
+        perror(addr);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int gcov_host_connect(const char *addr)
+{
+    return host_socket(addr, 0);
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_host.c host tool code to decode and merge gcov output
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
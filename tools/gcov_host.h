@@ -0,0 +1,181 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool interface to decode and merge gcov output.
+ *
+ * Shared by the host tools that take target output as it arrives
+ * (gcov_ingest, gcov_aggregate), so that each recognizes exactly
+ * the same hexdump, binary, and compressed binary formats.
+ *
+ **********************************************************************/
+
+#ifndef GCOV_HOST_H
+#define GCOV_HOST_H GCOV_HOST_H
+
+#include <stddef.h>
+
+/* Longest text line, or filename in binary format, before it is junk */
+#define GCOV_HOST_MAX_LINE 4096
+
+#define GCOV_HOST_DATA_MAGIC 0x67636461
+#define GCOV_HOST_TAG_FUNCTION 0x01000000
+#define GCOV_HOST_TAG_COUNTER_BASE 0x01a10000
+#define GCOV_HOST_TAG_CONDITIONS 0x01b10000
+
+/* Of GCOV_OPT_PACK_CONDITIONS: marks the byte count of a packed file,
+ * and tags its condition counter records, packed as LEB128 numbers */
+#define GCOV_HOST_PACKED_FILE 0x80000000u
+#define GCOV_HOST_TAG_PACKED_CONDITIONS (GCOV_HOST_TAG_CONDITIONS + 1)
+
+/* Growable byte buffer, exits if out of memory */
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+} GcovBuf;
+
+void gcov_buf_add(GcovBuf *b, const void *p, size_t n);
+
+/* What a decoder found, called as soon as it is found */
+typedef struct {
+    /* a complete .gcda file, by its target filename */
+    void (*file)(void *ctx, const char *filename, const unsigned char *data, size_t bytes);
+    /* the complete functions of a damaged .gcda file (see gcov_gcda_salvage), and what was lost */
+    void (*salvaged)(void *ctx, const char *filename, const unsigned char *data, size_t bytes,
+                     const char *lost);
+    /* a file (or a stretch of binary output) that could not be used */
+    void (*skip)(void *ctx, const char *filename, const char *why);
+    /* "Gcov End", with the counts of files in that dump */
+    void (*end)(void *ctx, unsigned written, unsigned salvaged, unsigned skipped);
+} GcovDecoderCallbacks;
+
+typedef struct GcovDecoder GcovDecoder;
+
+/*
+ * Decoder of one stream of target output, which may hold
+ * GCOV_OPT_OUTPUT_SERIAL_HEXDUMP output amid other output of the target,
+ * binary format (starting at the beginning of a line), and
+ * binary format compressed by GCOV_OPT_COMPRESS_LZ.
+ * Tolerates damage, such as from reboots or a noisy link: hexdump lines
+ * lost, repeated, or garbled, a lost Emitting or filename line, or
+ * damaged binary format (resyncing at the next file), and salvages
+ * what is complete of a damaged file.
+ * Not thread safe, but separate decoders may run in separate threads.
+ */
+GcovDecoder *gcov_decoder_new(const GcovDecoderCallbacks *cb, void *ctx);
+void gcov_decoder_free(GcovDecoder *d);
+
+/* Take more input; a partial line or file is kept until the rest arrives */
+void gcov_decoder_feed(GcovDecoder *d, const unsigned char *data, size_t len);
+
+/* End of input (takes a last line without newline),
+ * returns 1 if it ended between dumps or between hexdump files, else 0 */
+int gcov_decoder_finish(GcovDecoder *d);
+
+/* Drop the input kept and any file in progress, such as for a truncated log */
+void gcov_decoder_reset(GcovDecoder *d);
+
+/* Whether between dumps or between hexdump files, where a restart may resume */
+int gcov_decoder_idle(const GcovDecoder *d);
+
+/* Count of input bytes fully taken (since new or reset) */
+unsigned long long gcov_decoder_offset(const GcovDecoder *d);
+
+/* Count of input bytes up to the last idle point (since new or reset) */
+unsigned long long gcov_decoder_resume_offset(const GcovDecoder *d);
+
+/*
+ * gcda data as written by gcov_convert_to_gcda (code/gcov_gcc.c):
+ * header of magic, version, stamp, checksum, then for each function
+ * a function record and a counter record for each counter type used,
+ * all in 32-bit words of the target's byte order.
+ */
+
+/* Check the record structure, returns NULL if usable, else why not */
+const char *gcov_gcda_check(const unsigned char *data, size_t bytes);
+
+/*
+ * Keep the complete function records of damaged gcda data: each function
+ * record whose counter records are all there, resyncing at the next
+ * function record after anything damaged.
+ * known is NULL if every byte was received, else 1 for each byte received.
+ * Puts the header and the functions kept in out, returns the count kept,
+ * with the count of functions dropped and bytes not used.
+ */
+unsigned gcov_gcda_salvage(const unsigned char *data, const unsigned char *known, size_t bytes,
+                           GcovBuf *out, unsigned *dropped, size_t *lost);
+
+/*
+ * Merge the counters of from into into, both checked by gcov_gcda_check.
+ * They must be of the same build: the same stamp, checksum, and records,
+ * except that from may lack functions of into (as when salvaged).
+ * A checksum of 0 is not known (as in gcov_carry output) and matches any,
+ * into then taking the checksum of from.
+ * Merges as libgcov does (GCC 10 and later counter types): adds arcs,
+ * interval, pow2 and average counters, ORs ior and condition counters,
+ * keeps the earliest nonzero time profile, and keeps the values of into
+ * for top-n value and indirect call counters (which do not simply merge).
+ * Returns NULL if merged, else why not (into is then unchanged).
+ */
+const char *gcov_gcda_merge(unsigned char *into, size_t into_bytes, const unsigned char *from, size_t from_bytes);
+
+/*
+ * Unpack the data of a file packed by GCOV_OPT_PACK_CONDITIONS (whose
+ * byte count has GCOV_HOST_PACKED_FILE set, here bytes without it)
+ * from in into out, as the gcda data it was before.
+ * Sets *used to the bytes of in taken, for the whole records in out.
+ * Returns 1 if complete, 0 if in ends first (out then has the whole
+ * records before that), -1 if damaged.
+ */
+int gcov_gcda_unpack(const unsigned char *in, size_t in_len, size_t bytes, GcovBuf *out, size_t *used);
+
+/* Write through a temporary name, so a file is either complete or absent,
+ * returns 0, or -1 with errno set */
+int gcov_write_whole(const char *path, const void *data, size_t bytes);
+
+/*
+ * Local socket transport: addr is a Unix socket path (anything with a '/'),
+ * or [host:]port for TCP, host 127.0.0.1 if not given.
+ * Return a socket, or -1 after printing why not.
+ */
+int gcov_host_listen(const char *addr);
+int gcov_host_connect(const char *addr);
+
+#endif /* GCOV_HOST_H */
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_host.h host tool interface to decode and merge gcov output
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,687 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool to index the .gcno notes of a build, and query the index.
+ *
+ * Compiles the .gcno notes of a build (as moved into objs/) once
+ * into a single index file (see tools/gcov_notes.h), which host tools
+ * map into memory and query without parsing the notes again:
+ * function by .gcda file and ident, or by name, each with its source
+ * file, line range, checksums, arcs, and lines.
+ * Building again is instant if no .gcno file has changed,
+ * so it can go in front of every analysis of a build.
+ *
+ * Also makes the zero-coverage baseline of a build straight from the
+ * index, instead of lcov --capture --initial running gcov on every
+ * .gcno file, and keeps it by the build ID of the index, so it is made
+ * once per build however many times the lcov scripts ask for it
+ * (see scripts/lcov_baseline.sh).
+ *
+ * Typical usage:
+ *   ./gcov_index -o ../results/notes.gcidx ../objs
+ *   ./gcov_index -i ../results/notes.gcidx -n gcov_convert_to_gcda
+ *   ./gcov_index -i ../results/notes.gcidx -g ../objs/example-example.gcda
+ *   ./gcov_index -i ../results/notes.gcidx -b ../results
+ *
+ * Options:
+ *   -o index  build the index of the .gcno files and directories given
+ *             (searched recursively), unless it is up to date
+ *   -f        build even if up to date
+ *   -i index  query the index:
+ *   -l          list the units (.gcno files) and their function counts
+ *   -n name     print the functions of this name
+ *   -g gcda     print the functions of this .gcda file, hottest first,
+ *               by the total of their arc counters
+ *   -c          check that the index is up to date
+ *   -b dir      write the zero-coverage baseline lcov tracefile of the build
+ *               into dir (created if need be) as baseline_<build ID>.info,
+ *               unless already there, and print its path
+ *               (refused if the index is stale)
+ *   -j n        threads to make the baseline (default one per processor)
+ *
+ * Exits with 0 if done, 1 on error, and 2 if any .gcno file was left out,
+ * or the index is stale, or a query found nothing.
+ *
+ **********************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+#include "gcov_notes.h"
+
+typedef struct {
+    const GcovIndexFunction *f;
+    unsigned long long total;
+    unsigned counters;
+} Hot;
+
+static void print_function(const GcovIndex *ix, const GcovIndexFunction *f)
+{
+    printf("%s %s:%u-%u ident 0x%08x in %s, %u blocks, %u arcs, %u counted\n",
+           gcov_index_string(ix, f->name), gcov_index_string(ix, f->source),
+           f->start_line, f->end_line, f->ident,
+           gcov_index_string(ix, ix->unit[f->unit].stem), f->blocks, f->arcs, f->counters);
+}
+
+static void list_units(const GcovIndex *ix)
+{
+    for (uint32_t i = 0; i < ix->header->units; i++) {
+        printf("%s: %u functions\n", gcov_index_string(ix, ix->unit[i].path), ix->unit[i].functions);
+    }
+    printf("%u units, %u functions, %u arcs, %u lines, %u conditions\n",
+           ix->header->units, ix->header->functions, ix->header->arcs, ix->header->lines,
+           ix->header->conditions);
+}
+
+static int named(const GcovIndex *ix, const char *name)
+{
+    uint32_t pos = 0;
+    const GcovIndexFunction *f;
+    int found = 0;
+
+    while ((f = gcov_index_named(ix, name, &pos)) != NULL) {
+        print_function(ix, f);
+        found++;
+    }
+    return found;
+}
+
+static int hotter(const void *a, const void *b)
+{
+    const Hot *x = a;
+    const Hot *y = b;
+
+    return x->total < y->total ? 1 : x->total > y->total ? -1 : 0;
+}
+
+static unsigned gcda_word(const unsigned char *p, int le)
+{
+    return le ? (unsigned)p[0] | (unsigned)p[1] << 8 | (unsigned)p[2] << 16 | (unsigned)p[3] << 24
+              : (unsigned)p[3] | (unsigned)p[2] << 8 | (unsigned)p[1] << 16 | (unsigned)p[0] << 24;
+}
+
+static int hot_functions(const GcovIndex *ix, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    GcovBuf data = { NULL, 0, 0 };
+    unsigned char chunk[65536];
+    size_t got;
+    const char *why;
+    const GcovIndexUnit *u = gcov_index_unit(ix, path);
+    Hot *hot = NULL;
+    size_t count = 0;
+    int le;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        gcov_buf_add(&data, chunk, got);
+    }
+    fclose(f);
+    why = gcov_gcda_check(data.data, data.len);
+    if (why) {
+        fprintf(stderr, "gcov_index: %s: %s\n", path, why);
+        free(data.data);
+        return -1;
+    }
+    if (!u) {
+        fprintf(stderr, "gcov_index: %s: no .gcno of that name in the index\n", path);
+        free(data.data);
+        return 0;
+    }
+    le = gcda_word(data.data, 1) == GCOV_HOST_DATA_MAGIC;
+    if (gcda_word(data.data + 8, le) != u->stamp) {
+        fprintf(stderr, "gcov_index: %s: not of the same build as %s\n",
+                path, gcov_index_string(ix, u->path));
+    }
+
+    hot = calloc(data.len / 8 + 1, sizeof(*hot));
+    if (!hot) {
+        perror("calloc");
+        exit(1);
+    }
+    for (size_t pos = 16; pos + 8 <= data.len; ) {
+        unsigned tag = gcda_word(data.data + pos, le);
+        size_t bytes = gcda_word(data.data + pos + 4, le);
+
+        if (tag == GCOV_HOST_TAG_FUNCTION && bytes >= 4) {
+            unsigned ident = gcda_word(data.data + pos + 8, le);
+            const GcovIndexFunction *fn = gcov_index_function(ix, u, ident);
+
+            if (fn) {
+                hot[count++].f = fn;
+            } else {
+                fprintf(stderr, "gcov_index: %s: function ident 0x%08x not in the notes\n", path, ident);
+            }
+        } else if (tag == GCOV_HOST_TAG_COUNTER_BASE && count > 0) {
+            /* arc counters, low word first */
+            for (size_t i = 0; i + 8 <= bytes; i += 8) {
+                hot[count - 1].total += (unsigned long long)gcda_word(data.data + pos + 8 + i + 4, le) << 32
+                                        | gcda_word(data.data + pos + 8 + i, le);
+            }
+            hot[count - 1].counters = (unsigned)(bytes / 8);
+        }
+        pos += 8 + bytes;
+    }
+    qsort(hot, count, sizeof(*hot), hotter);
+    for (size_t i = 0; i < count; i++) {
+        printf("%12llu %s %s:%u-%u", hot[i].total, gcov_index_string(ix, hot[i].f->name),
+               gcov_index_string(ix, hot[i].f->source), hot[i].f->start_line, hot[i].f->end_line);
+        if (hot[i].counters != hot[i].f->counters) {
+            printf(" (%u arc counters, notes have %u)", hot[i].counters, hot[i].f->counters);
+        }
+        printf("\n");
+    }
+    free(hot);
+    free(data.data);
+    return (int)count;
+}
+
+/*
+ * Zero-coverage baseline: an lcov tracefile as "lcov --capture --initial"
+ * makes, of every source file, function, and line in the notes.
+ * Each source file is a (compiler cwd, source name) pair of interned
+ * strings, made absolute; its lines and functions are gathered in two
+ * passes over the index, then the files are sorted by path and formatted
+ * in parallel, each thread a contiguous range of them, so the output
+ * is the same for any count of threads.
+ */
+typedef struct {
+    uint32_t cwd;               /* 0 if the source name is absolute */
+    uint32_t source;
+    uint32_t lines;
+    uint32_t line_at;           /* in Baseline line */
+    uint32_t functions;
+    uint32_t function_at;       /* in Baseline function */
+    char *path;
+} Source;
+
+typedef struct {
+    const GcovIndex *ix;
+    Source *source;
+    uint32_t sources;
+    uint32_t *slot;             /* hash of (cwd, source), each slot 0 if empty, else source index + 1 */
+    uint32_t slots;
+    uint32_t *line;             /* line numbers, by source */
+    uint32_t *function;         /* function indexes, by source */
+    uint32_t *order;            /* source indexes, by path */
+} Baseline;
+
+typedef struct {
+    pthread_t thread;
+    const Baseline *b;
+    uint32_t first;             /* in b->order */
+    uint32_t end;
+    GcovBuf out;
+} Formatter;
+
+static uint32_t source_hash(uint32_t cwd, uint32_t source)
+{
+    return (cwd * 0x9e3779b1u) ^ (source * 0x85ebca6bu);
+}
+
+static uint32_t source_of(Baseline *b, uint32_t unit, uint32_t source)
+{
+    uint32_t cwd = gcov_index_string(b->ix, source)[0] == '/' ? 0 : b->ix->unit[unit].cwd;
+    uint32_t s;
+
+    if (2 * (b->sources + 1) > b->slots) {
+        free(b->slot);
+        b->slots = b->slots ? 2 * b->slots : 1024;
+        b->slot = calloc(b->slots, sizeof(*b->slot));
+        b->source = realloc(b->source, b->slots / 2 * sizeof(*b->source));
+        if (!b->slot || !b->source) {
+            perror("calloc");
+            exit(1);
+        }
+        for (uint32_t i = 0; i < b->sources; i++) {
+            s = source_hash(b->source[i].cwd, b->source[i].source) & (b->slots - 1);
+            while (b->slot[s]) {
+                s = (s + 1) & (b->slots - 1);
+            }
+            b->slot[s] = i + 1;
+        }
+    }
+    for (s = source_hash(cwd, source) & (b->slots - 1); b->slot[s]; s = (s + 1) & (b->slots - 1)) {
+        const Source *src = &b->source[b->slot[s] - 1];
+
+        if (src->cwd == cwd && src->source == source) {
+            return b->slot[s] - 1;
+        }
+    }
+    memset(&b->source[b->sources], 0, sizeof(Source));
+    b->source[b->sources].cwd = cwd;
+    b->source[b->sources].source = source;
+    b->slot[s] = ++b->sources;
+    return b->sources - 1;
+}
+
+/* Absolute path of a source, without "." and ".." components, as lcov has it */
+static char *source_path(const GcovIndex *ix, const Source *src)
+{
+    const char *cwd = gcov_index_string(ix, src->cwd);
+    const char *name = gcov_index_string(ix, src->source);
+    size_t n = strlen(cwd) + strlen(name) + 3;
+    char *joined = malloc(n);
+    char *path = malloc(n);
+    char *save = NULL;
+    size_t len = 0;
+
+    if (!joined || !path) {
+        perror("malloc");
+        exit(1);
+    }
+    snprintf(joined, n, "%s/%s", cwd, name);
+    for (char *part = strtok_r(joined, "/", &save); part; part = strtok_r(NULL, "/", &save)) {
+        if (strcmp(part, ".") == 0) {
+            continue;
+        }
+        if (strcmp(part, "..") == 0) {
+            while (len > 0 && path[--len] != '/') {
+            }
+            continue;
+        }
+        path[len++] = '/';
+        strcpy(path + len, part);
+        len += strlen(part);
+    }
+    if (len == 0) {
+        path[len++] = '/';
+    }
+    path[len] = '\0';
+    free(joined);
+    return path;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* For qsort, which takes no context: set before sorting, read only while sorting */
+static const Baseline *sorting;
+
+static int by_path(const void *a, const void *b)
+{
+    return strcmp(sorting->source[*(const uint32_t *)a].path, sorting->source[*(const uint32_t *)b].path);
+}
+
+static int by_line_name(const void *a, const void *b)
+{
+    const GcovIndexFunction *x = &sorting->ix->function[*(const uint32_t *)a];
+    const GcovIndexFunction *y = &sorting->ix->function[*(const uint32_t *)b];
+
+    if (x->start_line != y->start_line) {
+        return x->start_line < y->start_line ? -1 : 1;
+    }
+    return strcmp(gcov_index_string(sorting->ix, x->name), gcov_index_string(sorting->ix, y->name));
+}
+
+static void put(GcovBuf *out, const char *format, ...)
+{
+    char text[GCOV_HOST_MAX_LINE + 64];
+    va_list ap;
+    int n;
+
+    va_start(ap, format);
+    n = vsnprintf(text, sizeof(text), format, ap);
+    va_end(ap);
+    gcov_buf_add(out, text, n < (int)sizeof(text) ? (size_t)n : sizeof(text) - 1);
+}
+
+/* Format a range of b->order, all the sources of one path as one record */
+static void *format_range(void *arg)
+{
+    Formatter *fm = arg;
+    const Baseline *b = fm->b;
+    const GcovIndex *ix = b->ix;
+    GcovBuf lines = { NULL, 0, 0 };
+    GcovBuf functions = { NULL, 0, 0 };
+
+    for (uint32_t i = fm->first; i < fm->end; ) {
+        const char *path = b->source[b->order[i]].path;
+        uint32_t *line;
+        uint32_t *function;
+        size_t nl = 0;
+        size_t nf = 0;
+
+        lines.len = functions.len = 0;
+        for (; i < fm->end && strcmp(b->source[b->order[i]].path, path) == 0; i++) {
+            const Source *src = &b->source[b->order[i]];
+
+            gcov_buf_add(&lines, b->line + src->line_at, src->lines * sizeof(uint32_t));
+            gcov_buf_add(&functions, b->function + src->function_at, src->functions * sizeof(uint32_t));
+        }
+        line = (uint32_t *)lines.data;
+        function = (uint32_t *)functions.data;
+        qsort(line, lines.len / sizeof(uint32_t), sizeof(uint32_t), compare_u32);
+        qsort(function, functions.len / sizeof(uint32_t), sizeof(uint32_t), by_line_name);
+        /* a line, or a function (of a header), of several units once */
+        for (size_t j = 0; j < lines.len / sizeof(uint32_t); j++) {
+            if (nl == 0 || line[nl - 1] != line[j]) {
+                line[nl++] = line[j];
+            }
+        }
+        for (size_t j = 0; j < functions.len / sizeof(uint32_t); j++) {
+            if (nf == 0 || by_line_name(&function[nf - 1], &function[j]) != 0) {
+                function[nf++] = function[j];
+            }
+        }
+
+        put(&fm->out, "TN:\nSF:%s\n", path);
+        for (size_t j = 0; j < nf; j++) {
+            put(&fm->out, "FN:%u,%s\n", ix->function[function[j]].start_line,
+                gcov_index_string(ix, ix->function[function[j]].name));
+        }
+        for (size_t j = 0; j < nf; j++) {
+            put(&fm->out, "FNDA:0,%s\n", gcov_index_string(ix, ix->function[function[j]].name));
+        }
+        put(&fm->out, "FNF:%zu\nFNH:0\n", nf);
+        for (size_t j = 0; j < nl; j++) {
+            put(&fm->out, "DA:%u,0\n", line[j]);
+        }
+        put(&fm->out, "LF:%zu\nLH:0\nend_of_record\n", nl);
+    }
+    free(lines.data);
+    free(functions.data);
+    return NULL;
+}
+
+/* Gather the lines and functions of each source, then sort the sources by path */
+static void gather(Baseline *b)
+{
+    const GcovIndex *ix = b->ix;
+    uint32_t line_at = 0;
+    uint32_t function_at = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < ix->header->functions; i++) {
+            const GcovIndexFunction *f = &ix->function[i];
+            uint32_t s;
+            Source *src;
+
+            if (!f->artificial) {
+                /* as gcov, leaving out compiler-made functions (but not their lines) */
+                s = source_of(b, f->unit, f->source);  /* may move b->source */
+                src = &b->source[s];
+                if (pass == 0) {
+                    src->functions++;
+                } else {
+                    b->function[src->function_at++] = i;
+                }
+            }
+            for (uint32_t j = f->first_line; j < f->first_line + f->lines && j < ix->header->lines; j++) {
+                if (ix->line[j].line == 0) {
+                    continue;
+                }
+                s = source_of(b, f->unit, ix->line[j].source);
+                src = &b->source[s];
+                if (pass == 0) {
+                    src->lines++;
+                } else {
+                    b->line[src->line_at++] = ix->line[j].line;
+                }
+            }
+        }
+        if (pass == 0) {
+            for (uint32_t s = 0; s < b->sources; s++) {
+                b->source[s].line_at = line_at;
+                b->source[s].function_at = function_at;
+                line_at += b->source[s].lines;
+                function_at += b->source[s].functions;
+            }
+            b->line = malloc((line_at + 1) * sizeof(*b->line));
+            b->function = malloc((function_at + 1) * sizeof(*b->function));
+            b->order = malloc((b->sources + 1) * sizeof(*b->order));
+            if (!b->line || !b->function || !b->order) {
+                perror("malloc");
+                exit(1);
+            }
+        }
+    }
+    for (uint32_t s = 0; s < b->sources; s++) {
+        /* back from the end of each to its start */
+        b->source[s].line_at -= b->source[s].lines;
+        b->source[s].function_at -= b->source[s].functions;
+        b->source[s].path = source_path(ix, &b->source[s]);
+        b->order[s] = s;
+    }
+    sorting = b;
+    qsort(b->order, b->sources, sizeof(*b->order), by_path);
+}
+
+/*
+ * Write the baseline of the index into dir as baseline_<build ID>.info,
+ * unless already there, and print its path; returns 0, or -1 if not written
+ */
+/* Create the directories of path, as mkdir -p */
+static void make_dirs(char *path)
+{
+    for (char *p = path + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            (void)mkdir(path, 0755); // may already exist
+            *p = '/';
+        }
+    }
+}
+
+static int baseline(const GcovIndex *ix, const char *dir, int threads)
+{
+    char id[17];
+    char path[4096];
+    Baseline b;
+    Formatter *fm;
+    GcovBuf out = { NULL, 0, 0 };
+    uint64_t weight = 0;
+    uint64_t done = 0;
+    uint32_t at = 0;
+    int failed;
+
+    gcov_index_build_id(ix, id);
+    snprintf(path, sizeof(path), "%s/baseline_%s.info", dir, id);
+    if (access(path, F_OK) == 0) {
+        printf("%s\n", path);
+        return 0;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.ix = ix;
+    gather(&b);
+    fm = calloc((size_t)threads, sizeof(*fm));
+    if (!fm) {
+        perror("calloc");
+        exit(1);
+    }
+    /* contiguous ranges of about the same weight, not splitting a path */
+    for (uint32_t s = 0; s < b.sources; s++) {
+        weight += b.source[s].lines + b.source[s].functions + 1;
+    }
+    for (int t = 0; t < threads; t++) {
+        fm[t].b = &b;
+        fm[t].first = at;
+        while (at < b.sources && (t == threads - 1 || done < weight * (uint64_t)(t + 1) / (uint64_t)threads
+                                  || (at > fm[t].first && strcmp(b.source[b.order[at]].path,
+                                                                 b.source[b.order[at - 1]].path) == 0))) {
+            done += b.source[b.order[at]].lines + b.source[b.order[at]].functions + 1;
+            at++;
+        }
+        fm[t].end = at;
+        if (pthread_create(&fm[t].thread, NULL, format_range, &fm[t]) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(fm[t].thread, NULL);
+        gcov_buf_add(&out, fm[t].out.data, fm[t].out.len);
+        free(fm[t].out.data);
+    }
+    make_dirs(path);
+    failed = gcov_write_whole(path, out.data, out.len);
+    if (failed) {
+        fprintf(stderr, "gcov_index: %s: %s\n", path, strerror(errno));
+    } else {
+        printf("%s\n", path);
+    }
+
+    for (uint32_t s = 0; s < b.sources; s++) {
+        free(b.source[s].path);
+    }
+    free(b.source);
+    free(b.slot);
+    free(b.line);
+    free(b.function);
+    free(b.order);
+    free(fm);
+    free(out.data);
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *build = NULL;
+    const char *query = NULL;
+    const char *name = NULL;
+    const char *gcda = NULL;
+    const char *baseline_dir = NULL;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int force = 0;
+    int list = 0;
+    int check = 0;
+    int status = 0;
+    GcovIndex *ix;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:fi:ln:g:cb:j:")) != -1) {
+        switch (opt) {
+        case 'o': build = optarg; break;
+        case 'f': force = 1; break;
+        case 'i': query = optarg; break;
+        case 'l': list = 1; break;
+        case 'n': name = optarg; break;
+        case 'g': gcda = optarg; break;
+        case 'c': check = 1; break;
+        case 'b': baseline_dir = optarg; break;
+        case 'j': threads = atoi(optarg); break;
+        default:
+            build = query = NULL;
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (build ? query || optind >= argc : !query || optind != argc) {
+        fprintf(stderr, "usage: %s [-f] -o index objs...\n"
+                        "       %s -i index [-l] [-n name] [-g gcda] [-c] [-b dir [-j n]]\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+
+    if (build) {
+        unsigned skipped;
+        int built = gcov_index_build(build, argv + optind, argc - optind, force, &skipped);
+
+        if (built < 0) {
+            return 1;
+        }
+        if (built == 1) {
+            printf("%s is up to date\n", build);
+        } else {
+            ix = gcov_index_open(build);
+            if (!ix) {
+                return 1;
+            }
+            printf("%s: %u units, %u functions, %u left out\n",
+                   build, ix->header->units, ix->header->functions, skipped);
+            gcov_index_close(ix);
+        }
+        return skipped ? 2 : 0;
+    }
+
+    ix = gcov_index_open(query);
+    if (!ix) {
+        return 1;
+    }
+    if (check || baseline_dir) {
+        unsigned stale = gcov_index_stale(ix);
+
+        if (stale) {
+            printf("%s: %u of %u units stale\n", query, stale, ix->header->units);
+            status = 2;
+        }
+    }
+    if (list) {
+        list_units(ix);
+    }
+    if (name && named(ix, name) == 0) {
+        fprintf(stderr, "gcov_index: no function %s\n", name);
+        status = status ? status : 2;
+    }
+    if (gcda) {
+        int found = hot_functions(ix, gcda);
+
+        if (found < 0) {
+            status = 1;
+        } else if (found == 0 && !status) {
+            status = 2;
+        }
+    }
+    if (baseline_dir) {
+        if (status == 2) {
+            fprintf(stderr, "gcov_index: no baseline from a stale index, build it again first\n");
+        } else if (baseline(ix, baseline_dir, threads < 1 ? 1 : threads) != 0) {
+            status = 1;
+        }
+    }
+    gcov_index_close(ix);
+    return status;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_index.c host tool to index the .gcno notes of a build
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,353 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host daemon to ingest gcov output as it arrives.
+ *
+ * Reads the target output continuously from a serial device, pty,
+ * fifo, or a log file that is still growing (following it like
+ * tail -f, across truncation and log rotation), and writes each
+ * .gcda file as soon as its data is complete, instead of after
+ * the fact on a complete log as scripts/gcov_convert.sh does.
+ *
+ * Recognizes, anywhere in the stream:
+ *   GCOV_OPT_OUTPUT_SERIAL_HEXDUMP output: "Emitting N bytes for"
+ *     lines, hexdump lines, and the filename line that ends each file,
+ *   binary format (GCOV_OPT_OUTPUT_BINARY_FILE, GCOV_OPT_OUTPUT_DMA etc.),
+ *     starting at the beginning of a line, and also
+ *     compressed by GCOV_OPT_COMPRESS_LZ, decompressed as it arrives,
+ * and "Gcov End" as the end of a dump.
+ *
+ * Damaged output (lost or garbled lines, NULs from a reboot, damaged
+ * binary format) is resynced past, and of a damaged .gcda file the
+ * complete function records are salvaged and written, with a report
+ * of what was lost (see tools/gcov_host.c), so a glitch in a long
+ * test loses only the coverage of the functions it hit.
+ *
+ * Each .gcda file is written through a temporary name and renamed,
+ * so tools reading the output directory see whole files only.
+ *
+ * Typical usage:
+ *   ./gcov_ingest -o ../objs -b 115200 /dev/ttyUSB0
+ *   ./gcov_ingest -o ../objs -f -S ingest.state ../rig1_serial_log.txt
+ *   ./gcov_ingest -o ../objs -e "../scripts/lcov_newcoverage.sh" /tmp/from_target.fifo
+ *
+ * Options:
+ *   -o dir   directory for the .gcda files (default current directory),
+ *            files are named by the basename of the target filename
+ *   -b baud  set a serial device to raw mode at this baud rate
+ *   -f       follow a log file as it grows (else stop at its end)
+ *   -S path  state file to keep the position in a log file,
+ *            so a restart continues where it left off
+ *   -e cmd   run cmd (by the shell) after each complete dump
+ *   -x       exit after the first complete dump
+ *
+ * Exits with 0 if the last dump was complete (nothing salvaged or skipped),
+ * otherwise with 2,
+ * so that partial results are never mistaken for complete ones.
+ *
+ **********************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+
+/* Interval to check a followed log file for more data, microseconds */
+#define FOLLOW_INTERVAL 200000
+
+static const char *out_dir = ".";
+static const char *end_cmd = NULL;
+static int exit_at_end = 0;
+
+static int last_dump_ok = 1;
+
+static void write_file(void *ctx, const char *filename, const unsigned char *data, size_t bytes)
+{
+    const char *base = strrchr(filename, '/');
+    char path[4096];
+
+    (void)ctx;
+    base = base ? base + 1 : filename;
+    snprintf(path, sizeof(path), "%s/%s", out_dir, base);
+    if (gcov_write_whole(path, data, bytes) != 0) {
+        fprintf(stderr, "gcov_ingest: cannot write %s: %s\n", path, strerror(errno));
+        exit(1);
+    }
+    printf("Ingested %zu bytes for %s\n", bytes, path);
+}
+
+static void salvage_file(void *ctx, const char *filename, const unsigned char *data, size_t bytes,
+                         const char *lost)
+{
+    write_file(ctx, filename, data, bytes);
+    fprintf(stderr, "gcov_ingest: salvaged %s: %s\n", filename, lost);
+}
+
+static void skip_file(void *ctx, const char *filename, const char *why)
+{
+    (void)ctx;
+    fprintf(stderr, "gcov_ingest: skipping %s: %s\n", filename, why);
+}
+
+/* End of a dump: report, and run the command */
+static void dump_end(void *ctx, unsigned written, unsigned salvaged, unsigned skipped)
+{
+    (void)ctx;
+    last_dump_ok = (salvaged == 0 && skipped == 0);
+    printf("Gcov dump %s: %u files written, %u salvaged, %u skipped\n",
+           last_dump_ok ? "complete" : "incomplete", written, salvaged, skipped);
+    if (end_cmd && system(end_cmd) != 0) {
+        fprintf(stderr, "gcov_ingest: command failed: %s\n", end_cmd);
+    }
+    if (exit_at_end) {
+        exit(last_dump_ok ? 0 : 2);
+    }
+}
+
+/* ----------------------------------------------------------- */
+/* Input and its position */
+
+static const char *state_path = NULL;
+
+static void save_state(ino_t ino, off_t offset)
+{
+    char tmp[4096 + 8];
+    FILE *f;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", state_path);
+    f = fopen(tmp, "w");
+    if (!f || fprintf(f, "%llu %lld\n", (unsigned long long)ino, (long long)offset) < 0
+        || fclose(f) != 0 || rename(tmp, state_path) != 0) {
+        fprintf(stderr, "gcov_ingest: cannot write %s: %s\n", state_path, strerror(errno));
+    }
+}
+
+static off_t load_state(ino_t ino, off_t size)
+{
+    unsigned long long saved_ino;
+    long long offset;
+    FILE *f = fopen(state_path, "r");
+    int got;
+
+    if (!f) {
+        return 0;
+    }
+    got = fscanf(f, "%llu %lld", &saved_ino, &offset);
+    fclose(f);
+    if (got != 2 || saved_ino != (unsigned long long)ino || offset < 0 || offset > size) {
+        return 0; // a different or shorter file, start over
+    }
+    return (off_t)offset;
+}
+
+static speed_t baud_flag(long baud)
+{
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default:
+        fprintf(stderr, "gcov_ingest: unsupported baud %ld\n", baud);
+        exit(1);
+    }
+}
+
+static int open_input(const char *path, struct stat *st)
+{
+    int fd;
+
+    if (strcmp(path, "-") == 0) {
+        fd = 0;
+    } else {
+        /* read-write keeps a fifo open when its writer closes and reopens it */
+        fd = open(path, O_RDWR | O_NOCTTY);
+        if (fd < 0) {
+            fd = open(path, O_RDONLY | O_NOCTTY);
+        }
+        if (fd < 0) {
+            perror(path);
+            exit(1);
+        }
+    }
+    if (fstat(fd, st) != 0) {
+        perror(path);
+        exit(1);
+    }
+    return fd;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path;
+    long baud = 0;
+    int follow = 0;
+    int in_fd;
+    struct stat st;
+    static const GcovDecoderCallbacks cb = { write_file, salvage_file, skip_file, dump_end };
+    GcovDecoder *dec = gcov_decoder_new(&cb, NULL);
+    off_t in_offset = 0;        /* file offset of the next read */
+    unsigned long long fed = 0; /* bytes given to the decoder */
+    off_t saved = -1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:b:fS:e:x")) != -1) {
+        switch (opt) {
+        case 'o': out_dir = optarg; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'f': follow = 1; break;
+        case 'S': state_path = optarg; break;
+        case 'e': end_cmd = optarg; break;
+        case 'x': exit_at_end = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-o dir] [-b baud] [-f] [-S statefile] [-e cmd] [-x] input|-\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-o dir] [-b baud] [-f] [-S statefile] [-e cmd] [-x] input|-\n", argv[0]);
+        return 1;
+    }
+    path = argv[optind];
+    setvbuf(stdout, NULL, _IOLBF, 0); // progress shows at once in a log
+
+    in_fd = open_input(path, &st);
+    if (isatty(in_fd) && baud) {
+        struct termios tio;
+
+        if (tcgetattr(in_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, baud_flag(baud));
+            cfsetospeed(&tio, baud_flag(baud));
+            tcsetattr(in_fd, TCSANOW, &tio);
+        }
+    }
+    if (!S_ISREG(st.st_mode)) {
+        follow = 0;
+        state_path = NULL; // no position to keep
+    } else if (state_path) {
+        in_offset = load_state(st.st_ino, st.st_size);
+        if (in_offset && lseek(in_fd, in_offset, SEEK_SET) != in_offset) {
+            in_offset = 0;
+        }
+        if (in_offset) {
+            printf("Resuming %s at byte %lld\n", path, (long long)in_offset);
+        }
+    }
+
+    for (;;) {
+        unsigned char chunk[65536];
+        ssize_t got = read(in_fd, chunk, sizeof(chunk));
+        off_t taken;
+
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror(path);
+            break;
+        }
+        if (got == 0) {
+            struct stat now;
+
+            if (!S_ISREG(st.st_mode) && !isatty(in_fd)) {
+                /* end of a pipe */
+                break;
+            }
+            if (!follow) {
+                if (S_ISREG(st.st_mode)) {
+                    break;
+                }
+                usleep(FOLLOW_INTERVAL); // tty with no carrier
+                continue;
+            }
+            usleep(FOLLOW_INTERVAL);
+            if (stat(path, &now) == 0 && now.st_ino != st.st_ino) {
+                /* rotated: finish the old file, then start on the new one */
+                if (read(in_fd, chunk, 1) > 0) {
+                    lseek(in_fd, -1, SEEK_CUR);
+                    continue;
+                }
+                close(in_fd);
+                in_fd = open_input(path, &st);
+                in_offset = 0;
+                printf("Following new %s\n", path);
+                continue;
+            }
+            if (fstat(in_fd, &now) == 0 && now.st_size < in_offset) {
+                /* truncated: start over from its beginning */
+                lseek(in_fd, 0, SEEK_SET);
+                gcov_decoder_reset(dec);
+                fed = 0;
+                in_offset = 0;
+                printf("Following truncated %s\n", path);
+            }
+            continue;
+        }
+
+        gcov_decoder_feed(dec, chunk, (size_t)got);
+        fed += (unsigned long long)got;
+        in_offset += (off_t)got;
+
+        /* position to resume from: only between files of hexdump output,
+         * or between dumps, as a restart cannot pick up the middle of one */
+        taken = in_offset - (off_t)(fed - gcov_decoder_resume_offset(dec));
+        if (state_path && taken >= 0 && taken != saved) {
+            save_state(st.st_ino, taken);
+            saved = taken;
+        }
+    }
+
+    if (!gcov_decoder_finish(dec)) {
+        fprintf(stderr, "gcov_ingest: input ended within a dump\n");
+        return 2;
+    }
+    return last_dump_ok ? 0 : 2;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_ingest.c host daemon to ingest gcov output as it arrives
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
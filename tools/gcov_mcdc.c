@@ -0,0 +1,365 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool to report the condition (MC/DC) coverage of a build.
+ *
+ * Code compiled by GCC 14 or later with -fcondition-coverage counts,
+ * for each condition expression (a decision of one or more terms
+ * joined by && and ||), which of its terms have been seen to take the
+ * decision each way, true and false, independently of the others:
+ * a pair of bitmask counters per expression in the .gcda data, and
+ * the block and term count of each expression in the .gcno notes.
+ * This tool takes the .gcno index of the build (see gcov_index) and
+ * .gcda files, and reports as gcov --conditions does: for each
+ * function, the condition outcomes covered out of twice the terms,
+ * and of each expression not fully covered, its line and each term
+ * not covered, with the outcome (true, false or both) never seen.
+ * Several .gcda files of the same unit (as from several
+ * tests or targets) are merged first, ORing the bitmasks.
+ * Every unit of the index with conditions is reported, so that one
+ * without a .gcda file counts as not covered, not as left out.
+ *
+ * .gcda files packed by GCOV_OPT_PACK_CONDITIONS are unpacked
+ * by gcov_unpack and the host decoder, before they get here.
+ *
+ * Typical usage:
+ *   ./gcov_index -o ../results/notes.gcidx ../objs
+ *   ./gcov_mcdc -i ../results/notes.gcidx ../objs/main.gcda ../objs/util.gcda
+ *   ./gcov_mcdc -i ../results/notes.gcidx -s -m 100 ../test1/main.gcda ../test2/main.gcda
+ *
+ * Options:
+ *   -i index  index of the build (required)
+ *   -s        summary of each unit only, not each function and term
+ *   -m pct    exit with 2 if less than pct percent of the outcomes are covered
+ *
+ * Exits with 0 if done, 1 on error, and 2 if a .gcda file was not
+ * of the build or below the -m minimum.
+ *
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+#include "gcov_notes.h"
+
+/* .gcda data of one unit, merged from the files given */
+typedef struct {
+    unsigned char *data;
+    size_t bytes;
+    int le;
+    const char *path;           /* the first file given */
+} UnitData;
+
+static const GcovIndex *ix;
+static int summary_only = 0;
+
+static uint32_t gcda_word(const unsigned char *p, int le)
+{
+    return le ? (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24
+              : (uint32_t)p[3] | (uint32_t)p[2] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[0] << 24;
+}
+
+/* Counter at p, low word first */
+static uint64_t gcda_counter(const unsigned char *p, int le)
+{
+    return (uint64_t)gcda_word(p + 4, le) << 32 | gcda_word(p, le);
+}
+
+static unsigned popcount(uint64_t v)
+{
+    unsigned n = 0;
+
+    for (; v; v &= v - 1) {
+        n++;
+    }
+    return n;
+}
+
+/* Read a whole .gcda file and check it, returns NULL after printing why not */
+static unsigned char *read_gcda(const char *path, size_t *bytes)
+{
+    FILE *f = fopen(path, "rb");
+    GcovBuf data = { NULL, 0, 0 };
+    unsigned char chunk[65536];
+    size_t got;
+    const char *why;
+
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        gcov_buf_add(&data, chunk, got);
+    }
+    fclose(f);
+    why = gcov_gcda_check(data.data, data.len);
+    if (why) {
+        fprintf(stderr, "gcov_mcdc: %s: %s\n", path, why);
+        free(data.data);
+        return NULL;
+    }
+    *bytes = data.len;
+    return data.data;
+}
+
+/* Take a .gcda file into the data of its unit, returns 0, or 2 after printing why not */
+static int take_gcda(UnitData *units, const char *path)
+{
+    const GcovIndexUnit *u = gcov_index_unit(ix, path);
+    UnitData *ud;
+    unsigned char *data;
+    size_t bytes;
+    const char *why;
+    int le;
+
+    if (!u) {
+        fprintf(stderr, "gcov_mcdc: %s: no such unit in the index\n", path);
+        return 2;
+    }
+    data = read_gcda(path, &bytes);
+    if (!data) {
+        return 2;
+    }
+    le = gcda_word(data, 1) == GCOV_HOST_DATA_MAGIC;
+    if (gcda_word(data + 8, le) != u->stamp) {
+        fprintf(stderr, "gcov_mcdc: %s: not of the build of the index\n", path);
+        free(data);
+        return 2;
+    }
+    ud = &units[u - ix->unit];
+    if (!ud->data) {
+        ud->data = data;
+        ud->bytes = bytes;
+        ud->le = le;
+        ud->path = path;
+        return 0;
+    }
+    why = gcov_gcda_merge(ud->data, ud->bytes, data, bytes);
+    free(data);
+    if (why) {
+        fprintf(stderr, "gcov_mcdc: %s: cannot merge with %s: %s\n", path, ud->path, why);
+        return 2;
+    }
+    return 0;
+}
+
+/*
+ * Note the condition counter record of each function of a unit's data,
+ * by function index, if it fits the function's conditions in the index
+ */
+static void find_conditions(const GcovIndexUnit *u, const UnitData *ud, const unsigned char **conds)
+{
+    const GcovIndexFunction *f = NULL;
+
+    for (size_t pos = 16; pos + 8 <= ud->bytes; ) {
+        uint32_t tag = gcda_word(ud->data + pos, ud->le);
+        uint32_t bytes = gcda_word(ud->data + pos + 4, ud->le);
+
+        if (tag == GCOV_HOST_TAG_FUNCTION && bytes == 12) {
+            f = gcov_index_function(ix, u, gcda_word(ud->data + pos + 8, ud->le));
+            if (f && f->cfg_checksum != gcda_word(ud->data + pos + 16, ud->le)) {
+                fprintf(stderr, "gcov_mcdc: %s: %s does not match the index, left out\n",
+                        ud->path, gcov_index_string(ix, f->name));
+                f = NULL;
+            }
+        } else if (tag == GCOV_HOST_TAG_CONDITIONS && f) {
+            if (bytes == f->conditions * 16) {
+                conds[f - ix->function] = ud->data + pos + 8;
+            } else {
+                fprintf(stderr, "gcov_mcdc: %s: %s has %u condition counters, the index %u\n",
+                        ud->path, gcov_index_string(ix, f->name), bytes / 8, f->conditions * 2);
+            }
+        }
+        pos += 8 + bytes;
+    }
+}
+
+/* Line of a block of a function, as in its lines record (else its first line) */
+static uint32_t block_line(const GcovIndexFunction *f, uint32_t block)
+{
+    for (uint32_t i = f->first_line; i < f->first_line + f->lines; i++) {
+        if (ix->line[i].block == block) {
+            return ix->line[i].line;
+        }
+    }
+    return f->start_line;
+}
+
+/* Report a function, adding its outcomes covered and expected */
+static void report_function(const GcovIndexFunction *f, const unsigned char *conds, int le,
+                            unsigned long long *covered, unsigned long long *expected)
+{
+    unsigned got = 0;
+    unsigned want = 0;
+
+    for (uint32_t i = 0; i < f->conditions; i++) {
+        const GcovIndexCondition *c = &ix->condition[f->first_condition + i];
+        uint64_t mask = (c->terms >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << c->terms) - 1;
+
+        want += 2 * c->terms;
+        if (conds) {
+            got += popcount(gcda_counter(conds + 16 * i, le) & mask);
+            got += popcount(gcda_counter(conds + 16 * i + 8, le) & mask);
+        }
+    }
+    *covered += got;
+    *expected += want;
+    if (summary_only) {
+        return;
+    }
+
+    printf("%s %s:%u: condition outcomes covered %u/%u in %u expressions%s\n",
+           gcov_index_string(ix, f->name), gcov_index_string(ix, f->source), f->start_line,
+           got, want, f->conditions, conds ? "" : " (no counters)");
+    for (uint32_t i = 0; i < f->conditions && got < want; i++) {
+        const GcovIndexCondition *c = &ix->condition[f->first_condition + i];
+        uint64_t mask = (c->terms >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << c->terms) - 1;
+        uint64_t truev = conds ? gcda_counter(conds + 16 * i, le) & mask : 0;
+        uint64_t falsev = conds ? gcda_counter(conds + 16 * i + 8, le) & mask : 0;
+
+        if ((truev & falsev) == mask) {
+            continue;
+        }
+        printf("  %s:%u: condition outcomes covered %u/%u\n", gcov_index_string(ix, f->source),
+               block_line(f, c->block), popcount(truev) + popcount(falsev), 2 * c->terms);
+        for (uint32_t t = 0; t < c->terms; t++) {
+            uint64_t bit = (uint64_t)1 << t;
+
+            if (truev & falsev & bit) {
+                continue;
+            }
+            /* as gcov words it */
+            printf("    condition %2u not covered (%s%s%s)\n", t, (truev & bit) ? "" : "true",
+                   !(truev & bit) && !(falsev & bit) ? " " : "", (falsev & bit) ? "" : "false");
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *index_path = NULL;
+    double minimum = -1;
+    UnitData *units;
+    const unsigned char **conds;
+    unsigned long long covered = 0;
+    unsigned long long expected = 0;
+    unsigned functions = 0;
+    int result = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:sm:")) != -1) {
+        switch (opt) {
+        case 'i': index_path = optarg; break;
+        case 's': summary_only = 1; break;
+        case 'm': minimum = atof(optarg); break;
+        default:
+            index_path = NULL;
+            optind = argc;
+            break;
+        }
+    }
+    if (!index_path) {
+        fprintf(stderr, "usage: %s -i index [-s] [-m pct] gcda...\n", argv[0]);
+        return 1;
+    }
+    ix = gcov_index_open(index_path);
+    if (!ix) {
+        return 1;
+    }
+    if (gcov_index_stale(ix)) {
+        fprintf(stderr, "gcov_mcdc: %s is stale, build it again first\n", index_path);
+        return 1;
+    }
+    if (ix->header->conditions == 0) {
+        fprintf(stderr, "gcov_mcdc: %s has no conditions (not compiled with -fcondition-coverage?)\n",
+                index_path);
+        return 1;
+    }
+
+    units = calloc(ix->header->units + 1, sizeof(*units));
+    conds = calloc(ix->header->functions + 1, sizeof(*conds));
+    if (!units || !conds) {
+        perror("calloc");
+        return 1;
+    }
+    for (int i = optind; i < argc; i++) {
+        result |= take_gcda(units, argv[i]);
+    }
+
+    for (uint32_t i = 0; i < ix->header->units; i++) {
+        const GcovIndexUnit *u = &ix->unit[i];
+        unsigned long long unit_covered = 0;
+        unsigned long long unit_expected = 0;
+        unsigned unit_functions = 0;
+
+        if (units[i].data) {
+            find_conditions(u, &units[i], conds);
+        }
+        for (uint32_t j = u->first_function; j < u->first_function + u->functions; j++) {
+            if (ix->function[j].conditions) {
+                report_function(&ix->function[j], conds[j], units[i].le, &unit_covered, &unit_expected);
+                unit_functions++;
+            }
+        }
+        if (unit_functions && (summary_only || !units[i].data)) {
+            printf("%s.gcda: condition outcomes covered %llu/%llu in %u functions%s\n",
+                   gcov_index_string(ix, u->stem), unit_covered, unit_expected, unit_functions,
+                   units[i].data ? "" : " (no .gcda file)");
+        }
+        covered += unit_covered;
+        expected += unit_expected;
+        functions += unit_functions;
+        free(units[i].data);
+    }
+
+    printf("Condition outcomes covered %llu/%llu (%.1f%%) in %u functions\n", covered, expected,
+           100.0 * (double)covered / (double)expected, functions);
+    if (minimum >= 0 && 100.0 * (double)covered < minimum * (double)expected) {
+        fprintf(stderr, "gcov_mcdc: below the minimum of %g%%\n", minimum);
+        result = 2;
+    }
+    free(units);
+    free(conds);
+    gcov_index_close((GcovIndex *)ix);
+    return result;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_mcdc.c host tool to report condition (MC/DC) coverage
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,683 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool to pick the tests that give the coverage of the whole suite.
+ *
+ * Takes one dump per test (each test run between __gcov_clear()
+ * and __gcov_exit()), as a saved log or binary output file of the
+ * target, or a directory of the .gcda files of the test (such as
+ * gcov_ingest writes), and orders the tests greedily by the arcs
+ * each covers that the tests before it did not, until the tests so far
+ * cover every arc that the whole suite covers. Tests that add nothing
+ * are left out, and then so is any test of those picked whose arcs
+ * the others picked all cover. Run the tests in the order given,
+ * so the most coverage comes first, under any time budget.
+ *
+ * Each test is a bit vector with a bit for each arc counter of the
+ * build (each function of each .gcda file in turn), set if the test
+ * ran that arc. Picking the next test is lazy: the gain of a test
+ * can only shrink as others are picked, so only the tests whose last
+ * gain could still beat the best are measured again, a batch at a time,
+ * the batch across threads, each measure an AND NOT and a popcount
+ * over the words of the test that have any bits set.
+ *
+ * Typical usage:
+ *   ./gcov_minimize ../tests/test1.log ../tests/test2.log ../tests/test3.log
+ *   ./gcov_minimize -c ../tests/durations.txt -b 3600 -j 8 ../tests/test1.log ../tests/test2.log
+ *
+ * Options:
+ *   -c file  cost (such as seconds) of each test, a line "test cost" each,
+ *            test as given on the command line (default 1 each), then the
+ *            order is by arcs gained per cost
+ *   -b cost  budget: pick only tests that fit in this total cost
+ *   -j n     threads (default one per processor)
+ *
+ * Writes the tests picked, in order, with the arcs each adds,
+ * and a summary.
+ *
+ **********************************************************************/
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+
+/* Candidates measured per batch, for each thread */
+#define BATCH_PER_THREAD 4
+
+typedef struct {
+    const char *name;
+    double cost;
+    GcovBuf arcs;               /* of uint32_t arc numbers, while loading */
+    uint64_t *bits;
+    uint32_t first_word;        /* words of bits that have any bit set */
+    uint32_t end_word;
+    uint64_t covers;            /* count of bits set */
+    uint64_t gain;              /* last measured, an upper bound of the gain now */
+    int picked;
+    int failed;
+} Test;
+
+/* Arc counters of one function of one .gcda file, at arc number base */
+typedef struct {
+    char *file;
+    uint32_t ident;
+    uint32_t stamp;
+    uint32_t base;
+    uint32_t counters;
+} Function;
+
+static Test *tests;
+static int test_count;
+static int threads;
+
+static pthread_mutex_t map_lock = PTHREAD_MUTEX_INITIALIZER;
+static Function *function;
+static uint32_t functions;
+static uint32_t *slot;          /* hash of function, each slot 0 if empty, else index + 1 */
+static uint32_t slots;
+static uint64_t arc_count;
+
+static uint64_t *covered;
+static uint32_t words;
+
+static uint32_t word_of(const unsigned char *p, int le)
+{
+    return le ? (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24
+              : (uint32_t)p[3] | (uint32_t)p[2] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[0] << 24;
+}
+
+static uint32_t hash_of(const char *file, uint32_t ident)
+{
+    uint32_t h = 2166136261u ^ ident;
+
+    while (*file) {
+        h = (h ^ (unsigned char)*file++) * 16777619u;
+    }
+    return h;
+}
+
+/* Arc number of the first arc counter of a function, or -1 if not of the same build */
+static int64_t function_base(const char *file, uint32_t ident, uint32_t stamp, uint32_t counters)
+{
+    uint32_t s;
+    int64_t base;
+
+    pthread_mutex_lock(&map_lock);
+    if (2 * (functions + 1) > slots) {
+        free(slot);
+        slots = slots ? 2 * slots : 4096;
+        slot = calloc(slots, sizeof(*slot));
+        function = realloc(function, slots / 2 * sizeof(*function));
+        if (!slot || !function) {
+            perror("calloc");
+            exit(1);
+        }
+        for (uint32_t i = 0; i < functions; i++) {
+            for (s = hash_of(function[i].file, function[i].ident) & (slots - 1); slot[s]; s = (s + 1) & (slots - 1)) {
+            }
+            slot[s] = i + 1;
+        }
+    }
+    for (s = hash_of(file, ident) & (slots - 1); slot[s]; s = (s + 1) & (slots - 1)) {
+        const Function *f = &function[slot[s] - 1];
+
+        if (f->ident == ident && strcmp(f->file, file) == 0) {
+            base = f->stamp == stamp && f->counters == counters ? (int64_t)f->base : -1;
+            pthread_mutex_unlock(&map_lock);
+            return base;
+        }
+    }
+    if (arc_count + counters > UINT32_MAX) {
+        fprintf(stderr, "gcov_minimize: too many arcs\n");
+        exit(1);
+    }
+    function[functions].file = strdup(file);
+    function[functions].ident = ident;
+    function[functions].stamp = stamp;
+    function[functions].base = (uint32_t)arc_count;
+    function[functions].counters = counters;
+    slot[s] = ++functions;
+    base = (int64_t)arc_count;
+    arc_count += counters;
+    pthread_mutex_unlock(&map_lock);
+    return base;
+}
+
+/* Take the arcs that a .gcda file of a test ran */
+static void take_gcda(Test *t, const char *filename, const unsigned char *data, size_t bytes)
+{
+    const char *base = strrchr(filename, '/');
+    const char *why = gcov_gcda_check(data, bytes);
+    uint32_t ident = 0;
+    uint32_t stamp;
+    int le;
+
+    base = base ? base + 1 : filename;
+    if (why) {
+        fprintf(stderr, "gcov_minimize: %s: %s: %s\n", t->name, base, why);
+        t->failed = 1;
+        return;
+    }
+    le = word_of(data, 1) == GCOV_HOST_DATA_MAGIC;
+    stamp = word_of(data + 8, le);
+    for (size_t pos = 16; pos + 8 <= bytes; ) {
+        uint32_t tag = word_of(data + pos, le);
+        uint32_t length = word_of(data + pos + 4, le);
+
+        if (tag == GCOV_HOST_TAG_FUNCTION && length == 12) {
+            ident = word_of(data + pos + 8, le);
+        } else if (tag == GCOV_HOST_TAG_COUNTER_BASE) {
+            int64_t at = function_base(base, ident, stamp, length / 8);
+
+            if (at < 0) {
+                fprintf(stderr, "gcov_minimize: %s: %s: not of the same build as the other tests\n",
+                        t->name, base);
+                t->failed = 1;
+                return;
+            }
+            for (uint32_t i = 0; i < length / 8; i++) {
+                const unsigned char *v = data + pos + 8 + 8 * i;
+
+                if (word_of(v, le) || word_of(v + 4, le)) {
+                    uint32_t arc = (uint32_t)at + i;
+
+                    gcov_buf_add(&t->arcs, &arc, sizeof(arc));
+                }
+            }
+        }
+        pos += 8 + length;
+    }
+}
+
+static void on_file(void *ctx, const char *filename, const unsigned char *data, size_t bytes)
+{
+    take_gcda(ctx, filename, data, bytes);
+}
+
+static void on_salvaged(void *ctx, const char *filename, const unsigned char *data, size_t bytes,
+                        const char *lost)
+{
+    Test *t = ctx;
+
+    fprintf(stderr, "gcov_minimize: %s: salvaged %s: %s\n", t->name, filename, lost);
+    take_gcda(t, filename, data, bytes);
+}
+
+static void on_skip(void *ctx, const char *filename, const char *why)
+{
+    Test *t = ctx;
+
+    fprintf(stderr, "gcov_minimize: %s: skipped %s: %s\n", t->name, filename ? filename : "output", why);
+}
+
+static void on_end(void *ctx, unsigned written, unsigned salvaged, unsigned skipped)
+{
+    (void)ctx;
+    (void)written;
+    (void)salvaged;
+    (void)skipped;
+}
+
+static int read_file(const char *path, GcovBuf *b)
+{
+    FILE *f = fopen(path, "rb");
+    unsigned char chunk[65536];
+    size_t got;
+
+    b->len = 0;
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        gcov_buf_add(b, chunk, got);
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Take the arcs of a test, from its directory of .gcda files or its saved output */
+static void load_test(Test *t)
+{
+    static const GcovDecoderCallbacks cb = { on_file, on_salvaged, on_skip, on_end };
+    GcovBuf data = { NULL, 0, 0 };
+    struct stat st;
+
+    if (stat(t->name, &st) != 0) {
+        perror(t->name);
+        t->failed = 1;
+        return;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        DIR *d = opendir(t->name);
+        struct dirent *e;
+
+        while (d && (e = readdir(d)) != NULL) {
+            size_t n = strlen(e->d_name);
+            char path[4096];
+
+            if (n > 5 && strcmp(e->d_name + n - 5, ".gcda") == 0) {
+                snprintf(path, sizeof(path), "%s/%s", t->name, e->d_name);
+                if (read_file(path, &data) == 0) {
+                    take_gcda(t, e->d_name, data.data, data.len);
+                }
+            }
+        }
+        if (d) {
+            closedir(d);
+        }
+    } else if (read_file(t->name, &data) == 0) {
+        GcovDecoder *dec = gcov_decoder_new(&cb, t);
+
+        gcov_decoder_feed(dec, data.data, data.len);
+        gcov_decoder_finish(dec);
+        gcov_decoder_free(dec);
+    } else {
+        t->failed = 1;
+    }
+    free(data.data);
+}
+
+/* Work shared out to the threads, each taking every threads-th item */
+typedef enum { LOAD, PACK, MEASURE, QUIT } Job;
+
+static pthread_barrier_t start;
+static pthread_barrier_t done;
+static Job job;
+static int *batch;              /* tests to measure */
+static int batch_count;
+
+static void pack_test(Test *t)
+{
+    const uint32_t *arc = (const uint32_t *)t->arcs.data;
+    size_t n = t->arcs.len / sizeof(*arc);
+
+    t->bits = calloc(words ? words : 1, sizeof(*t->bits));
+    if (!t->bits) {
+        perror("calloc");
+        exit(1);
+    }
+    t->first_word = words;
+    t->end_word = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t w = arc[i] / 64;
+
+        if (!(t->bits[w] & 1ull << (arc[i] % 64))) {
+            t->bits[w] |= 1ull << (arc[i] % 64);
+            t->covers++;
+        }
+        t->first_word = w < t->first_word ? w : t->first_word;
+        t->end_word = w + 1 > t->end_word ? w + 1 : t->end_word;
+    }
+    if (t->first_word > t->end_word) {
+        t->first_word = t->end_word = 0;
+    }
+    free(t->arcs.data);
+    t->arcs.data = NULL;
+    t->gain = t->covers;
+}
+
+static void measure(Test *t)
+{
+    uint64_t gain = 0;
+
+    for (uint32_t w = t->first_word; w < t->end_word; w++) {
+        gain += (uint64_t)__builtin_popcountll(t->bits[w] & ~covered[w]);
+    }
+    t->gain = gain;
+}
+
+static void run_job(int id)
+{
+    switch (job) {
+    case LOAD:
+        for (int i = id; i < test_count; i += threads) {
+            load_test(&tests[i]);
+        }
+        break;
+    case PACK:
+        for (int i = id; i < test_count; i += threads) {
+            pack_test(&tests[i]);
+        }
+        break;
+    case MEASURE:
+        for (int i = id; i < batch_count; i += threads) {
+            measure(&tests[batch[i]]);
+        }
+        break;
+    case QUIT:
+        break;
+    }
+}
+
+static void *worker(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+
+    for (;;) {
+        pthread_barrier_wait(&start);
+        if (job == QUIT) {
+            return NULL;
+        }
+        run_job(id);
+        pthread_barrier_wait(&done);
+    }
+}
+
+/* Run a job on all threads, this one as thread 0 */
+static void run(Job j)
+{
+    job = j;
+    pthread_barrier_wait(&start);
+    if (j != QUIT) {
+        run_job(0);
+        pthread_barrier_wait(&done);
+    }
+}
+
+/* Order by last gain per cost, highest first */
+static int by_bound(const void *a, const void *b)
+{
+    const Test *x = &tests[*(const int *)a];
+    const Test *y = &tests[*(const int *)b];
+    double rx = (double)x->gain / x->cost;
+    double ry = (double)y->gain / y->cost;
+
+    return rx < ry ? 1 : rx > ry ? -1 : (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+static int read_costs(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[GCOV_HOST_MAX_LINE];
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        char *space = strrchr(line, ' ');
+        char *tab = strrchr(line, '\t');
+        char *sep = tab > space ? tab : space;
+        double cost;
+
+        if (!sep) {
+            continue;
+        }
+        *sep = '\0';
+        cost = strtod(sep + 1, NULL);
+        for (int i = 0; i < test_count; i++) {
+            if (strcmp(tests[i].name, line) == 0) {
+                tests[i].cost = cost > 0 ? cost : 1e-9;
+            }
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *costs = NULL;
+    double budget = 0;
+    double spent = 0;
+    int *order;
+    int *left;
+    int left_count;
+    int picked_count = 0;
+    uint64_t all = 0;
+    uint64_t so_far = 0;
+    uint32_t *times;
+    pthread_t *thread;
+    int failed = 0;
+    int opt;
+
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    while ((opt = getopt(argc, argv, "c:b:j:")) != -1) {
+        switch (opt) {
+        case 'c': costs = optarg; break;
+        case 'b': budget = strtod(optarg, NULL); break;
+        case 'j': threads = atoi(optarg); break;
+        default:
+            optind = argc;
+            break;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-c costs] [-b budget] [-j threads] test...\n", argv[0]);
+        return 1;
+    }
+    threads = threads < 1 ? 1 : threads;
+    test_count = argc - optind;
+    tests = calloc((size_t)test_count, sizeof(*tests));
+    order = calloc((size_t)test_count, sizeof(*order));
+    left = calloc((size_t)test_count, sizeof(*left));
+    batch = calloc((size_t)threads * BATCH_PER_THREAD, sizeof(*batch));
+    thread = calloc((size_t)threads, sizeof(*thread));
+    if (!tests || !order || !left || !batch || !thread) {
+        perror("calloc");
+        return 1;
+    }
+    for (int i = 0; i < test_count; i++) {
+        tests[i].name = argv[optind + i];
+        tests[i].cost = 1;
+    }
+    if (costs && read_costs(costs) != 0) {
+        return 1;
+    }
+
+    pthread_barrier_init(&start, NULL, (unsigned)threads);
+    pthread_barrier_init(&done, NULL, (unsigned)threads);
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&thread[i], NULL, worker, (void *)(intptr_t)i) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    run(LOAD);
+    words = (uint32_t)((arc_count + 63) / 64);
+    covered = calloc(words ? words : 1, sizeof(*covered));
+    if (!covered) {
+        perror("calloc");
+        return 1;
+    }
+    run(PACK);
+
+    /* the coverage of the whole suite */
+    left_count = 0;
+    for (int i = 0; i < test_count; i++) {
+        failed |= tests[i].failed;
+        for (uint32_t w = tests[i].first_word; w < tests[i].end_word; w++) {
+            covered[w] |= tests[i].bits[w];
+        }
+        if (tests[i].covers) {
+            left[left_count++] = i;
+        }
+    }
+    for (uint32_t w = 0; w < words; w++) {
+        all += (uint64_t)__builtin_popcountll(covered[w]);
+        covered[w] = 0;
+    }
+
+    /* greedy, lazily: measure again only the tests whose last gain could beat the best */
+    while (left_count > 0) {
+        int best = -1;
+        int at = 0;
+        int keep = 0;
+
+        qsort(left, (size_t)left_count, sizeof(*left), by_bound);
+        while (at < left_count) {
+            double best_rate = best < 0 ? -1 : (double)tests[best].gain / tests[best].cost;
+            double bound = (double)tests[left[at]].gain / tests[left[at]].cost;
+
+            /* ties go to the first test given, whatever the batches */
+            if (best >= 0 && (bound < best_rate || (bound == best_rate && left[at] > best))) {
+                break;
+            }
+            batch_count = 0;
+            while (at < left_count && batch_count < threads * BATCH_PER_THREAD) {
+                if (budget <= 0 || spent + tests[left[at]].cost <= budget) {
+                    batch[batch_count++] = left[at];
+                }
+                at++;
+            }
+            run(MEASURE);
+            for (int i = 0; i < batch_count; i++) {
+                const Test *t = &tests[batch[i]];
+
+                if (t->gain > 0 && (best < 0 || (double)t->gain / t->cost > (double)tests[best].gain / tests[best].cost
+                                    || ((double)t->gain / t->cost == (double)tests[best].gain / tests[best].cost
+                                        && batch[i] < best))) {
+                    best = batch[i];
+                }
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        tests[best].picked = 1;
+        order[picked_count++] = best;
+        spent += tests[best].cost;
+        for (uint32_t w = tests[best].first_word; w < tests[best].end_word; w++) {
+            covered[w] |= tests[best].bits[w];
+        }
+        /* drop the tests that can add nothing, or no longer fit */
+        for (int i = 0; i < left_count; i++) {
+            const Test *t = &tests[left[i]];
+
+            if (!t->picked && t->gain > 0 && (budget <= 0 || spent + t->cost <= budget)) {
+                left[keep++] = left[i];
+            }
+        }
+        left_count = keep;
+    }
+
+    /* leave out picked tests whose arcs the other picked tests all cover, last picked first */
+    times = calloc(arc_count ? arc_count : 1, sizeof(*times));
+    if (!times) {
+        perror("calloc");
+        return 1;
+    }
+    for (int p = 0; p < picked_count; p++) {
+        const Test *t = &tests[order[p]];
+
+        for (uint32_t w = t->first_word; w < t->end_word; w++) {
+            for (uint64_t b = t->bits[w]; b; b &= b - 1) {
+                times[64 * (uint64_t)w + (uint64_t)__builtin_ctzll(b)]++;
+            }
+        }
+    }
+    for (int p = picked_count - 1; p >= 0; p--) {
+        Test *t = &tests[order[p]];
+        int needed = 0;
+
+        for (uint32_t w = t->first_word; w < t->end_word && !needed; w++) {
+            for (uint64_t b = t->bits[w]; b && !needed; b &= b - 1) {
+                needed = times[64 * (uint64_t)w + (uint64_t)__builtin_ctzll(b)] == 1;
+            }
+        }
+        if (!needed) {
+            for (uint32_t w = t->first_word; w < t->end_word; w++) {
+                for (uint64_t b = t->bits[w]; b; b &= b - 1) {
+                    times[64 * (uint64_t)w + (uint64_t)__builtin_ctzll(b)]--;
+                }
+            }
+            t->picked = 0;
+        }
+    }
+    free(times);
+
+    /* the tests kept, in the greedy order, with what each adds after those before */
+    memset(covered, 0, words * sizeof(*covered));
+    spent = 0;
+    for (int p = 0, rank = 0; p < picked_count; p++) {
+        Test *t = &tests[order[p]];
+
+        if (!t->picked) {
+            continue;
+        }
+        measure(t);
+        for (uint32_t w = t->first_word; w < t->end_word; w++) {
+            covered[w] |= t->bits[w];
+        }
+        so_far += t->gain;
+        spent += t->cost;
+        printf("%4d %s +%llu arcs, %llu of %llu (%.1f%%)", ++rank, t->name, (unsigned long long)t->gain,
+               (unsigned long long)so_far, (unsigned long long)all, all ? 100.0 * (double)so_far / (double)all : 100.0);
+        if (costs) {
+            printf(", cost %g, total %g", t->cost, spent);
+        }
+        printf("\n");
+        order[rank - 1] = order[p];
+    }
+    for (int p = picked_count = 0; p < test_count; p++) {
+        picked_count += tests[p].picked;
+    }
+    printf("%d of %d tests cover %llu of the %llu arcs the suite covers (of %llu arcs)\n",
+           picked_count, test_count, (unsigned long long)so_far, (unsigned long long)all,
+           (unsigned long long)arc_count);
+
+    run(QUIT);
+    for (int i = 1; i < threads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    for (int i = 0; i < test_count; i++) {
+        free(tests[i].bits);
+    }
+    for (uint32_t i = 0; i < functions; i++) {
+        free(function[i].file);
+    }
+    free(function);
+    free(slot);
+    free(covered);
+    free(tests);
+    free(order);
+    free(left);
+    free(batch);
+    free(thread);
+    return failed;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_minimize.c host tool to pick the tests that give the coverage of the whole suite
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,942 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool code to build and query an index of .gcno notes.
+ *
+ * Parses the .gcno notes format of GCC 8 and later: record lengths
+ * and string lengths in 32-bit words before GCC 12, in bytes (with
+ * strings not padded) from GCC 12, in either byte order.
+ * Of the records, keeps the function, blocks, arcs, lines, and
+ * conditions (GCC 14) records, which are what host tools need
+ * to map .gcda counters to source.
+ *
+ * The index is built in memory and written whole, through
+ * a temporary name, so a tool that has the old index mapped
+ * keeps a consistent view of it until it closes it.
+ * Building interns each string (source filenames repeat in every
+ * lines record), so the index is much smaller than the notes.
+ *
+ **********************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+#include "gcov_notes.h"
+
+#define TAG_FUNCTION 0x01000000
+#define TAG_BLOCKS 0x01410000
+#define TAG_ARCS 0x01430000
+#define TAG_LINES 0x01450000
+#define TAG_CONDITIONS 0x01470000
+
+/* Index in progress */
+typedef struct {
+    GcovBuf units;
+    GcovBuf functions;
+    GcovBuf arcs;
+    GcovBuf lines;
+    GcovBuf conditions;
+    GcovBuf strings;
+    uint64_t build_id;
+    uint32_t *string_slots;     /* hash of strings, each slot an offset, 0 if empty */
+    uint32_t string_cap;
+    uint32_t string_count;
+} Builder;
+
+/* Reader of .gcno data */
+typedef struct {
+    const unsigned char *p;
+    size_t len;
+    size_t pos;
+    int le;
+    int bytes;                  /* lengths in bytes (GCC 12 and later), else in words */
+    const char *why;            /* NULL unless damaged */
+} Reader;
+
+static uint32_t hash_string(const char *s, size_t n)
+{
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < n; i++) {
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t hash_ident(uint32_t unit, uint32_t ident)
+{
+    uint32_t h = (unit * 0x9e3779b1u) ^ ident;
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/* Mix bytes into a 64-bit hash, a word at a time (not cryptographic, only to tell builds apart) */
+static uint64_t hash_bytes(uint64_t h, const unsigned char *p, size_t n)
+{
+    uint64_t w;
+
+    for (; n >= 8; p += 8, n -= 8) {
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    w = 0;
+    memcpy(&w, p, n);
+    h = (h ^ w ^ (uint64_t)n << 56) * 0x100000001b3ULL;
+    return h ^ h >> 29;
+}
+
+/* Slots for a hash of n entries: a power of two, at most half full */
+static uint32_t slots_for(uint32_t n)
+{
+    uint32_t slots = 2;
+
+    while (slots < 2 * (uint64_t)n) {
+        slots *= 2;
+    }
+    return slots;
+}
+
+static void string_slot_add(Builder *b, uint32_t off)
+{
+    const char *s = (const char *)b->strings.data + off;
+    uint32_t i = hash_string(s, strlen(s)) & (b->string_cap - 1);
+
+    while (b->string_slots[i]) {
+        i = (i + 1) & (b->string_cap - 1);
+    }
+    b->string_slots[i] = off;
+}
+
+/* Offset of a string in the string table, adding it if new */
+static uint32_t intern(Builder *b, const char *s, size_t n)
+{
+    uint32_t i;
+    uint32_t off;
+
+    if (n == 0) {
+        return 0;
+    }
+    if (2 * (b->string_count + 1) > b->string_cap) {
+        uint32_t *old = b->string_slots;
+        uint32_t old_cap = b->string_cap;
+
+        b->string_cap = old_cap ? 2 * old_cap : 1024;
+        b->string_slots = calloc(b->string_cap, sizeof(*b->string_slots));
+        if (!b->string_slots) {
+            perror("calloc");
+            exit(1);
+        }
+        for (uint32_t j = 0; j < old_cap; j++) {
+            if (old[j]) {
+                string_slot_add(b, old[j]);
+            }
+        }
+        free(old);
+    }
+    i = hash_string(s, n) & (b->string_cap - 1);
+    while ((off = b->string_slots[i]) != 0) {
+        const char *t = (const char *)b->strings.data + off;
+
+        if (memcmp(t, s, n) == 0 && t[n] == '\0') {
+            return off;
+        }
+        i = (i + 1) & (b->string_cap - 1);
+    }
+    off = (uint32_t)b->strings.len;
+    gcov_buf_add(&b->strings, s, n);
+    gcov_buf_add(&b->strings, "", 1);
+    b->string_slots[i] = off;
+    b->string_count++;
+    return off;
+}
+
+static uint32_t get_word(const unsigned char *p, int le)
+{
+    if (le) {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+    return (uint32_t)p[3] | (uint32_t)p[2] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[0] << 24;
+}
+
+static uint32_t read_word(Reader *r)
+{
+    uint32_t v;
+
+    if (r->why) {
+        return 0;
+    }
+    if (r->len - r->pos < 4) {
+        r->why = "cut short";
+        return 0;
+    }
+    v = get_word(r->p + r->pos, r->le);
+    r->pos += 4;
+    return v;
+}
+
+/* Length of a record or string, in bytes */
+static size_t read_length(Reader *r)
+{
+    uint32_t n = read_word(r);
+    size_t bytes = r->bytes ? n : (size_t)n * 4;
+
+    if (!r->why && bytes > r->len - r->pos) {
+        r->why = "length past the end";
+        return 0;
+    }
+    return bytes;
+}
+
+static uint32_t read_string(Builder *b, Reader *r)
+{
+    size_t bytes = read_length(r);
+    const char *s = (const char *)r->p + r->pos;
+    size_t n = 0;
+
+    if (r->why) {
+        return 0;
+    }
+    while (n < bytes && s[n]) {
+        n++;
+    }
+    r->pos += bytes;
+    return intern(b, s, n);
+}
+
+/* Major version of GCC from a .gcno version, such as "B22*" for 12.2 */
+static int gcc_major(uint32_t version)
+{
+    return ((int)(version >> 24) - 'A') * 10 + ((int)(version >> 16 & 0xff) - '0');
+}
+
+static void parse_function(Builder *b, Reader *r, uint32_t unit)
+{
+    GcovIndexFunction f;
+
+    memset(&f, 0, sizeof(f));
+    f.unit = unit;
+    f.ident = read_word(r);
+    f.lineno_checksum = read_word(r);
+    f.cfg_checksum = read_word(r);
+    f.name = read_string(b, r);
+    f.artificial = read_word(r);
+    f.source = read_string(b, r);
+    f.start_line = read_word(r);
+    f.start_column = read_word(r);
+    f.end_line = read_word(r);
+    if (r->pos < r->len) {
+        /* GCC 10 and later */
+        f.end_column = read_word(r);
+    }
+    f.first_arc = (uint32_t)(b->arcs.len / sizeof(GcovIndexArc));
+    f.first_line = (uint32_t)(b->lines.len / sizeof(GcovIndexLine));
+    f.first_condition = (uint32_t)(b->conditions.len / sizeof(GcovIndexCondition));
+    gcov_buf_add(&b->functions, &f, sizeof(f));
+}
+
+static void parse_arcs(Builder *b, Reader *r, GcovIndexFunction *f)
+{
+    GcovIndexArc a;
+
+    a.src = read_word(r);
+    while (!r->why && r->len - r->pos >= 8) {
+        a.dest = read_word(r);
+        a.flags = read_word(r);
+        gcov_buf_add(&b->arcs, &a, sizeof(a));
+        f->arcs++;
+        if (!(a.flags & GCOV_ARC_ON_TREE)) {
+            f->counters++;
+        }
+    }
+}
+
+static void parse_lines(Builder *b, Reader *r, GcovIndexFunction *f)
+{
+    GcovIndexLine l;
+
+    l.block = read_word(r);
+    l.source = f->source;
+    while (!r->why && r->pos < r->len) {
+        uint32_t w = read_word(r);
+
+        if (w == 0) {
+            /* a source filename, or the end if none */
+            l.source = read_string(b, r);
+            if (l.source == 0) {
+                break;
+            }
+        } else {
+            l.line = w;
+            gcov_buf_add(&b->lines, &l, sizeof(l));
+            f->lines++;
+        }
+    }
+}
+
+/* Each condition expression: its block, and its count of terms */
+static void parse_conditions(Builder *b, Reader *r, GcovIndexFunction *f)
+{
+    GcovIndexCondition c;
+
+    if (f->conditions) {
+        r->why = "second conditions record of a function";
+        return;
+    }
+    while (!r->why && r->len - r->pos >= 8) {
+        c.block = read_word(r);
+        c.terms = read_word(r);
+        if (c.block >= f->blocks || c.terms == 0 || c.terms > 64) {
+            r->why = "condition out of range";
+            return;
+        }
+        gcov_buf_add(&b->conditions, &c, sizeof(c));
+        f->conditions++;
+    }
+}
+
+/* Add the functions of .gcno data as unit u, returns NULL, or why not (leaving none added) */
+static const char *parse_notes(Builder *b, const unsigned char *data, size_t len, GcovIndexUnit *u)
+{
+    Reader r = { data, len, 0, 1, 1, NULL };
+    size_t functions_len = b->functions.len;
+    size_t arcs_len = b->arcs.len;
+    size_t lines_len = b->lines.len;
+    size_t conditions_len = b->conditions.len;
+    uint32_t unit = (uint32_t)(b->units.len / sizeof(GcovIndexUnit));
+    int major;
+
+    if (len < 4) {
+        return "not a .gcno file";
+    }
+    if (get_word(data, 1) != GCOV_NOTES_MAGIC) {
+        r.le = 0;
+        if (get_word(data, 0) != GCOV_NOTES_MAGIC) {
+            return "not a .gcno file";
+        }
+    }
+    r.pos = 4;
+    u->version = read_word(&r);
+    major = gcc_major(u->version);
+    if (major < 8) {
+        return "unsupported .gcno version (before GCC 8)";
+    }
+    r.bytes = major >= 12;
+    u->stamp = read_word(&r);
+    u->checksum = major >= 12 ? read_word(&r) : 0;
+    u->cwd = read_string(b, &r);
+    (void)read_word(&r);        /* has_unexecuted_blocks */
+    u->first_function = (uint32_t)(functions_len / sizeof(GcovIndexFunction));
+
+    while (!r.why && r.pos < r.len) {
+        uint32_t tag = read_word(&r);
+        size_t bytes = read_length(&r);
+        Reader rec = r;
+        GcovIndexFunction *f = b->functions.len > functions_len
+            ? (GcovIndexFunction *)(b->functions.data + b->functions.len) - 1 : NULL;
+
+        if (r.why) {
+            break;
+        }
+        rec.len = r.pos + bytes;
+        switch (tag) {
+        case TAG_FUNCTION:
+            parse_function(b, &rec, unit);
+            break;
+        case TAG_BLOCKS:
+            if (f) {
+                f->blocks = read_word(&rec);
+            }
+            break;
+        case TAG_ARCS:
+            if (f) {
+                parse_arcs(b, &rec, f);
+            }
+            break;
+        case TAG_LINES:
+            if (f) {
+                parse_lines(b, &rec, f);
+            }
+            break;
+        case TAG_CONDITIONS:
+            if (f) {
+                parse_conditions(b, &rec, f);
+            }
+            break;
+        default:
+            break;
+        }
+        if (rec.why) {
+            r.why = rec.why;
+        }
+        r.pos += bytes;
+    }
+    if (r.why) {
+        b->functions.len = functions_len;
+        b->arcs.len = arcs_len;
+        b->lines.len = lines_len;
+        b->conditions.len = conditions_len;
+        return r.why;
+    }
+    u->functions = (uint32_t)((b->functions.len - functions_len) / sizeof(GcovIndexFunction));
+    return NULL;
+}
+
+/* Read a whole file, returns NULL after printing why not */
+static unsigned char *read_whole(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    GcovBuf b = { NULL, 0, 0 };
+    unsigned char chunk[65536];
+    size_t got;
+
+    if (!f) {
+        fprintf(stderr, "gcov_index: %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        gcov_buf_add(&b, chunk, got);
+    }
+    if (ferror(f)) {
+        fprintf(stderr, "gcov_index: %s: %s\n", path, strerror(errno));
+        fclose(f);
+        free(b.data);
+        return NULL;
+    }
+    fclose(f);
+    *len = b.len;
+    return b.data ? b.data : calloc(1, 1);
+}
+
+/* .gcno files found, as real paths */
+typedef struct {
+    char **path;
+    size_t count;
+    size_t cap;
+} PathList;
+
+static void add_path(PathList *l, const char *path)
+{
+    char *real = realpath(path, NULL);
+
+    if (!real) {
+        fprintf(stderr, "gcov_index: %s: %s\n", path, strerror(errno));
+        return;
+    }
+    if (l->count == l->cap) {
+        l->cap = l->cap ? 2 * l->cap : 256;
+        l->path = realloc(l->path, l->cap * sizeof(*l->path));
+        if (!l->path) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    l->path[l->count++] = real;
+}
+
+static int is_notes(const char *name)
+{
+    size_t n = strlen(name);
+
+    return n > 5 && strcmp(name + n - 5, ".gcno") == 0;
+}
+
+static void find_notes(PathList *l, const char *dir)
+{
+    DIR *d = opendir(dir);
+    struct dirent *e;
+
+    if (!d) {
+        fprintf(stderr, "gcov_index: %s: %s\n", dir, strerror(errno));
+        return;
+    }
+    while ((e = readdir(d)) != NULL) {
+        char path[PATH_MAX];
+        struct stat st;
+
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        /* not following links to directories, which may loop */
+        if (lstat(path, &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            find_notes(l, path);
+        } else if (is_notes(e->d_name) && stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            add_path(l, path);
+        }
+    }
+    closedir(d);
+}
+
+static int compare_paths(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int64_t mtime_of(const struct stat *st)
+{
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+static GcovIndex *open_index(const char *index_path, int quiet);
+
+/* Whether the index at index_path is of exactly these files, unchanged */
+static int up_to_date(const char *index_path, const PathList *l)
+{
+    GcovIndex *ix = open_index(index_path, 1);
+    int current;
+
+    if (!ix) {
+        return 0;
+    }
+    current = ix->header->units == l->count && gcov_index_stale(ix) == 0;
+    for (uint32_t i = 0; current && i < ix->header->units; i++) {
+        current = strcmp(gcov_index_string(ix, ix->unit[i].path), l->path[i]) == 0;
+    }
+    gcov_index_close(ix);
+    return current;
+}
+
+/* Stem of a filename: its basename without .gcda or .gcno */
+static const char *stem_of(const char *filename, size_t *n)
+{
+    const char *base = strrchr(filename, '/');
+
+    base = base ? base + 1 : filename;
+    *n = strlen(base);
+    if (*n > 5 && (strcmp(base + *n - 5, ".gcda") == 0 || strcmp(base + *n - 5, ".gcno") == 0)) {
+        *n -= 5;
+    }
+    return base;
+}
+
+static void pad(GcovBuf *out)
+{
+    static const unsigned char zero[8];
+
+    gcov_buf_add(out, zero, (8 - out->len % 8) % 8);
+}
+
+/* Put the tables and their hashes in out, as the index file */
+static void lay_out(Builder *b, GcovBuf *out)
+{
+    GcovIndexHeader h;
+    const GcovIndexUnit *units = (const GcovIndexUnit *)b->units.data;
+    const GcovIndexFunction *functions = (const GcovIndexFunction *)b->functions.data;
+    const char *strings = (const char *)b->strings.data;
+    uint32_t *unit_hash;
+    uint32_t *function_hash;
+    uint32_t *name_hash;
+
+    memset(&h, 0, sizeof(h));
+    h.magic = GCOV_INDEX_MAGIC;
+    h.version = GCOV_INDEX_VERSION;
+    h.units = (uint32_t)(b->units.len / sizeof(GcovIndexUnit));
+    h.functions = (uint32_t)(b->functions.len / sizeof(GcovIndexFunction));
+    h.arcs = (uint32_t)(b->arcs.len / sizeof(GcovIndexArc));
+    h.lines = (uint32_t)(b->lines.len / sizeof(GcovIndexLine));
+    h.conditions = (uint32_t)(b->conditions.len / sizeof(GcovIndexCondition));
+    h.unit_slots = slots_for(h.units);
+    h.function_slots = slots_for(h.functions);
+    h.build_id = b->build_id;
+
+    unit_hash = calloc(h.unit_slots, sizeof(*unit_hash));
+    function_hash = calloc(h.function_slots, sizeof(*function_hash));
+    name_hash = calloc(h.function_slots, sizeof(*name_hash));
+    if (!unit_hash || !function_hash || !name_hash) {
+        perror("calloc");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < h.units; i++) {
+        const char *stem = strings + units[i].stem;
+        uint32_t s = hash_string(stem, strlen(stem)) & (h.unit_slots - 1);
+
+        for (; unit_hash[s]; s = (s + 1) & (h.unit_slots - 1)) {
+            if (units[unit_hash[s] - 1].stem == units[i].stem) {
+                /* interned, so the same offset is the same stem */
+                fprintf(stderr, "gcov_index: %s: same name as %s, not found by name\n",
+                        strings + units[i].path, strings + units[unit_hash[s] - 1].path);
+                break;
+            }
+        }
+        if (!unit_hash[s]) {
+            unit_hash[s] = i + 1;
+        }
+    }
+    for (uint32_t i = 0; i < h.functions; i++) {
+        const char *name = strings + functions[i].name;
+        uint32_t s = hash_ident(functions[i].unit, functions[i].ident) & (h.function_slots - 1);
+
+        while (function_hash[s]) {
+            s = (s + 1) & (h.function_slots - 1);
+        }
+        function_hash[s] = i + 1;
+        s = hash_string(name, strlen(name)) & (h.function_slots - 1);
+        while (name_hash[s]) {
+            s = (s + 1) & (h.function_slots - 1);
+        }
+        name_hash[s] = i + 1;
+    }
+
+    gcov_buf_add(out, &h, sizeof(h));
+    pad(out);
+    h.unit_at = out->len;
+    gcov_buf_add(out, b->units.data, b->units.len);
+    pad(out);
+    h.function_at = out->len;
+    gcov_buf_add(out, b->functions.data, b->functions.len);
+    pad(out);
+    h.arc_at = out->len;
+    gcov_buf_add(out, b->arcs.data, b->arcs.len);
+    pad(out);
+    h.line_at = out->len;
+    gcov_buf_add(out, b->lines.data, b->lines.len);
+    pad(out);
+    h.condition_at = out->len;
+    gcov_buf_add(out, b->conditions.data, b->conditions.len);
+    pad(out);
+    h.unit_hash_at = out->len;
+    gcov_buf_add(out, unit_hash, h.unit_slots * sizeof(*unit_hash));
+    pad(out);
+    h.function_hash_at = out->len;
+    gcov_buf_add(out, function_hash, h.function_slots * sizeof(*function_hash));
+    pad(out);
+    h.name_hash_at = out->len;
+    gcov_buf_add(out, name_hash, h.function_slots * sizeof(*name_hash));
+    pad(out);
+    h.string_at = out->len;
+    h.string_bytes = b->strings.len;
+    gcov_buf_add(out, b->strings.data, b->strings.len);
+    pad(out);
+    h.size = out->len;
+    memcpy(out->data, &h, sizeof(h));
+
+    free(unit_hash);
+    free(function_hash);
+    free(name_hash);
+}
+
+int gcov_index_build(const char *index_path, char *const *paths, int count, int force, unsigned *skipped)
+{
+    PathList l = { NULL, 0, 0 };
+    Builder b;
+    GcovBuf out = { NULL, 0, 0 };
+    size_t kept = 0;
+    int result;
+
+    *skipped = 0;
+    for (int i = 0; i < count; i++) {
+        struct stat st;
+
+        if (stat(paths[i], &st) != 0) {
+            fprintf(stderr, "gcov_index: %s: %s\n", paths[i], strerror(errno));
+            (*skipped)++;
+        } else if (S_ISDIR(st.st_mode)) {
+            find_notes(&l, paths[i]);
+        } else {
+            add_path(&l, paths[i]);
+        }
+    }
+    qsort(l.path, l.count, sizeof(*l.path), compare_paths);
+    for (size_t i = 0; i < l.count; i++) {
+        /* the same file given twice */
+        if (kept == 0 || strcmp(l.path[kept - 1], l.path[i]) != 0) {
+            l.path[kept++] = l.path[i];
+        } else {
+            free(l.path[i]);
+        }
+    }
+    l.count = kept;
+
+    if (!force && *skipped == 0 && up_to_date(index_path, &l)) {
+        result = 1;
+    } else {
+        memset(&b, 0, sizeof(b));
+        b.build_id = 14695981039346656037ULL;
+        gcov_buf_add(&b.strings, "", 1);  /* offset 0, the empty string */
+        for (size_t i = 0; i < l.count; i++) {
+            GcovIndexUnit u;
+            struct stat st;
+            unsigned char *data;
+            size_t len;
+            const char *why;
+            size_t stem_len;
+            const char *stem = stem_of(l.path[i], &stem_len);
+
+            memset(&u, 0, sizeof(u));
+            data = read_whole(l.path[i], &len);
+            if (!data || stat(l.path[i], &st) != 0) {
+                free(data);
+                (*skipped)++;
+                continue;
+            }
+            why = parse_notes(&b, data, len, &u);
+            if (!why) {
+                b.build_id = hash_bytes(b.build_id, (const unsigned char *)stem, stem_len);
+                b.build_id = hash_bytes(b.build_id, data, len);
+            }
+            free(data);
+            if (why) {
+                fprintf(stderr, "gcov_index: %s: %s, left out\n", l.path[i], why);
+                (*skipped)++;
+                continue;
+            }
+            u.path = intern(&b, l.path[i], strlen(l.path[i]));
+            u.stem = intern(&b, stem, stem_len);
+            u.mtime = mtime_of(&st);
+            u.size = (uint64_t)st.st_size;
+            gcov_buf_add(&b.units, &u, sizeof(u));
+        }
+        lay_out(&b, &out);
+        if (gcov_write_whole(index_path, out.data, out.len) != 0) {
+            fprintf(stderr, "gcov_index: %s: %s\n", index_path, strerror(errno));
+            result = -1;
+        } else {
+            result = 0;
+        }
+        free(out.data);
+        free(b.units.data);
+        free(b.functions.data);
+        free(b.arcs.data);
+        free(b.lines.data);
+        free(b.conditions.data);
+        free(b.strings.data);
+        free(b.string_slots);
+    }
+    for (size_t i = 0; i < l.count; i++) {
+        free(l.path[i]);
+    }
+    free(l.path);
+    return result;
+}
+
+/* Whether a table of count entries of size bytes at at fits the index */
+static int table_fits(size_t size, uint64_t at, uint64_t count, size_t bytes)
+{
+    return at % 8 == 0 && at <= size && count <= (size - at) / bytes;
+}
+
+static GcovIndex *open_index(const char *index_path, int quiet)
+{
+    int fd = open(index_path, O_RDONLY);
+    struct stat st;
+    GcovIndex *ix;
+    const GcovIndexHeader *h;
+    void *base;
+
+    if (fd < 0) {
+        if (!quiet) {
+            fprintf(stderr, "gcov_index: %s: %s\n", index_path, strerror(errno));
+        }
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(GcovIndexHeader)) {
+        if (!quiet) {
+            fprintf(stderr, "gcov_index: %s: not an index\n", index_path);
+        }
+        close(fd);
+        return NULL;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        if (!quiet) {
+            fprintf(stderr, "gcov_index: %s: %s\n", index_path, strerror(errno));
+        }
+        return NULL;
+    }
+    /* check the layout, not the contents, so that opening stays instant */
+    h = base;
+    if (h->magic != GCOV_INDEX_MAGIC || h->version != GCOV_INDEX_VERSION || h->size != (uint64_t)st.st_size
+        || (h->unit_slots & (h->unit_slots - 1)) || (h->function_slots & (h->function_slots - 1))
+        || h->unit_slots <= h->units || h->function_slots <= h->functions
+        || !table_fits(h->size, h->unit_at, h->units, sizeof(GcovIndexUnit))
+        || !table_fits(h->size, h->function_at, h->functions, sizeof(GcovIndexFunction))
+        || !table_fits(h->size, h->arc_at, h->arcs, sizeof(GcovIndexArc))
+        || !table_fits(h->size, h->line_at, h->lines, sizeof(GcovIndexLine))
+        || !table_fits(h->size, h->condition_at, h->conditions, sizeof(GcovIndexCondition))
+        || !table_fits(h->size, h->unit_hash_at, h->unit_slots, sizeof(uint32_t))
+        || !table_fits(h->size, h->function_hash_at, h->function_slots, sizeof(uint32_t))
+        || !table_fits(h->size, h->name_hash_at, h->function_slots, sizeof(uint32_t))
+        || !table_fits(h->size, h->string_at, h->string_bytes, 1)
+        || h->string_bytes == 0 || ((const char *)base)[h->string_at + h->string_bytes - 1] != '\0') {
+        if (!quiet) {
+            fprintf(stderr, "gcov_index: %s: not an index of this version and host\n", index_path);
+        }
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    ix = calloc(1, sizeof(*ix));
+    if (!ix) {
+        perror("calloc");
+        exit(1);
+    }
+    ix->base = base;
+    ix->size = (size_t)st.st_size;
+    ix->header = h;
+    ix->unit = (const GcovIndexUnit *)(ix->base + h->unit_at);
+    ix->function = (const GcovIndexFunction *)(ix->base + h->function_at);
+    ix->arc = (const GcovIndexArc *)(ix->base + h->arc_at);
+    ix->line = (const GcovIndexLine *)(ix->base + h->line_at);
+    ix->condition = (const GcovIndexCondition *)(ix->base + h->condition_at);
+    ix->unit_hash = (const uint32_t *)(ix->base + h->unit_hash_at);
+    ix->function_hash = (const uint32_t *)(ix->base + h->function_hash_at);
+    ix->name_hash = (const uint32_t *)(ix->base + h->name_hash_at);
+    ix->strings = (const char *)(ix->base + h->string_at);
+    return ix;
+}
+
+GcovIndex *gcov_index_open(const char *index_path)
+{
+    return open_index(index_path, 0);
+}
+
+void gcov_index_close(GcovIndex *ix)
+{
+    if (ix) {
+        munmap((void *)ix->base, ix->size);
+        free(ix);
+    }
+}
+
+void gcov_index_build_id(const GcovIndex *ix, char id[17])
+{
+    snprintf(id, 17, "%016llx", (unsigned long long)ix->header->build_id);
+}
+
+unsigned gcov_index_stale(const GcovIndex *ix)
+{
+    unsigned stale = 0;
+
+    for (uint32_t i = 0; i < ix->header->units; i++) {
+        struct stat st;
+
+        if (stat(gcov_index_string(ix, ix->unit[i].path), &st) != 0
+            || mtime_of(&st) != ix->unit[i].mtime || (uint64_t)st.st_size != ix->unit[i].size) {
+            stale++;
+        }
+    }
+    return stale;
+}
+
+const char *gcov_index_string(const GcovIndex *ix, uint32_t s)
+{
+    return s < ix->header->string_bytes ? ix->strings + s : "";
+}
+
+const GcovIndexUnit *gcov_index_unit(const GcovIndex *ix, const char *filename)
+{
+    size_t n;
+    const char *stem = stem_of(filename, &n);
+    uint32_t mask = ix->header->unit_slots - 1;
+    uint32_t v;
+
+    for (uint32_t s = hash_string(stem, n) & mask; (v = ix->unit_hash[s]) != 0; s = (s + 1) & mask) {
+        const char *t;
+
+        if (v > ix->header->units) {
+            break;
+        }
+        t = gcov_index_string(ix, ix->unit[v - 1].stem);
+        if (strncmp(t, stem, n) == 0 && t[n] == '\0') {
+            return &ix->unit[v - 1];
+        }
+    }
+    return NULL;
+}
+
+const GcovIndexFunction *gcov_index_function(const GcovIndex *ix, const GcovIndexUnit *u, uint32_t ident)
+{
+    uint32_t unit = (uint32_t)(u - ix->unit);
+    uint32_t mask = ix->header->function_slots - 1;
+    uint32_t v;
+
+    for (uint32_t s = hash_ident(unit, ident) & mask; (v = ix->function_hash[s]) != 0; s = (s + 1) & mask) {
+        if (v > ix->header->functions) {
+            break;
+        }
+        if (ix->function[v - 1].unit == unit && ix->function[v - 1].ident == ident) {
+            return &ix->function[v - 1];
+        }
+    }
+    return NULL;
+}
+
+const GcovIndexFunction *gcov_index_named(const GcovIndex *ix, const char *name, uint32_t *pos)
+{
+    uint32_t mask = ix->header->function_slots - 1;
+    uint32_t s;
+    uint32_t v;
+
+    /* *pos is the count of slots already probed */
+    if (*pos > mask) {
+        return NULL;
+    }
+    s = (hash_string(name, strlen(name)) + *pos) & mask;
+    for (; (v = ix->name_hash[s]) != 0 && *pos <= mask; s = (s + 1) & mask) {
+        (*pos)++;
+        if (v > ix->header->functions) {
+            break;
+        }
+        if (strcmp(gcov_index_string(ix, ix->function[v - 1].name), name) == 0) {
+            return &ix->function[v - 1];
+        }
+    }
+    *pos = mask + 1;
+    return NULL;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_notes.c host tool code to build and query an index of .gcno notes
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,210 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host tool interface to an index of the .gcno notes of a build.
+ *
+ * The .gcno notes files written by the compiler (into objs/) describe
+ * each function that the .gcda counters count: its name, source file,
+ * lines, arcs, and (GCC 14 -fcondition-coverage) conditions. Instead of each host step parsing all of the notes
+ * again, gcov_index compiles them once per build into a single index
+ * file, which host tools map into memory and query directly.
+ *
+ * The index is in the host's byte order, for the host that builds it,
+ * and holds the size and modification time of each .gcno file,
+ * so that a stale index is rebuilt, not used.
+ *
+ **********************************************************************/
+
+#ifndef GCOV_NOTES_H
+#define GCOV_NOTES_H GCOV_NOTES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GCOV_NOTES_MAGIC 0x67636e6f     /* "gcno" */
+#define GCOV_INDEX_MAGIC 0x47637649     /* "GcvI" */
+#define GCOV_INDEX_VERSION 3
+
+/* Arc flags, as in the .gcno arcs records */
+#define GCOV_ARC_ON_TREE 1              /* not counted, derived from the other arcs */
+#define GCOV_ARC_FAKE 2
+#define GCOV_ARC_FALLTHROUGH 4
+
+/*
+ * Index file layout: the header, then each table at its offset
+ * (8-byte aligned). Strings are offsets into the string table,
+ * 0 for the empty string. Hash tables are of slot counts that are
+ * powers of two, each slot 0 if empty, else the table index + 1,
+ * probed linearly.
+ */
+typedef struct {
+    uint32_t magic;             /* GCOV_INDEX_MAGIC */
+    uint32_t version;           /* GCOV_INDEX_VERSION */
+    uint32_t units;
+    uint32_t functions;
+    uint32_t arcs;
+    uint32_t lines;
+    uint32_t unit_slots;        /* of the hash of units by stem */
+    uint32_t function_slots;    /* of the hashes of functions by unit and ident, and by name */
+    uint32_t conditions;
+    uint32_t unused;            /* (to align what follows) */
+    uint64_t build_id;          /* hash of the names and contents of the .gcno files */
+    uint64_t unit_at;
+    uint64_t function_at;
+    uint64_t arc_at;
+    uint64_t line_at;
+    uint64_t condition_at;
+    uint64_t unit_hash_at;
+    uint64_t function_hash_at;
+    uint64_t name_hash_at;
+    uint64_t string_at;
+    uint64_t string_bytes;
+    uint64_t size;              /* of the whole index file */
+} GcovIndexHeader;
+
+/* One .gcno file, as one compilation unit */
+typedef struct {
+    uint32_t path;              /* the .gcno file, as found */
+    uint32_t stem;              /* its basename without .gcno, as its .gcda is named */
+    uint32_t cwd;               /* of the compiler */
+    uint32_t version;           /* of the .gcno format */
+    uint32_t stamp;             /* matches the stamp of its .gcda */
+    uint32_t checksum;          /* matches the checksum of its .gcda (GCC 12 and later, else 0) */
+    uint32_t first_function;
+    uint32_t functions;
+    int64_t mtime;              /* of the .gcno file, to tell if the index is stale */
+    uint64_t size;              /* of the .gcno file, to tell if the index is stale */
+} GcovIndexUnit;
+
+/* One function, as in the function record of the .gcno file */
+typedef struct {
+    uint32_t unit;
+    uint32_t ident;             /* as in the .gcda function record */
+    uint32_t lineno_checksum;
+    uint32_t cfg_checksum;
+    uint32_t name;              /* assembler name */
+    uint32_t source;
+    uint32_t artificial;
+    uint32_t start_line;
+    uint32_t start_column;
+    uint32_t end_line;
+    uint32_t end_column;        /* 0 before GCC 10 */
+    uint32_t blocks;
+    uint32_t first_arc;
+    uint32_t arcs;
+    uint32_t counters;          /* arcs not on the spanning tree: the arc counters in the .gcda */
+    uint32_t first_line;
+    uint32_t lines;
+    uint32_t first_condition;
+    uint32_t conditions;        /* condition expressions: half the condition counters in the .gcda */
+} GcovIndexFunction;
+
+/* One arc, in the order of the .gcno (and of the arc counters, if not on the tree) */
+typedef struct {
+    uint32_t src;
+    uint32_t dest;
+    uint32_t flags;
+} GcovIndexArc;
+
+/* One line of a block */
+typedef struct {
+    uint32_t block;
+    uint32_t source;
+    uint32_t line;
+} GcovIndexLine;
+
+/* One condition expression, in the order of the condition counters (pairs of bitmasks) */
+typedef struct {
+    uint32_t block;             /* of the expression's decision */
+    uint32_t terms;             /* of the expression, the bits of its bitmasks */
+} GcovIndexCondition;
+
+/* An index mapped into memory, read only */
+typedef struct {
+    const unsigned char *base;
+    size_t size;
+    const GcovIndexHeader *header;
+    const GcovIndexUnit *unit;
+    const GcovIndexFunction *function;
+    const GcovIndexArc *arc;
+    const GcovIndexLine *line;
+    const GcovIndexCondition *condition;
+    const uint32_t *unit_hash;
+    const uint32_t *function_hash;
+    const uint32_t *name_hash;
+    const char *strings;
+} GcovIndex;
+
+/*
+ * Build the index of the .gcno files of paths (files, or directories
+ * searched recursively) into index_path, unless force is 0 and it is
+ * already up to date with exactly those files.
+ * A .gcno file that cannot be read or parsed is reported and left out.
+ * Returns 1 if up to date, 0 if built, -1 if not (after printing why),
+ * with the count of .gcno files left out.
+ */
+int gcov_index_build(const char *index_path, char *const *paths, int count, int force, unsigned *skipped);
+
+/* Map an index into memory, returns NULL after printing why not */
+GcovIndex *gcov_index_open(const char *index_path);
+void gcov_index_close(GcovIndex *ix);
+
+/* Build ID of the index, as 16 hex digits, for naming what is derived from it */
+void gcov_index_build_id(const GcovIndex *ix, char id[17]);
+
+/* Count of units whose .gcno file has changed or gone since the index was built */
+unsigned gcov_index_stale(const GcovIndex *ix);
+
+/* String of the index */
+const char *gcov_index_string(const GcovIndex *ix, uint32_t s);
+
+/* Unit of a .gcda or .gcno filename (with any directory), by its stem, or NULL */
+const GcovIndexUnit *gcov_index_unit(const GcovIndex *ix, const char *filename);
+
+/* Function of a unit by its ident, or NULL */
+const GcovIndexFunction *gcov_index_function(const GcovIndex *ix, const GcovIndexUnit *u, uint32_t ident);
+
+/*
+ * Functions by name, one by one: *pos is 0 for the first,
+ * returns NULL after the last (static functions of many units may share a name)
+ */
+const GcovIndexFunction *gcov_index_named(const GcovIndex *ix, const char *name, uint32_t *pos);
+
+#endif /* GCOV_NOTES_H */
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_notes.h host tool interface to an index of .gcno notes
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
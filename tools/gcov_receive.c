@@ -0,0 +1,432 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host receiver for GCOV_OPT_OUTPUT_SERIAL_CHUNKED output.
+ *
+ * Reads the target output from a serial device, pty, fifo or log file,
+ * checks and reassembles the "Gcov Chunk" lines of each file entry
+ * (keeping those after a lost one, so only the lost one is sent again),
+ * acknowledges what has been received with "Gcov Ack <entry> <offset>"
+ * lines (which your target command code passes to __gcov_transfer_ack),
+ * and writes each .gcda file only when it is complete.
+ *
+ * Typical usage:
+ *   ./gcov_receive -o ../objs -x /dev/ttyUSB0
+ *   ./gcov_receive -o ../objs -a /tmp/to_target.fifo /tmp/from_target.fifo
+ *   ./gcov_receive -o ../objs ../test01_serial_log.txt
+ *
+ * Options:
+ *   -o dir   directory for the .gcda files (default current directory),
+ *            files are named by the basename of the target filename
+ *   -a path  write acknowledgments to path instead of back to the input
+ *            (default is back to the input if it is a tty, else none)
+ *   -b baud  set a serial device to raw mode at this baud rate
+ *   -x       exit at "Gcov End" or "Gcov Stalled"
+ *            (always exits at end of a regular file)
+ *
+ * Exits with 0 if every file entry of the last transfer was received,
+ * otherwise lists the missing ones and exits with 2,
+ * so that partial results are never mistaken for complete ones.
+ *
+ **********************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+typedef struct {
+    char *filename;         /* target filename, NULL until "Gcov Entry" seen */
+    unsigned bytes;         /* total bytes of the file entry */
+    unsigned check;         /* check of its data, new data if it changes */
+    unsigned have;          /* bytes received in order so far */
+    unsigned char *data;
+    unsigned char *got;     /* bit per byte of data received, in order or not */
+    int written;
+} Entry;
+
+static Entry *entries = NULL;
+static unsigned n_entries = 0;
+static const char *out_dir = ".";
+static int ack_fd = -1;
+
+/* Same CRC-16/CCITT as gcov_public.c */
+static unsigned crc16(unsigned crc, unsigned char byte)
+{
+    crc ^= (unsigned)byte << 8;
+    for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+    return crc & 0xffff;
+}
+
+static Entry *get_entry(unsigned entry)
+{
+    if (entry >= n_entries) {
+        unsigned n = entry + 1;
+
+        entries = realloc(entries, n * sizeof(*entries));
+        if (!entries) {
+            perror("realloc");
+            exit(1);
+        }
+        memset(entries + n_entries, 0, (n - n_entries) * sizeof(*entries));
+        n_entries = n;
+    }
+    return entries + entry;
+}
+
+static void reset_entries(void)
+{
+    for (unsigned i = 0; i < n_entries; i++) {
+        free(entries[i].filename);
+        free(entries[i].data);
+        free(entries[i].got);
+    }
+    free(entries);
+    entries = NULL;
+    n_entries = 0;
+}
+
+static void send_ack(unsigned entry, unsigned offset)
+{
+    char line[64];
+    int len;
+
+    if (ack_fd < 0) {
+        return;
+    }
+    len = snprintf(line, sizeof(line), "Gcov Ack %u %u\n", entry, offset);
+    if (write(ack_fd, line, len) != len) {
+        if (errno == EPIPE) {
+            /* target gone (its last lines may still be coming), no more acks */
+            close(ack_fd);
+            ack_fd = -1;
+            return;
+        }
+        perror("ack write");
+    }
+}
+
+/* Write through a temporary name, so a .gcda file is either complete or absent */
+static void write_entry(Entry *e)
+{
+    const char *base = strrchr(e->filename, '/');
+    char path[4096];
+    char tmp[4096 + 8];
+    FILE *f;
+
+    base = base ? base + 1 : e->filename;
+    snprintf(path, sizeof(path), "%s/%s", out_dir, base);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    f = fopen(tmp, "wb");
+    if (!f || fwrite(e->data, 1, e->bytes, f) != e->bytes || fclose(f) != 0) {
+        fprintf(stderr, "gcov_receive: cannot write %s: %s\n", tmp, strerror(errno));
+        exit(1);
+    }
+    if (rename(tmp, path) != 0) {
+        fprintf(stderr, "gcov_receive: cannot rename %s: %s\n", tmp, strerror(errno));
+        exit(1);
+    }
+    e->written = 1;
+    printf("Received %u bytes for %s\n", e->bytes, path);
+}
+
+static void do_entry(const char *args)
+{
+    unsigned entry, bytes, check;
+    int n = 0;
+    Entry *e;
+
+    if (sscanf(args, "%u %u %x %n", &entry, &bytes, &check, &n) != 3 || !args[n]) {
+        return;
+    }
+    e = get_entry(entry);
+    if (!e->filename || strcmp(e->filename, args + n) != 0 || e->bytes != bytes || e->check != check) {
+        /* not the data received so far, so start over */
+        free(e->filename);
+        free(e->data);
+        free(e->got);
+        e->filename = strdup(args + n);
+        e->bytes = bytes;
+        e->check = check;
+        e->have = 0;
+        e->written = 0;
+        e->data = malloc(bytes ? bytes : 1);
+        e->got = calloc(bytes / 8 + 1, 1);
+        if (!e->filename || !e->data || !e->got) {
+            perror("malloc");
+            exit(1);
+        }
+    }
+}
+
+static void do_chunk(const char *args)
+{
+    unsigned entry, offset, len, crc, check = 0xffff;
+    unsigned char data[4096];
+    unsigned count = 0;
+    const char *p;
+    int n = 0;
+    Entry *e;
+
+    if (sscanf(args, "%u %u %u %x: %n", &entry, &offset, &len, &crc, &n) != 4 || n == 0 ||
+        len > sizeof(data)) {
+        return;
+    }
+    for (p = args + n; *p; ) {
+        unsigned v;
+        int used;
+
+        if (sscanf(p, "%2x%n", &v, &used) != 1 || used != 2 || count >= sizeof(data)) {
+            return;
+        }
+        data[count++] = (unsigned char)v;
+        p += used;
+        while (*p == ' ') p++;
+    }
+    if (count != len) {
+        return;
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) check = crc16(check, (unsigned char)(entry >> shift));
+    for (int shift = 24; shift >= 0; shift -= 8) check = crc16(check, (unsigned char)(offset >> shift));
+    for (unsigned i = 0; i < len; i++) check = crc16(check, data[i]);
+    if (check != crc) {
+        /* garbled line, the target will go back after its timeout */
+        return;
+    }
+
+    e = get_entry(entry);
+    if (!e->filename || e->written) {
+        /* missed the entry line, ask for it again from the start,
+         * or already complete, repeat the acknowledgment */
+        send_ack(e->written ? entry + 1 : entry, 0);
+        return;
+    }
+    if (offset + len > e->have && offset + len <= e->bytes) {
+        /* keep it even after a gap, then move on over all that is here */
+        memcpy(e->data + offset, data, len);
+        for (unsigned i = offset; i < offset + len; i++) {
+            e->got[i / 8] |= (unsigned char)(1u << (i % 8));
+        }
+        while (e->have < e->bytes && (e->got[e->have / 8] & (1u << (e->have % 8)))) {
+            e->have++;
+        }
+    }
+    if (e->have >= e->bytes) {
+        write_entry(e);
+        send_ack(entry + 1, 0);
+    } else {
+        send_ack(entry, e->have);
+    }
+}
+
+/* Returns nonzero if all entries of the transfer were received */
+static int report(void)
+{
+    int ok = 1;
+
+    for (unsigned i = 0; i < n_entries; i++) {
+        if (entries[i].filename && !entries[i].written) {
+            fprintf(stderr, "gcov_receive: incomplete %u of %u bytes for %s\n",
+                    entries[i].have, entries[i].bytes, entries[i].filename);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+/* Returns 1 for "Gcov End", -1 for "Gcov Stalled", else 0 */
+static int do_line(char *line)
+{
+    char *p;
+    char *q = line;
+
+    /* drop carriage returns (and NULs, already made into them) */
+    for (p = line; *p; p++) {
+        if (*p != '\r') *q++ = *p;
+    }
+    *q = '\0';
+    p = strstr(line, "Gcov ");
+    if (!p) {
+        return 0;
+    }
+    if (strncmp(p, "Gcov Chunk ", 11) == 0) {
+        do_chunk(p + 11);
+    } else if (strncmp(p, "Gcov Entry ", 11) == 0) {
+        do_entry(p + 11);
+    } else if (strncmp(p, "Gcov Begin ", 11) == 0) {
+        unsigned count, entry, offset;
+
+        if (sscanf(p + 11, "%u %u %u", &count, &entry, &offset) == 3 && entry == 0 && offset == 0) {
+            /* a new transfer from the start */
+            reset_entries();
+        }
+    } else if (strncmp(p, "Gcov End", 8) == 0) {
+        return 1;
+    } else if (strncmp(p, "Gcov Stalled", 12) == 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static speed_t baud_flag(long baud)
+{
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default:
+        fprintf(stderr, "gcov_receive: unsupported baud %ld\n", baud);
+        exit(1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *ack_path = NULL;
+    long baud = 0;
+    int exit_at_end = 0;
+    int in_fd;
+    struct stat st;
+    char buf[65536];
+    size_t used = 0;
+    int opt;
+    int status = 0;
+
+    while ((opt = getopt(argc, argv, "o:a:b:x")) != -1) {
+        switch (opt) {
+        case 'o': out_dir = optarg; break;
+        case 'a': ack_path = optarg; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'x': exit_at_end = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-o dir] [-a ackpath] [-b baud] [-x] input|-\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-o dir] [-a ackpath] [-b baud] [-x] input|-\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[optind], "-") == 0) {
+        in_fd = 0;
+    } else {
+        in_fd = open(argv[optind], O_RDWR | O_NOCTTY);
+        if (in_fd < 0) {
+            in_fd = open(argv[optind], O_RDONLY);
+        }
+        if (in_fd < 0) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if (isatty(in_fd)) {
+        struct termios tio;
+
+        if (baud && tcgetattr(in_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, baud_flag(baud));
+            cfsetospeed(&tio, baud_flag(baud));
+            tcsetattr(in_fd, TCSANOW, &tio);
+        }
+        ack_fd = in_fd;
+    }
+    if (ack_path) {
+        ack_fd = open(ack_path, O_WRONLY);
+        if (ack_fd < 0) {
+            perror(ack_path);
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+    if (fstat(in_fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        exit_at_end = 1;
+    }
+
+    for (;;) {
+        ssize_t got = read(in_fd, buf + used, sizeof(buf) - 1 - used);
+        char *start = buf;
+        char *nl;
+
+        if (got <= 0) {
+            break;
+        }
+        used += got;
+        buf[used] = '\0';
+        /* serial logs can have NULs after a reboot, do not let them cut lines short */
+        for (size_t i = used - got; i < used; i++) {
+            if (buf[i] == '\0') buf[i] = '\r';
+        }
+        while ((nl = memchr(start, '\n', used - (start - buf))) != NULL) {
+            *nl = '\0';
+            status = do_line(start);
+            start = nl + 1;
+            if (status != 0) {
+                fflush(stdout);
+                if (exit_at_end) {
+                    return report() ? 0 : 2;
+                }
+                report();
+            }
+        }
+        used -= start - buf;
+        memmove(buf, start, used);
+        if (used == sizeof(buf) - 1) {
+            /* overlong junk line */
+            used = 0;
+        }
+        fflush(stdout);
+    }
+
+    return report() ? 0 : 2;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_receive.c host receiver for acknowledged chunk output
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
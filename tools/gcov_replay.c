@@ -0,0 +1,180 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host client to replay saved gcov output to gcov_aggregate.
+ *
+ * Stands in for targets: sends each saved log or binary output file
+ * to a running gcov_aggregate over its socket, as a target would,
+ * each over its own connection and all at once, optionally at the
+ * data rate of a serial link, and optionally several times over,
+ * as for a fleet of rigs.
+ *
+ * Typical usage:
+ *   ./gcov_replay /tmp/gcov.sock ../rig1_serial_log.txt ../rig2_serial_log.txt
+ *   ./gcov_replay -n 20 -r 11520 127.0.0.1:5555 ../example/example_log.txt
+ *
+ * Options:
+ *   -n n     send each file n times over (default 1), all at once
+ *   -r rate  send at rate bytes per second per connection (default all at once),
+ *            such as 11520 for 115200 baud
+ *
+ **********************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+
+/* Bytes sent at a time */
+#define CHUNK 4096
+
+static const char *addr;
+static long rate = 0;
+
+typedef struct {
+    pthread_t thread;
+    const char *path;
+    int failed;
+} Replay;
+
+static void *replay(void *arg)
+{
+    Replay *r = arg;
+    FILE *f = fopen(r->path, "rb");
+    unsigned char chunk[CHUNK];
+    size_t sent = 0;
+    size_t got;
+    int fd;
+
+    r->failed = 1;
+    if (!f) {
+        perror(r->path);
+        return NULL;
+    }
+    fd = gcov_host_connect(addr);
+    if (fd < 0) {
+        fclose(f);
+        return NULL;
+    }
+    while ((got = fread(chunk, 1, rate && rate < CHUNK ? (size_t)rate : CHUNK, f)) > 0) {
+        for (size_t pos = 0; pos < got; ) {
+            ssize_t put = write(fd, chunk + pos, got - pos);
+
+            if (put < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fprintf(stderr, "gcov_replay: %s: %s\n", r->path, strerror(errno));
+                fclose(f);
+                close(fd);
+                return NULL;
+            }
+            pos += (size_t)put;
+        }
+        sent += got;
+        if (rate) {
+            /* pace to the rate */
+            struct timespec ts;
+            long long ns = (long long)got * 1000000000LL / rate;
+
+            ts.tv_sec = (time_t)(ns / 1000000000LL);
+            ts.tv_nsec = (long)(ns % 1000000000LL);
+            nanosleep(&ts, NULL);
+        }
+    }
+    fclose(f);
+    close(fd);
+    printf("Replayed %zu bytes of %s\n", sent, r->path);
+    r->failed = 0;
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int copies = 1;
+    int count;
+    int failed = 0;
+    Replay *r;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+        case 'n': copies = atoi(optarg); break;
+        case 'r': rate = strtol(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: %s [-n copies] [-r rate] addr file...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (argc - optind < 2 || copies < 1 || rate < 0) {
+        fprintf(stderr, "usage: %s [-n copies] [-r rate] addr file...\n", argv[0]);
+        return 1;
+    }
+    addr = argv[optind++];
+    signal(SIGPIPE, SIG_IGN); // report the service going away as a write error
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    count = (argc - optind) * copies;
+    r = calloc((size_t)count, sizeof(*r));
+    if (!r) {
+        perror("calloc");
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        r[i].path = argv[optind + i / copies];
+        if (pthread_create(&r[i].thread, NULL, replay, &r[i]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        pthread_join(r[i].thread, NULL);
+        failed += r[i].failed;
+    }
+    free(r);
+    return failed ? 1 : 0;
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_replay.c host client to replay saved gcov output
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
@@ -0,0 +1,469 @@
+/**********************************************************************/
+/** @addtogroup embedded_gcov
+ * @{
+ * @file
+ * @version $Id: $
+ *
+ * @brief Host unpacker for binary format output.
+ *
+ * Splits the binary format written by GCOV_OPT_OUTPUT_BINARY_FILE,
+ * GCOV_OPT_OUTPUT_BINARY_MEMORY (as read out by a debugger)
+ * or GCOV_OPT_OUTPUT_DMA (as captured from the link) into .gcda files.
+ * With -f, the input is instead an image of the GCOV_OPT_OUTPUT_FLASH
+ * area (from GCOV_FLASH_ADDRESS on), and the newest valid dump slot
+ * (or the one given by -s) is unpacked.
+ * With -r, the input is instead an image of the GCOV_OPT_OUTPUT_MEMORY_RING
+ * block gcov_ring, and its newest dump is unpacked.
+ * Output compressed by GCOV_OPT_COMPRESS_LZ is recognized by its
+ * "GcvZ" header and decompressed, in any of these, and files packed by
+ * GCOV_OPT_PACK_CONDITIONS are unpacked (see gcov_gcda_unpack).
+ *
+ * Typical usage:
+ *   ./gcov_unpack -o ../objs ../example/gcov_output.bin
+ *   ./gcov_unpack -l -f flash.img
+ *   ./gcov_unpack -o ../objs -f flash.img
+ *   (gdb) dump binary value ring.img gcov_ring
+ *   ./gcov_unpack -o ../objs -r ring.img
+ *
+ * Options:
+ *   -o dir   directory for the .gcda files (default current directory),
+ *            files are named by the basename of the target filename
+ *   -f       input is a flash image
+ *   -s seq   unpack the flash dump with this sequence number
+ *   -l       list the valid flash dumps (or the ring header) only
+ *   -r       input is a memory ring image
+ *
+ * Exits with 0 if every file was complete, otherwise with 2.
+ *
+ **********************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gcov_host.h"
+
+#define FLASH_HEADER_BYTES 28
+
+/* Memory ring header, see gcov_ring_t in gcov_public.h */
+#define RING_MAGIC 0x52696e67
+#define RING_HEADER_BYTES 32
+#define RING_WRAP 1
+#define RING_COMPRESS 2
+#define RING_COMPLETE 0
+#define RING_TRUNCATED 2
+
+static const char *out_dir = ".";
+
+/* Same CRC-16/CCITT as gcov_public.c */
+static unsigned crc16(unsigned crc, unsigned char byte)
+{
+    crc ^= (unsigned)byte << 8;
+    for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+    return crc & 0xffff;
+}
+
+/* Big-endian field, as written by the target */
+static unsigned field(const unsigned char *p)
+{
+    return ((unsigned)p[0] << 24) | ((unsigned)p[1] << 16) | ((unsigned)p[2] << 8) | p[3];
+}
+
+/* Write through a temporary name, so a .gcda file is either complete or absent */
+static void write_file(const char *filename, const unsigned char *data, unsigned bytes)
+{
+    const char *base = strrchr(filename, '/');
+    char path[4096];
+    char tmp[4096 + 8];
+    FILE *f;
+
+    base = base ? base + 1 : filename;
+    snprintf(path, sizeof(path), "%s/%s", out_dir, base);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    f = fopen(tmp, "wb");
+    if (!f || fwrite(data, 1, bytes, f) != bytes || fclose(f) != 0) {
+        fprintf(stderr, "gcov_unpack: cannot write %s: %s\n", tmp, strerror(errno));
+        exit(1);
+    }
+    if (rename(tmp, path) != 0) {
+        fprintf(stderr, "gcov_unpack: cannot rename %s: %s\n", tmp, strerror(errno));
+        exit(1);
+    }
+    printf("Unpacked %u bytes for %s\n", bytes, path);
+}
+
+/*
+ * Split binary format: for each file, the filename with trailing null char,
+ * the data byte count (4 bytes MSB first), and the data;
+ * then "Gcov End" with trailing null char.
+ * Returns 0 if complete, 2 if cut short.
+ */
+static int unpack_plain(const unsigned char *data, size_t len)
+{
+    static const char end[] = "Gcov End";
+    size_t pos = 0;
+
+    while (pos < len) {
+        const char *name = (const char *)data + pos;
+        size_t name_len = strnlen(name, len - pos);
+        unsigned bytes;
+
+        if (name_len == len - pos) {
+            break; // no trailing null char
+        }
+        if (strcmp(name, end) == 0) {
+            return 0;
+        }
+        pos += name_len + 1;
+        if (len - pos < 4) {
+            break;
+        }
+        bytes = field(data + pos);
+        pos += 4;
+        if (bytes & GCOV_HOST_PACKED_FILE) {
+            GcovBuf plain = { NULL, 0, 0 };
+            size_t used;
+            int got;
+
+            bytes &= ~GCOV_HOST_PACKED_FILE;
+            got = gcov_gcda_unpack(data + pos, len - pos, bytes, &plain, &used);
+            if (got <= 0) {
+                fprintf(stderr, "gcov_unpack: %s: %s, unpacked %zu of %u bytes\n", name,
+                        got ? "packed data damaged" : "cut short", plain.len, bytes);
+                free(plain.data);
+                return 2;
+            }
+            write_file(name, plain.data, bytes);
+            free(plain.data);
+            pos += used;
+            continue;
+        }
+        if (len - pos < bytes) {
+            fprintf(stderr, "gcov_unpack: %s: have %zu of %u bytes\n", name, len - pos, bytes);
+            return 2;
+        }
+        write_file(name, data + pos, bytes);
+        pos += bytes;
+    }
+    fprintf(stderr, "gcov_unpack: no end marker, output cut short\n");
+    return 2;
+}
+
+/*
+ * Undo GCOV_OPT_COMPRESS_LZ: after the 5-byte header, groups of a flag byte
+ * and 8 items (fewer at the end); for each flag bit (LSB first) set,
+ * a copy of 3 to 18 bytes (2 bytes: 12 bits of offset back, 4 bits of
+ * length - 3), otherwise a byte as itself.
+ * Returns the decompressed bytes (malloc'd), and their count in *out_len;
+ * if damaged, as many as could be decompressed.
+ */
+static unsigned char *decompress(const unsigned char *data, size_t len, size_t *out_len)
+{
+    size_t cap = len * 9 + 64; // a copy item of 2 bytes gives at most 18
+    unsigned char *out = malloc(cap);
+    size_t pos = 5;
+    size_t n = 0;
+
+    if (!out) {
+        perror("malloc");
+        exit(1);
+    }
+    while (pos < len) {
+        unsigned flags = data[pos++];
+
+        for (int item = 0; item < 8 && pos < len; item++) {
+            if (flags & (1u << item)) {
+                unsigned offset, count;
+
+                if (len - pos < 2) {
+                    fprintf(stderr, "gcov_unpack: compressed data cut short\n");
+                    *out_len = n;
+                    return out;
+                }
+                offset = ((unsigned)data[pos] << 4) | (data[pos + 1] >> 4);
+                count = (data[pos + 1] & 15) + 3;
+                pos += 2;
+                if (offset == 0 || offset > n) {
+                    fprintf(stderr, "gcov_unpack: compressed data damaged at byte %zu\n", pos - 2);
+                    *out_len = n;
+                    return out;
+                }
+                /* byte by byte, as the copy can overlap itself */
+                for (unsigned i = 0; i < count; i++, n++) {
+                    out[n] = out[n - offset];
+                }
+            } else {
+                out[n++] = data[pos++];
+            }
+        }
+    }
+    *out_len = n;
+    return out;
+}
+
+/* Unpack binary format, decompressing first if compressed */
+static int unpack(const unsigned char *data, size_t len)
+{
+    unsigned char *plain;
+    size_t plain_len;
+    int status;
+
+    if (len < 5 || memcmp(data, "GcvZ", 4) != 0) {
+        return unpack_plain(data, len);
+    }
+    if (data[4] > 12) {
+        fprintf(stderr, "gcov_unpack: unknown compression window of %u bits\n", data[4]);
+        return 2;
+    }
+    plain = decompress(data, len, &plain_len);
+    printf("Decompressed %zu bytes to %zu\n", len, plain_len);
+    status = unpack_plain(plain, plain_len);
+    free(plain);
+    return status;
+}
+
+/* Check a flash slot header at p, with len bytes of image from there */
+static int valid_header(const unsigned char *p, size_t len)
+{
+    unsigned crc = 0xffff;
+
+    if (len < FLASH_HEADER_BYTES || memcmp(p, "GcvF", 4) != 0) {
+        return 0;
+    }
+    for (int i = 0; i < FLASH_HEADER_BYTES - 4; i++) {
+        crc = crc16(crc, p[i]);
+    }
+    return field(p + 24) == crc;
+}
+
+/*
+ * Find the flash dump slots (the geometry is in each slot header),
+ * list them or unpack the newest (or the one with sequence number seq).
+ */
+static int unpack_flash(const unsigned char *image, size_t len, int list, long seq)
+{
+    const unsigned char *best = NULL;
+
+    for (size_t off = 0; off + FLASH_HEADER_BYTES <= len; off += 4) {
+        const unsigned char *p = image + off;
+        unsigned slot_bytes;
+
+        if (!valid_header(p, len - off)) {
+            continue;
+        }
+        slot_bytes = field(p + 20);
+        if (slot_bytes == 0 || off % slot_bytes != 0) {
+            continue; // not at a slot boundary, so not a header
+        }
+        if (list) {
+            printf("slot %zu sequence %u bytes %u\n", off / slot_bytes, field(p + 4), field(p + 8));
+        }
+        if ((seq < 0) ? (!best || field(p + 4) > field(best + 4)) : (field(p + 4) == (unsigned)seq)) {
+            best = p;
+        }
+    }
+    if (list) {
+        return 0;
+    }
+    if (!best) {
+        fprintf(stderr, "gcov_unpack: no valid flash dump found\n");
+        return 2;
+    }
+
+    {
+        unsigned bytes = field(best + 8);
+        unsigned page_bytes = field(best + 16);
+        unsigned crc = 0xffff;
+        const unsigned char *data = best + page_bytes;
+
+        if (page_bytes > len - (size_t)(best - image)
+            || bytes > len - (size_t)(data - image)) {
+            fprintf(stderr, "gcov_unpack: flash image cut short\n");
+            return 2;
+        }
+        for (unsigned i = 0; i < bytes; i++) {
+            crc = crc16(crc, data[i]);
+        }
+        if (crc != field(best + 12)) {
+            fprintf(stderr, "gcov_unpack: flash dump %u fails CRC check\n", field(best + 4));
+            return 2;
+        }
+        printf("Flash dump sequence %u, %u bytes\n", field(best + 4), bytes);
+        return unpack(data, bytes);
+    }
+}
+
+/*
+ * Unpack the newest dump of a memory ring image,
+ * whose header words are in target byte order, either way.
+ */
+static int unpack_ring(const unsigned char *image, size_t len, int list)
+{
+    static const char *status_names[] = { "complete", "in progress", "truncated" };
+    unsigned h[RING_HEADER_BYTES / 4];
+    int little = 0;
+    unsigned capacity, start, length, rel;
+    unsigned char *data;
+    size_t bytes = 0;
+    int status;
+
+    if (len < RING_HEADER_BYTES) {
+        fprintf(stderr, "gcov_unpack: not a memory ring image\n");
+        return 2;
+    }
+    if (field(image) != RING_MAGIC) {
+        little = 1;
+    }
+    for (int i = 0; i < RING_HEADER_BYTES / 4; i++) {
+        const unsigned char *p = image + i * 4;
+
+        h[i] = little ? (((unsigned)p[3] << 24) | ((unsigned)p[2] << 16) | ((unsigned)p[1] << 8) | p[0])
+                      : field(p);
+    }
+    if (h[0] != RING_MAGIC) {
+        fprintf(stderr, "gcov_unpack: not a memory ring image\n");
+        return 2;
+    }
+    capacity = h[2];
+    start = h[4];
+    length = h[5];
+    if (capacity == 0 || capacity > len - RING_HEADER_BYTES
+        || start >= capacity || length > capacity || h[6] >= capacity) {
+        fprintf(stderr, "gcov_unpack: memory ring image cut short or damaged\n");
+        return 2;
+    }
+    if (list || h[7] != RING_COMPLETE) {
+        printf("Ring policy %u capacity %u generation %u start %u length %u dump %u status %s\n",
+               h[1], capacity, h[3], start, length, h[6], (h[7] <= 2) ? status_names[h[7]] : "unknown");
+    }
+    if (list) {
+        return 0;
+    }
+
+    if (h[1] == RING_WRAP && h[7] == RING_TRUNCATED) {
+        fprintf(stderr, "gcov_unpack: newest dump overwrote its own beginning\n");
+        return 2;
+    }
+
+    /* Offset of the newest dump within the valid range, in order */
+    rel = (h[6] + capacity - start) % capacity;
+    if (rel > length) {
+        fprintf(stderr, "gcov_unpack: newest dump is outside the valid range\n");
+        return 2;
+    }
+
+    /* Copy out the newest dump, undoing zero run compression */
+    data = malloc((h[1] == RING_COMPRESS) ? (size_t)capacity * 128 : (size_t)capacity);
+    if (!data) {
+        perror("malloc");
+        return 1;
+    }
+    for (unsigned i = rel; i < length; i++) {
+        unsigned char c = image[RING_HEADER_BYTES + (start + i) % capacity];
+
+        if (h[1] == RING_COMPRESS && c == 0) {
+            if (++i >= length) {
+                break;
+            }
+            c = image[RING_HEADER_BYTES + (start + i) % capacity];
+            memset(data + bytes, 0, c);
+            bytes += c;
+        } else {
+            data[bytes++] = c;
+        }
+    }
+
+    status = unpack(data, bytes);
+    free(data);
+    return (h[7] == RING_COMPLETE) ? status : 2;
+}
+
+int main(int argc, char *argv[])
+{
+    int flash = 0;
+    int ring = 0;
+    int list = 0;
+    long seq = -1;
+    unsigned char *data = NULL;
+    size_t len = 0;
+    size_t got;
+    FILE *f;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:fs:lr")) != -1) {
+        switch (opt) {
+        case 'o': out_dir = optarg; break;
+        case 'f': flash = 1; break;
+        case 's': seq = strtol(optarg, NULL, 0); break;
+        case 'l': list = 1; break;
+        case 'r': ring = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-o dir] [-f [-s seq] | -r] [-l] input|-\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-o dir] [-f [-s seq] | -r] [-l] input|-\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[optind], "-") == 0) {
+        f = stdin;
+    } else if (!(f = fopen(argv[optind], "rb"))) {
+        perror(argv[optind]);
+        return 1;
+    }
+    do {
+        data = realloc(data, len + 65536);
+        if (!data) {
+            perror("realloc");
+            return 1;
+        }
+        got = fread(data + len, 1, 65536, f);
+        len += got;
+    } while (got > 0);
+
+    if (ring) {
+        return unpack_ring(data, len, list);
+    }
+    return flash ? unpack_flash(data, len, list, seq) : unpack(data, len);
+}
+
+/** @}
+ */
+/*
+ * embedded-gcov gcov_unpack.c host unpacker for binary format output
+ *
+ * Copyright (c) 2021 California Institute of Technology (“Caltech”).
+ * U.S. Government sponsorship acknowledged.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *    Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *        this list of conditions and the following disclaimer in the documentation
+ *        and/or other materials provided with the distribution.
+ *    Neither the name of Caltech nor its operating division, the Jet Propulsion Laboratory,
+ *        nor the names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */